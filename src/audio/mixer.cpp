@@ -31,8 +31,58 @@ extern "C" {
 #include "../core/Math.hpp"
 #include "../core/Util.hpp"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define MIXER_SSE2
+#endif
+
 Mixer gMixer;
 
+/**
+ * A gain for the left and right samples of a frame that changes linearly over a mix, gain = start + step * frame.
+ */
+struct MixRamp {
+	float left, leftstep;
+	float right, rightstep;
+};
+
+/**
+ * Adds stereo S16 frames to the mix bus, scaling each by the product of a pan ramp and a volume ramp. This replaces
+ * separate pan, fade and mix passes over the channel data.
+ */
+static void MixS16Stereo(sint32* bus, const sint16* src, int frames, const MixRamp& pan, const MixRamp& volume)
+{
+	int i = 0;
+#ifdef MIXER_SSE2
+	// Two frames at a time, lanes are left and right of frame i followed by left and right of frame i + 1
+	const __m128 panstart = _mm_setr_ps(pan.left, pan.right, pan.left, pan.right);
+	const __m128 panstep = _mm_setr_ps(pan.leftstep, pan.rightstep, pan.leftstep, pan.rightstep);
+	const __m128 volumestart = _mm_setr_ps(volume.left, volume.right, volume.left, volume.right);
+	const __m128 volumestep = _mm_setr_ps(volume.leftstep, volume.rightstep, volume.leftstep, volume.rightstep);
+	__m128 frame = _mm_setr_ps(0, 0, 1, 1);
+	const __m128 framestep = _mm_set1_ps(2);
+	for (; i + 2 <= frames; i += 2) {
+		__m128i samples16 = _mm_loadl_epi64((const __m128i*)&src[i * 2]);
+		__m128i samples32 = _mm_srai_epi32(_mm_unpacklo_epi16(samples16, samples16), 16);
+		__m128 gain = _mm_mul_ps(
+			_mm_add_ps(panstart, _mm_mul_ps(panstep, frame)),
+			_mm_add_ps(volumestart, _mm_mul_ps(volumestep, frame))
+		);
+		__m128i mixed = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(samples32), gain));
+		__m128i* dst = (__m128i*)&bus[i * 2];
+		_mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), mixed));
+		frame = _mm_add_ps(frame, framestep);
+	}
+#endif
+	for (; i < frames; i++) {
+		float f = (float)i;
+		float leftgain = (pan.left + pan.leftstep * f) * (volume.left + volume.leftstep * f);
+		float rightgain = (pan.right + pan.rightstep * f) * (volume.right + volume.rightstep * f);
+		bus[i * 2] += (sint32)(src[i * 2] * leftgain);
+		bus[i * 2 + 1] += (sint32)(src[i * 2 + 1] * rightgain);
+	}
+}
+
 Source::~Source()
 {
 
@@ -436,6 +486,10 @@ void Channel::SetGroup(int group)
 Mixer::Mixer()
 {
 	effectbuffer = 0;
+	mixbus = 0;
+	mixbuslength = 0;
+	convertbuffer = 0;
+	convertbuffersize = 0;
 	volume = 1;
 	for (size_t i = 0; i < Util::CountOf(css1sources); i++) {
 		css1sources[i] = 0;
@@ -472,6 +526,10 @@ void Mixer::Init(const char* device)
 		}
 	}
 	effectbuffer = new uint8[(have.samples * format.BytesPerSample() * format.channels)];
+	if (UseMixBus()) {
+		mixbuslength = have.samples * format.channels;
+		mixbus = new sint32[mixbuslength];
+	}
 	SDL_PauseAudioDevice(deviceid, 0);
 }
 
@@ -500,6 +558,16 @@ void Mixer::Close()
 		delete[] effectbuffer;
 		effectbuffer = 0;
 	}
+	if (mixbus) {
+		delete[] mixbus;
+		mixbus = 0;
+		mixbuslength = 0;
+	}
+	if (convertbuffer) {
+		delete[] convertbuffer;
+		convertbuffer = 0;
+		convertbuffersize = 0;
+	}
 }
 
 void Mixer::Lock()
@@ -542,6 +610,8 @@ bool Mixer::LoadMusic(size_t pathId)
 		const char* filename = get_file_path(pathId);
 		Source_Sample* source_sample = new Source_Sample;
 		if (source_sample->LoadWAV(filename)) {
+			// Convert once here rather than on every callback, like the sound effects
+			source_sample->Convert(format);
 			musicsources[pathId] = source_sample;
 			return true;
 		} else {
@@ -563,9 +633,16 @@ void SDLCALL Mixer::Callback(void* arg, uint8* stream, int length)
 {
 	Mixer* mixer = (Mixer*)arg;
 	memset(stream, 0, length);
+
+	int buslength = length / sizeof(sint16);
+	bool usemixbus = mixer->mixbus != 0 && buslength <= mixer->mixbuslength;
+	if (usemixbus) {
+		memset(mixer->mixbus, 0, buslength * sizeof(sint32));
+	}
+
 	std::list<Channel*>::iterator i = mixer->channels.begin();
 	while (i != mixer->channels.end()) {
-		mixer->MixChannel(*(*i), stream, length);
+		mixer->MixChannel(*(*i), usemixbus ? 0 : stream, length);
 		if (((*i)->done && (*i)->deleteondone) || (*i)->stopping) {
 			delete (*i);
 			i = mixer->channels.erase(i);
@@ -573,8 +650,99 @@ void SDLCALL Mixer::Callback(void* arg, uint8* stream, int length)
 			i++;
 		}
 	}
+
+	// Clip the mix bus once, rather than after adding each channel
+	if (usemixbus) {
+		sint16* output = (sint16*)stream;
+		int j = 0;
+#ifdef MIXER_SSE2
+		for (; j + 8 <= buslength; j += 8) {
+			__m128i low = _mm_loadu_si128((const __m128i*)&mixer->mixbus[j]);
+			__m128i high = _mm_loadu_si128((const __m128i*)&mixer->mixbus[j + 4]);
+			_mm_storeu_si128((__m128i*)&output[j], _mm_packs_epi32(low, high));
+		}
+#endif
+		for (; j < buslength; j++) {
+			output[j] = (sint16)Math::Clamp<sint32>(INT16_MIN, mixer->mixbus[j], INT16_MAX);
+		}
+	}
+}
+
+/**
+ * Mixes synthetic channels into a buffer instead of a device and returns the average time a callback takes in
+ * microseconds. Every channel is panned and changes volume on every callback, so both are ramped. Without the mix bus,
+ * channels are mixed one at a time with SDL_MixAudioFormat as they are for other output formats.
+ */
+double Mixer::Benchmark(int numchannels, int numcallbacks, bool usemixbus)
+{
+	const int samples = 1024;
+	Mixer mixer;
+	mixer.deviceid = 0;
+	mixer.format.format = AUDIO_S16SYS;
+	mixer.format.channels = 2;
+	mixer.format.freq = 44100;
+	int length = samples * mixer.format.channels * mixer.format.BytesPerSample();
+	mixer.effectbuffer = new uint8[length];
+	if (usemixbus) {
+		mixer.mixbuslength = samples * mixer.format.channels;
+		mixer.mixbus = new sint32[mixer.mixbuslength];
+	}
+
+	// A loud tone a few callbacks long, so channels wrap around part way through a callback
+	Source_Sample source;
+	source.format = mixer.format;
+	source.length = length * 3 + 100;
+	source.data = new uint8[source.length];
+	sint16* sourcedata = (sint16*)source.data;
+	for (unsigned long i = 0; i < source.length / sizeof(sint16); i++) {
+		sourcedata[i] = (sint16)(sin(i * 0.05) * 24000);
+	}
+
+	for (int i = 0; i < numchannels; i++) {
+		Channel* channel = new Channel;
+		channel->Play(source, MIXER_LOOP_INFINITE);
+		channel->SetGroup(MIXER_GROUP_TITLE_MUSIC);
+		channel->SetPan((float)(i + 1) / (numchannels + 1));
+		mixer.channels.push_back(channel);
+	}
+
+	// Only the master volume applies to the title music group, make sure it does not leave SDL_MixAudioFormat nothing to do
+	uint8 mastervolume = gConfigSound.master_volume;
+	gConfigSound.master_volume = 100;
+
+	uint8* stream = new uint8[length];
+	uint64 starttime = SDL_GetPerformanceCounter();
+	for (int i = 0; i < numcallbacks; i++) {
+		for (Channel* channel : mixer.channels) {
+			channel->SetVolume(i & 1 ? SDL_MIX_MAXVOLUME : SDL_MIX_MAXVOLUME / 2);
+		}
+		Callback(&mixer, stream, length);
+	}
+	double elapsed = (double)(SDL_GetPerformanceCounter() - starttime) / SDL_GetPerformanceFrequency();
+
+	gConfigSound.master_volume = mastervolume;
+	delete[] stream;
+	for (Channel* channel : mixer.channels) {
+		delete channel;
+	}
+	mixer.channels.clear();
+	delete[] mixer.effectbuffer;
+	delete[] mixer.mixbus;
+	return elapsed * 1000000 / numcallbacks;
 }
 
+/**
+ * Whether channels are mixed into the 32 bit mix bus with MixS16Stereo. Only the stereo S16 output format used by
+ * almost every device is handled, any other format is mixed with SDL_MixAudioFormat.
+ */
+bool Mixer::UseMixBus()
+{
+	return format.format == AUDIO_S16SYS && format.channels == 2;
+}
+
+/**
+ * Mixes a channel into data, or into the mix bus if data is null.
+ */
 void Mixer::MixChannel(Channel& channel, uint8* data, int length)
 {
 	// Do not mix channel if channel is a sound and sound is disabled
@@ -649,7 +817,15 @@ void Mixer::MixChannel(Channel& channel, uint8* data, int length)
 					lengthloaded = (out_len * samplesize);
 				}
 
-				if (channel.pan != 0.5f && format.channels == 2) {
+				MixRamp panramp = { 1, 0, 1, 0 };
+				if (channel.pan != 0.5f && format.channels == 2 && data == 0) {
+					// Same ramp as EffectPanS16
+					float dt = 1.0f / ((lengthloaded / samplesize) * 2);
+					panramp.left = channel.oldvolume_l;
+					panramp.leftstep = dt * (channel.volume_l - channel.oldvolume_l);
+					panramp.right = channel.oldvolume_r;
+					panramp.rightstep = dt * (channel.volume_r - channel.oldvolume_r);
+				} else if (channel.pan != 0.5f && format.channels == 2) {
 					if (!effectbufferloaded) {
 						memcpy(effectbuffer, tomix, lengthloaded);
 						effectbufferloaded = true;
@@ -691,7 +867,20 @@ void Mixer::MixChannel(Channel& channel, uint8* data, int length)
 					endvolume = 0;
 				}
 				int mixvolume = (int)(channel.volume * volumeadjust);
-				if (startvolume != endvolume) {
+				MixRamp volumeramp = { 1, 0, 1, 0 };
+				if (data == 0) {
+					if (startvolume != endvolume) {
+						// Same ramp as EffectFadeS16, which steps per sample rather than per frame
+						float startvolume_f = (float)startvolume / SDL_MIX_MAXVOLUME;
+						float volumestep = ((float)endvolume / SDL_MIX_MAXVOLUME - startvolume_f) / (mixlength / format.BytesPerSample());
+						volumeramp.left = startvolume_f;
+						volumeramp.leftstep = volumestep * 2;
+						volumeramp.right = startvolume_f + volumestep;
+						volumeramp.rightstep = volumestep * 2;
+					} else {
+						volumeramp.left = volumeramp.right = (float)mixvolume / SDL_MIX_MAXVOLUME;
+					}
+				} else if (startvolume != endvolume) {
 					// fade between volume levels to smooth out sound and minimize clicks from sudden volume changes
 					if (!effectbufferloaded) {
 						memcpy(effectbuffer, tomix, lengthloaded);
@@ -710,10 +899,10 @@ void Mixer::MixChannel(Channel& channel, uint8* data, int length)
 					}
 				}
 
-				SDL_MixAudioFormat(&data[loaded], tomix, format.format, mixlength, mixvolume);
-
-				if (dataconverted) {
-					delete[] dataconverted;
+				if (data == 0) {
+					MixS16Stereo(&mixbus[loaded / sizeof(sint16)], (const sint16*)tomix, mixlength / samplesize, panramp, volumeramp);
+				} else {
+					SDL_MixAudioFormat(&data[loaded], tomix, format.format, mixlength, mixvolume);
 				}
 
 				channel.offset += readfromstream;
@@ -792,16 +981,29 @@ bool Mixer::MustConvert(Source& source)
 	return false;
 }
 
+/**
+ * Converts a block of a stream that could not be converted when it was loaded. The converted data is only valid until
+ * the next call, as the conversion buffer is reused.
+ */
 bool Mixer::Convert(SDL_AudioCVT& cvt, const uint8* data, unsigned long length, uint8** dataout)
 {
 	if (length == 0 || cvt.len_mult == 0) {
 		return false;
 	}
+	unsigned long buffersize = length * cvt.len_mult;
+	if (buffersize > convertbuffersize) {
+		delete[] convertbuffer;
+		convertbuffer = new (std::nothrow) uint8[buffersize];
+		if (!convertbuffer) {
+			convertbuffersize = 0;
+			return false;
+		}
+		convertbuffersize = buffersize;
+	}
 	cvt.len = length;
-	cvt.buf = (Uint8*)new uint8[cvt.len * cvt.len_mult];
+	cvt.buf = (Uint8*)convertbuffer;
 	memcpy(cvt.buf, data, length);
 	if (SDL_ConvertAudio(&cvt) < 0) {
-		delete[] cvt.buf;
 		return false;
 	}
 	*dataout = cvt.buf;
@@ -170,12 +170,15 @@ public:
 	bool LoadMusic(size_t pathid);
 	void SetVolume(float volume);
 
+	static double Benchmark(int numchannels, int numcallbacks, bool usemixbus);
+
 	Source* css1sources[SOUND_MAXID];
 	Source* musicsources[PATH_ID_END];
 
 private:
 	static void SDLCALL Callback(void* arg, uint8* data, int length);
 	void MixChannel(Channel& channel, uint8* buffer, int length);
+	bool UseMixBus();
 	void EffectPanS16(Channel& channel, sint16* data, int length);
 	void EffectPanU8(Channel& channel, uint8* data, int length);
 	void EffectFadeS16(sint16* data, int length, int startvolume, int endvolume);
@@ -185,6 +188,10 @@ private:
 	SDL_AudioDeviceID deviceid;
 	AudioFormat format;
 	uint8* effectbuffer;
+	sint32* mixbus;
+	int mixbuslength;
+	uint8* convertbuffer;
+	unsigned long convertbuffersize;
 	std::list<Channel*> channels;
 	Source_Null source_null;
 	float volume;
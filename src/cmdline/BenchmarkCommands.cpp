@@ -0,0 +1,214 @@
+extern "C"
+{
+    #include "../addresses.h"
+    #include "../audio/audio.h"
+    #include "../localisation/localisation.h"
+    #include "../openrct2.h"
+    #include "../world/map.h"
+    #include "../world/map_animation.h"
+}
+
+#include "../audio/mixer.h"
+#include "../core/Console.hpp"
+#include "CommandLine.hpp"
+
+static exitcode_t HandleBenchmarkAnimations(CommandLineArgEnumerator *argEnumerator);
+static exitcode_t HandleBenchmarkMixer(CommandLineArgEnumerator *argEnumerator);
+static exitcode_t HandleBenchmarkStrings(CommandLineArgEnumerator *argEnumerator);
+
+const CommandLineCommand CommandLine::BenchmarkCommands[]
+{
+    // Main commands
+    DefineCommand("animations", "[count]",      nullptr, HandleBenchmarkAnimations),
+    DefineCommand("mixer",      "[channels]",   nullptr, HandleBenchmarkMixer     ),
+    DefineCommand("strings",    "[iterations]", nullptr, HandleBenchmarkStrings   ),
+    CommandTableEnd
+};
+
+static double GetElapsedMs(uint64 startTime)
+{
+    return (double)(SDL_GetPerformanceCounter() - startTime) * 1000 / SDL_GetPerformanceFrequency();
+}
+
+/**
+ * Fills an empty map with animated banners, one per tile, and reports how long creating them, rebuilding the
+ * registry as a park load does, and updating them each tick take.
+ */
+static exitcode_t HandleBenchmarkAnimations(CommandLineArgEnumerator *argEnumerator)
+{
+    const int MapSize = 256;
+    const int MaxAnimations = (MapSize - 2) * (MapSize - 2);
+    const int NumTicks = 1024;
+
+    sint32 count = 50000;
+    argEnumerator->TryPopInteger(&count);
+    if (count < 1 || count > MaxAnimations)
+    {
+        Console::Error::WriteFormat("Count must be between 1 and %d.", MaxAnimations);
+        Console::Error::WriteLine();
+        return EXITCODE_FAIL;
+    }
+
+    gOpenRCT2Headless = true;
+    if (!openrct2_initialise())
+    {
+        return EXITCODE_FAIL;
+    }
+
+    map_init(MapSize);
+    for (int i = 0; i < count; i++)
+    {
+        int x = 1 + (i % (MapSize - 2));
+        int y = 1 + (i / (MapSize - 2));
+        rct_map_element * mapElement = map_element_insert(x, y, 4, 0);
+        if (mapElement == nullptr)
+        {
+            Console::Error::WriteFormat("Unable to place banner %d.", i);
+            Console::Error::WriteLine();
+            openrct2_dispose();
+            return EXITCODE_FAIL;
+        }
+        mapElement->type = MAP_ELEMENT_TYPE_BANNER;
+        mapElement->clearance_height = 6;
+    }
+
+    uint64 startTime = SDL_GetPerformanceCounter();
+    for (int i = 0; i < count; i++)
+    {
+        map_animation_create(MAP_ANIMATION_TYPE_BANNER, (1 + (i % (MapSize - 2))) * 32, (1 + (i / (MapSize - 2))) * 32, 4);
+    }
+    double createTime = GetElapsedMs(startTime);
+
+    // Loading a park with more animations than a saved game holds recreates them from the map
+    startTime = SDL_GetPerformanceCounter();
+    map_animation_mark_loaded();
+    map_animation_invalidate_all();
+    double rebuildTime = GetElapsedMs(startTime);
+
+    startTime = SDL_GetPerformanceCounter();
+    for (int i = 0; i < NumTicks; i++)
+    {
+        RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32)++;
+        map_animation_invalidate_all();
+    }
+    double tickTime = GetElapsedMs(startTime);
+
+    Console::WriteFormat("Created %d animations in %.1f ms, rebuilt them in %.1f ms, updated them in %.3f ms per tick.",
+                         count,
+                         createTime,
+                         rebuildTime,
+                         tickTime / NumTicks);
+    Console::WriteLine();
+
+    openrct2_dispose();
+    return EXITCODE_OK;
+}
+
+/**
+ * Mixes synthetic channels into a null device and reports the time per callback of mixing them into the 32 bit mix bus,
+ * compared with mixing them one at a time with SDL_MixAudioFormat.
+ */
+static exitcode_t HandleBenchmarkMixer(CommandLineArgEnumerator *argEnumerator)
+{
+    const int NumCallbacks = 2000;
+
+    sint32 numChannels = 16;
+    argEnumerator->TryPopInteger(&numChannels);
+    if (numChannels < 1)
+    {
+        Console::Error::WriteLine("Expected at least one channel.");
+        return EXITCODE_FAIL;
+    }
+
+    double mixBusTime = Mixer::Benchmark(numChannels, NumCallbacks, true);
+    double sdlMixTime = Mixer::Benchmark(numChannels, NumCallbacks, false);
+
+    Console::WriteFormat("Mixed %d channels in %.1f us per callback, SDL_MixAudioFormat takes %.1f us per callback.",
+                         numChannels,
+                         mixBusTime,
+                         sdlMixTime);
+    Console::WriteLine();
+    return EXITCODE_OK;
+}
+
+// Language strings and object strings are all below the custom string IDs
+static const int NumStringIds = 0x8000;
+
+// Zeroed arguments are safe for every format code, nested string IDs become the empty string 0. They start part way
+// into the buffer as a string can step back over its arguments.
+static const uint8 FormatArgsBuffer[512] = { 0 };
+static void * const FormatArgs = (void *)&FormatArgsBuffer[256];
+
+static double FormatAllStrings(int iterations, bool useTemplates)
+{
+    utf8 buffer[4096];
+
+    format_string_templates_set_enabled(useTemplates);
+    uint64 startTime = SDL_GetPerformanceCounter();
+    for (int i = 0; i < iterations; i++)
+    {
+        for (int stringId = 0; stringId < NumStringIds; stringId++)
+        {
+            format_string_bounded(buffer, sizeof(buffer), stringId, FormatArgs);
+        }
+    }
+    double elapsed = GetElapsedMs(startTime);
+    format_string_templates_set_enabled(true);
+    return elapsed;
+}
+
+/**
+ * Formats every language string ID with compiled templates and with the format codes interpreted directly, reporting
+ * the time each takes and any string whose output differs.
+ */
+static exitcode_t HandleBenchmarkStrings(CommandLineArgEnumerator *argEnumerator)
+{
+    sint32 iterations = 10;
+    argEnumerator->TryPopInteger(&iterations);
+    if (iterations < 1)
+    {
+        Console::Error::WriteLine("Expected at least one iteration.");
+        return EXITCODE_FAIL;
+    }
+
+    gOpenRCT2Headless = true;
+    if (!openrct2_initialise())
+    {
+        return EXITCODE_FAIL;
+    }
+
+    static utf8 rawBuffer[4096];
+    static utf8 templateBuffer[4096];
+    int numDifferent = 0;
+    for (int stringId = 0; stringId < NumStringIds; stringId++)
+    {
+        // The whole buffers are compared as sprites put zero bytes in the text
+        memset(rawBuffer, 0, sizeof(rawBuffer));
+        memset(templateBuffer, 0, sizeof(templateBuffer));
+        format_string_templates_set_enabled(false);
+        format_string_bounded(rawBuffer, sizeof(rawBuffer), stringId, FormatArgs);
+        format_string_templates_set_enabled(true);
+        format_string_bounded(templateBuffer, sizeof(templateBuffer), stringId, FormatArgs);
+        if (memcmp(rawBuffer, templateBuffer, sizeof(rawBuffer)) != 0)
+        {
+            Console::Error::WriteFormat("String %d differs: \"%s\" and \"%s\"", stringId, rawBuffer, templateBuffer);
+            Console::Error::WriteLine();
+            numDifferent++;
+        }
+    }
+
+    // The templates were all compiled by the check above
+    double rawTime = FormatAllStrings(iterations, false);
+    double templateTime = FormatAllStrings(iterations, true);
+
+    Console::WriteFormat("Formatted %d strings %d times in %.1f ms from templates, %.1f ms interpreted. %d differed.",
+                         NumStringIds,
+                         iterations,
+                         templateTime,
+                         rawTime,
+                         numDifferent);
+    Console::WriteLine();
+
+    openrct2_dispose();
+    return numDifferent == 0 ? EXITCODE_OK : EXITCODE_FAIL;
+}
@@ -84,8 +84,15 @@ constexpr char NAC = '\0';
 namespace CommandLine
 {
     extern const CommandLineCommand RootCommands[];
+    extern const CommandLineCommand BenchmarkCommands[];
+    extern const CommandLineCommand ReplayCommands[];
+    extern const CommandLineCommand ScenarioCommands[];
     extern const CommandLineCommand ScreenshotCommands[];
+#ifndef DISABLE_NETWORK
+    extern const CommandLineCommand ServerCommands[];
+#endif
     extern const CommandLineCommand SpriteCommands[];
+    extern const CommandLineCommand StateCommands[];
 
     extern const CommandLineExample RootExamples[];
 
@@ -0,0 +1,66 @@
+extern "C"
+{
+    #include "../platform/platform.h"
+    #include "../replay.h"
+}
+
+#include "../core/Console.hpp"
+#include "../core/Math.hpp"
+#include "CommandLine.hpp"
+
+static exitcode_t HandleReplay(CommandLineArgEnumerator *argEnumerator);
+static exitcode_t HandleReplayDeterminism(CommandLineArgEnumerator *argEnumerator);
+
+const CommandLineCommand CommandLine::ReplayCommands[]
+{
+    // Main commands
+    DefineCommand("",            "<replay_file>",           nullptr, HandleReplay           ),
+    DefineCommand("determinism", "<replay_file> [threads]", nullptr, HandleReplayDeterminism),
+    CommandTableEnd
+};
+
+static exitcode_t HandleReplay(CommandLineArgEnumerator *argEnumerator)
+{
+    const char * path;
+    if (!argEnumerator->TryPopString(&path))
+    {
+        Console::Error::WriteLine("Expected a replay file.");
+        return EXITCODE_FAIL;
+    }
+
+    int result = cmdline_for_replay(path);
+    if (result < 0) {
+        return EXITCODE_FAIL;
+    }
+    return EXITCODE_OK;
+}
+
+/**
+ * Replays the file on one thread and on several, and checks both runs end up in the same state.
+ */
+static exitcode_t HandleReplayDeterminism(CommandLineArgEnumerator *argEnumerator)
+{
+    const char * path;
+    if (!argEnumerator->TryPopString(&path))
+    {
+        Console::Error::WriteLine("Expected a replay file.");
+        return EXITCODE_FAIL;
+    }
+
+    sint32 threads;
+    if (!argEnumerator->TryPopInteger(&threads))
+    {
+        threads = Math::Max(SDL_GetCPUCount(), 2);
+    }
+    if (threads < 2)
+    {
+        Console::Error::WriteLine("Expected at least 2 threads.");
+        return EXITCODE_FAIL;
+    }
+
+    int result = cmdline_for_replay_determinism(path, threads);
+    if (result < 0) {
+        return EXITCODE_FAIL;
+    }
+    return EXITCODE_OK;
+}
@@ -75,8 +75,15 @@ const CommandLineCommand CommandLine::RootCommands[]
     DefineCommand("set-rct2", "<path>",     StandardOptions, HandleCommandSetRCT2),
 
     // Sub-commands
+    DefineSubCommand("benchmark",  CommandLine::BenchmarkCommands ),
+    DefineSubCommand("replay",     CommandLine::ReplayCommands    ),
+    DefineSubCommand("scenario",   CommandLine::ScenarioCommands  ),
     DefineSubCommand("screenshot", CommandLine::ScreenshotCommands),
+#ifndef DISABLE_NETWORK
+    DefineSubCommand("server",     CommandLine::ServerCommands    ),
+#endif
     DefineSubCommand("sprite",     CommandLine::SpriteCommands    ),
+    DefineSubCommand("state",      CommandLine::StateCommands     ),
 
     CommandTableEnd
 };
@@ -89,6 +96,7 @@ const CommandLineExample CommandLine::RootExamples[]
     { "https://openrct2.website/files/SnowyPark.sv6", "download and open a saved park"         },
 #ifndef DISABLE_NETWORK
     { "host ./my_park.sv6 --port 11753 --headless",   "run a headless server for a saved park" },
+    { "server ./my_park.sv6 --port 11753",            "run a dedicated server for a saved park" },
 #endif
     ExampleTableEnd
 };
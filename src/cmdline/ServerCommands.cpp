@@ -0,0 +1,288 @@
+#ifndef DISABLE_NETWORK
+
+#include <csignal>
+
+extern "C"
+{
+    #include "../addresses.h"
+    #include "../config.h"
+    #include "../game.h"
+    #include "../openrct2.h"
+    #include "../rct2.h"
+    #include "../scenario.h"
+}
+
+#include "../core/Console.hpp"
+#include "../core/Math.hpp"
+#include "../core/Memory.hpp"
+#include "../core/String.hpp"
+#include "../network/network.h"
+#include "CommandLine.hpp"
+
+/** The number of game ticks per second, the same rate the game runs at when it has a window. */
+constexpr uint32 ServerTickRate = 40;
+
+/** The most ticks run back to back to catch up after a slow tick, any further behind is dropped. */
+constexpr uint32 ServerMaxCatchUpTicks = 4;
+
+/** The client counts broadcasts are timed for by the broadcast-benchmark command. */
+constexpr int BroadcastBenchmarkClients[] = { 8, 32, 64 };
+
+/** The size of a game command packet: command, tick, seven registers, player and callback. */
+constexpr int BroadcastBenchmarkPacketSize = 38;
+
+constexpr int BroadcastBenchmarkDefaultPackets = 1000;
+
+struct ServerTickStats
+{
+    uint32 Ticks;
+    uint32 CatchUpTicks;
+    uint32 DroppedTicks;
+    uint64 TotalTime;
+    uint64 MaxTime;
+};
+
+static uint32 _port          = 0;
+static utf8 * _password      = nullptr;
+static uint32 _statsInterval = 60;
+
+static volatile sig_atomic_t _stopRequested = 0;
+
+static const CommandLineOptionDefinition ServerOptions[]
+{
+    { CMDLINE_TYPE_INTEGER, &_port,          NAC, "port",     "port to host the server on"                                  },
+    { CMDLINE_TYPE_STRING,  &_password,      NAC, "password", "password needed to join the server"                          },
+    { CMDLINE_TYPE_INTEGER, &_statsInterval, NAC, "stats",    "seconds between tick time statistics, 0 to disable (default 60)" },
+    OptionTableEnd
+};
+
+static exitcode_t HandleServer(CommandLineArgEnumerator *argEnumerator);
+static exitcode_t HandleServerBroadcastBenchmark(CommandLineArgEnumerator *argEnumerator);
+
+const CommandLineCommand CommandLine::ServerCommands[]
+{
+    // Main commands
+    DefineCommand("",                    "<uri>",     ServerOptions, HandleServer                  ),
+    DefineCommand("broadcast-benchmark", "[packets]", nullptr,       HandleServerBroadcastBenchmark),
+    CommandTableEnd
+};
+
+static void HandleStopSignal(int signal)
+{
+    _stopRequested = 1;
+}
+
+static void PrintTickStats(const ServerTickStats * stats, uint64 frequency)
+{
+    if (stats->Ticks == 0)
+    {
+        return;
+    }
+
+    double averageMs = (double)stats->TotalTime * 1000 / frequency / stats->Ticks;
+    double maxMs = (double)stats->MaxTime * 1000 / frequency;
+    Console::WriteFormat("Tick %u: %u ticks, %.2f ms average, %.2f ms max, %u caught up, %u dropped",
+                         RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32),
+                         stats->Ticks,
+                         averageMs,
+                         maxMs,
+                         stats->CatchUpTicks,
+                         stats->DroppedTicks);
+    Console::WriteLine();
+}
+
+/**
+ * Does the simulation and networking part of game_update, leaving out input, windows and audio.
+ */
+static void RunServerTick()
+{
+    int numUpdates = 1;
+    if (gGameSpeed > 1)
+    {
+        numUpdates = 1 << (gGameSpeed - 1);
+    }
+    if (RCT2_GLOBAL(RCT2_ADDRESS_GAME_PAUSED, uint8) != 0)
+    {
+        numUpdates = 0;
+        network_update();
+    }
+
+    for (int i = 0; i < numUpdates; i++)
+    {
+        game_logic_update();
+    }
+
+    scenario_autosave_check();
+    network_update();
+
+    RCT2_GLOBAL(0x009A8C28, uint8) = 0;
+}
+
+/**
+ * Runs ticks at a fixed rate until stopped. Tick deadlines are advanced by exactly one period so
+ * the rate does not drift with the time each tick takes or with sleep granularity.
+ */
+static void RunServerLoop()
+{
+    const uint64 frequency = SDL_GetPerformanceFrequency();
+    const uint64 tickPeriod = frequency / ServerTickRate;
+    uint64 nextTickTime = SDL_GetPerformanceCounter();
+    uint64 nextStatsTime = nextTickTime + frequency * _statsInterval;
+
+    ServerTickStats stats = { 0 };
+    ServerTickStats totalStats = { 0 };
+    while (!_stopRequested)
+    {
+        uint64 now = SDL_GetPerformanceCounter();
+        if (now < nextTickTime)
+        {
+            SDL_Delay((uint32)((nextTickTime - now) * 1000 / frequency));
+            continue;
+        }
+
+        uint32 ticksDue = (uint32)((now - nextTickTime) / tickPeriod) + 1;
+        if (ticksDue > ServerMaxCatchUpTicks)
+        {
+            // Running every missed tick would take long enough to miss even more, so give up on
+            // the backlog instead
+            stats.DroppedTicks += ticksDue - ServerMaxCatchUpTicks;
+            nextTickTime += (ticksDue - ServerMaxCatchUpTicks) * tickPeriod;
+            ticksDue = ServerMaxCatchUpTicks;
+        }
+        stats.CatchUpTicks += ticksDue - 1;
+
+        for (uint32 i = 0; i < ticksDue && !_stopRequested; i++)
+        {
+            uint64 tickStartTime = SDL_GetPerformanceCounter();
+            RunServerTick();
+            uint64 tickTime = SDL_GetPerformanceCounter() - tickStartTime;
+
+            stats.Ticks++;
+            stats.TotalTime += tickTime;
+            stats.MaxTime = Math::Max(stats.MaxTime, tickTime);
+            nextTickTime += tickPeriod;
+        }
+
+        if (_statsInterval != 0 && SDL_GetPerformanceCounter() >= nextStatsTime)
+        {
+            PrintTickStats(&stats, frequency);
+            nextStatsTime += frequency * _statsInterval;
+
+            totalStats.Ticks += stats.Ticks;
+            totalStats.CatchUpTicks += stats.CatchUpTicks;
+            totalStats.DroppedTicks += stats.DroppedTicks;
+            totalStats.TotalTime += stats.TotalTime;
+            totalStats.MaxTime = Math::Max(totalStats.MaxTime, stats.MaxTime);
+            stats = { 0 };
+        }
+    }
+
+    totalStats.Ticks += stats.Ticks;
+    totalStats.CatchUpTicks += stats.CatchUpTicks;
+    totalStats.DroppedTicks += stats.DroppedTicks;
+    totalStats.TotalTime += stats.TotalTime;
+    totalStats.MaxTime = Math::Max(totalStats.MaxTime, stats.MaxTime);
+    PrintTickStats(&totalStats, frequency);
+}
+
+static exitcode_t HandleServer(CommandLineArgEnumerator *argEnumerator)
+{
+    const char * parkUri;
+    if (!argEnumerator->TryPopString(&parkUri))
+    {
+        Console::Error::WriteLine("Expected path to a scenario or saved park.");
+        return EXITCODE_FAIL;
+    }
+
+    gOpenRCT2Headless = true;
+    if (!openrct2_initialise())
+    {
+        return EXITCODE_FAIL;
+    }
+
+    if (!rct2_open_file(parkUri))
+    {
+        Console::Error::WriteFormat("Unable to open '%s'.", parkUri);
+        Console::Error::WriteLine();
+        openrct2_dispose();
+        return EXITCODE_FAIL;
+    }
+    RCT2_GLOBAL(RCT2_ADDRESS_SCREEN_FLAGS, uint8) = SCREEN_FLAGS_PLAYING;
+
+    if (_password != nullptr)
+    {
+        network_set_password(_password);
+        Memory::Free(_password);
+        _password = nullptr;
+    }
+    else
+    {
+        network_set_password(gConfigNetwork.default_password);
+    }
+
+    int port = _port != 0 ? (int)_port : gConfigNetwork.default_port;
+    if (!network_begin_server(port))
+    {
+        Console::Error::WriteFormat("Unable to host a server on port %d.", port);
+        Console::Error::WriteLine();
+        openrct2_dispose();
+        return EXITCODE_FAIL;
+    }
+
+    signal(SIGINT, HandleStopSignal);
+    signal(SIGTERM, HandleStopSignal);
+    RunServerLoop();
+
+    openrct2_dispose();
+    return EXITCODE_OK;
+}
+
+/**
+ * Broadcasts game command sized packets to clients connected over loopback and reports how long queueing them and
+ * delivering them to every client takes.
+ */
+static exitcode_t HandleServerBroadcastBenchmark(CommandLineArgEnumerator *argEnumerator)
+{
+    sint32 numPackets;
+    if (!argEnumerator->TryPopInteger(&numPackets))
+    {
+        numPackets = BroadcastBenchmarkDefaultPackets;
+    }
+    if (numPackets <= 0)
+    {
+        Console::Error::WriteLine("Expected a positive number of packets.");
+        return EXITCODE_FAIL;
+    }
+
+    gOpenRCT2Headless = true;
+    if (!openrct2_initialise())
+    {
+        return EXITCODE_FAIL;
+    }
+
+    exitcode_t result = EXITCODE_OK;
+    for (int numClients : BroadcastBenchmarkClients)
+    {
+        double queueMs, deliveryMs;
+        if (!network_benchmark_broadcast(numClients, numPackets, BroadcastBenchmarkPacketSize, &queueMs, &deliveryMs))
+        {
+            Console::Error::WriteFormat("Unable to broadcast to %d clients over loopback.", numClients);
+            Console::Error::WriteLine();
+            result = EXITCODE_FAIL;
+            break;
+        }
+
+        Console::WriteFormat("%d clients: queued %d packets in %.2f ms, delivered to every client in %.2f ms (%.2f us per packet)",
+                             numClients,
+                             numPackets,
+                             queueMs,
+                             deliveryMs,
+                             deliveryMs * 1000 / numPackets);
+        Console::WriteLine();
+    }
+
+    openrct2_dispose();
+    return result;
+}
+
+#endif // DISABLE_NETWORK
@@ -0,0 +1,84 @@
+extern "C"
+{
+    #include "../state_hash.h"
+}
+
+#include "../core/Console.hpp"
+#include "CommandLine.hpp"
+
+static exitcode_t HandleStateDiff(CommandLineArgEnumerator *argEnumerator);
+
+const CommandLineCommand CommandLine::StateCommands[]
+{
+    // Main commands
+    DefineCommand("diff", "<dump_a> <dump_b>", nullptr, HandleStateDiff),
+    CommandTableEnd
+};
+
+static exitcode_t HandleStateDiff(CommandLineArgEnumerator *argEnumerator)
+{
+    const char * pathA;
+    const char * pathB;
+    if (!argEnumerator->TryPopString(&pathA) || !argEnumerator->TryPopString(&pathB))
+    {
+        Console::Error::WriteLine("Expected two state dump files.");
+        return EXITCODE_FAIL;
+    }
+
+    rct_state_dump dumpA, dumpB;
+    if (!state_hash_dump_load(&dumpA, pathA))
+    {
+        return EXITCODE_FAIL;
+    }
+    if (!state_hash_dump_load(&dumpB, pathB))
+    {
+        state_hash_dump_dispose(&dumpA);
+        return EXITCODE_FAIL;
+    }
+
+    if (dumpA.tick != dumpB.tick)
+    {
+        Console::WriteFormat("Warning: dumps were taken at different ticks (%u and %u)", dumpA.tick, dumpB.tick);
+        Console::WriteLine();
+    }
+
+    // Report the first divergent entity and the number of divergent entities for each category
+    uint32 totalDifferences = 0;
+    for (int category = 0; category < STATE_HASH_CATEGORY_COUNT; category++)
+    {
+        uint32 differences = 0;
+        sint32 firstDifference = -1;
+        for (uint32 i = 0; i < dumpA.count[category]; i++)
+        {
+            if (dumpA.entities[category][i] != dumpB.entities[category][i])
+            {
+                if (firstDifference == -1)
+                {
+                    firstDifference = (sint32)i;
+                }
+                differences++;
+            }
+        }
+
+        if (differences != 0)
+        {
+            Console::WriteFormat("%-8s %u differ, first at index %d", state_hash_category_name(category), differences, firstDifference);
+            if (category == STATE_HASH_CATEGORY_MAP)
+            {
+                Console::WriteFormat(" (tile %d, %d)", firstDifference % 256, firstDifference / 256);
+            }
+            Console::WriteLine();
+        }
+        totalDifferences += differences;
+    }
+
+    state_hash_dump_dispose(&dumpA);
+    state_hash_dump_dispose(&dumpB);
+
+    if (totalDifferences == 0)
+    {
+        Console::WriteLine("Game states are identical.");
+        return EXITCODE_OK;
+    }
+    return EXITCODE_FAIL;
+}
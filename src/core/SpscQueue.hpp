@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * An unbounded queue for passing items from exactly one producer thread to exactly one consumer thread without
+ * locking. Push must only be called from the producer and TryPop only from the consumer.
+ */
+template<typename T>
+class SpscQueue
+{
+private:
+    struct Node
+    {
+        T                   Value;
+        std::atomic<Node *> Next;
+
+        Node() : Value(), Next(nullptr) { }
+    };
+
+    // The consumer owns _head, which is always an already consumed node. The producer owns _tail.
+    Node * _head;
+    Node * _tail;
+
+public:
+    SpscQueue()
+    {
+        _head = new Node();
+        _tail = _head;
+    }
+
+    ~SpscQueue()
+    {
+        while (_head != nullptr)
+        {
+            Node * next = _head->Next.load(std::memory_order_relaxed);
+            delete _head;
+            _head = next;
+        }
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue & operator=(const SpscQueue &) = delete;
+
+    void Push(T value)
+    {
+        Node * node = new Node();
+        node->Value = std::move(value);
+        _tail->Next.store(node, std::memory_order_release);
+        _tail = node;
+    }
+
+    bool TryPop(T * outValue)
+    {
+        Node * next = _head->Next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            return false;
+        }
+
+        *outValue = std::move(next->Value);
+        next->Value = T();
+        delete _head;
+        _head = next;
+        return true;
+    }
+};
@@ -21,6 +21,7 @@
 #include "../addresses.h"
 #include "../common.h"
 #include "../localisation/localisation.h"
+#include "../interface/viewport.h"
 #include "../interface/window.h"
 #include "../platform/platform.h"
 #include "../object.h"
@@ -215,6 +216,18 @@ uint8* gfx_get_dirty_blocks()
  * bottom (bp)
  */
 void gfx_set_dirty_blocks(sint16 left, sint16 top, sint16 right, sint16 bottom)
+{
+	// The caller could have changed anything in the region, including what windows show
+	window_invalidate_surfaces(left, top, right, bottom);
+	gfx_mark_dirty_blocks(left, top, right, bottom);
+}
+
+/**
+ * Marks a region of the screen to be redrawn without discarding the retained drawings of the
+ * windows in it. Only for changes behind windows, such as in a viewport, or changes to a window that
+ * the caller has already invalidated the surface of.
+ */
+void gfx_mark_dirty_blocks(sint16 left, sint16 top, sint16 right, sint16 bottom)
 {
 	int x, y;
 	uint8 *screenDirtyBlocks = gfx_get_dirty_blocks();
@@ -237,6 +250,8 @@ void gfx_set_dirty_blocks(sint16 left, sint16 top, sint16 right, sint16 bottom)
 	top >>= RCT2_GLOBAL(0x009ABDF1, sint8);
 	bottom >>= RCT2_GLOBAL(0x009ABDF1, sint8);
 
+	viewport_pick_cache_invalidate_blocks(left, top, right, bottom);
+
 	uint32 dirtyBlockColumns = RCT2_GLOBAL(RCT2_ADDRESS_DIRTY_BLOCK_COLUMNS, uint32);
 	for (y = top; y <= bottom; y++) {
 		uint32 yOffset = y * dirtyBlockColumns;
@@ -510,7 +525,7 @@ void gfx_invalidate_pickedup_peep()
 			int right = left + g1_elements->width;
 			int bottom = top + g1_elements->height;
 
-			gfx_set_dirty_blocks(left, top, right, bottom);
+			gfx_mark_dirty_blocks(left, top, right, bottom);
 		}
 	}
 }
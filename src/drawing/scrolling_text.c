@@ -18,8 +18,37 @@ typedef struct {
 rct_draw_scroll_text *gDrawScrollTextList = RCT2_ADDRESS(RCT2_ADDRESS_DRAW_SCROLL_LIST, rct_draw_scroll_text);
 uint8 *gCharacterBitmaps = RCT2_ADDRESS(RCT2_ADDRESS_CHARACTER_BITMAP, uint8);
 
-void scrolling_text_set_bitmap_for_sprite(utf8 *text, int scroll, uint8 *bitmap, sint16 *scrollPositionOffsets);
-void scrolling_text_set_bitmap_for_ttf(utf8 *text, int scroll, uint8 *bitmap, sint16 *scrollPositionOffsets);
+/**
+ * A string rendered once round as a strip of 8 pixel high columns. Each column is a bit per row, plus the colour it
+ * is drawn in. The colour at the end of the string carries on when it loops round, so a string that changes colour
+ * part way through also has the colours used from the second time round.
+ */
+typedef struct scrolling_text_strip {
+	struct scrolling_text_strip *hash_next;
+	struct scrolling_text_strip *lru_prev;
+	struct scrolling_text_strip *lru_next;
+	uint32 hash;
+	uint8 initial_colour;
+	bool true_type;
+	utf8 *text;
+	int width;
+	uint8 *columns;
+	uint8 *colours;
+	uint8 *repeat_colours;
+	size_t size;
+} scrolling_text_strip;
+
+// Memory the strip cache may use before the least recently used strips are dropped
+#define SCROLLING_TEXT_STRIP_CACHE_BUDGET (1024 * 1024)
+#define SCROLLING_TEXT_STRIP_HASH_SIZE 1024
+
+static scrolling_text_strip *_stripHashTable[SCROLLING_TEXT_STRIP_HASH_SIZE];
+static scrolling_text_strip *_stripLruHead;
+static scrolling_text_strip *_stripLruTail;
+static size_t _stripCacheSize;
+
+static void scrolling_text_strip_build_for_sprite(scrolling_text_strip *strip, const utf8 *text);
+static void scrolling_text_strip_build_for_ttf(scrolling_text_strip *strip, utf8 *text);
 
 void scrolling_text_initialise_bitmaps()
 {
@@ -51,6 +80,8 @@ void scrolling_text_initialise_bitmaps()
 		}
 
 	}
+
+	scrolling_text_invalidate();
 }
 
 static uint8 *font_sprite_get_codepoint_bitmap(int codepoint)
@@ -106,6 +137,136 @@ static void scrolling_text_format(utf8 *dst, rct_draw_scroll_text *scrollText)
 	}
 }
 
+static uint32 scrolling_text_strip_hash(const utf8 *text, uint8 initialColour, bool trueType)
+{
+	uint32 hash = 0x811C9DC5;
+	for (const utf8 *ch = text; *ch != 0; ch++) {
+		hash ^= (uint8)*ch;
+		hash *= 0x01000193;
+	}
+	hash ^= initialColour | (trueType << 8);
+	hash *= 0x01000193;
+	return hash;
+}
+
+static void scrolling_text_strip_lru_unlink(scrolling_text_strip *strip)
+{
+	if (strip->lru_prev != NULL) strip->lru_prev->lru_next = strip->lru_next;
+	else _stripLruHead = strip->lru_next;
+	if (strip->lru_next != NULL) strip->lru_next->lru_prev = strip->lru_prev;
+	else _stripLruTail = strip->lru_prev;
+}
+
+static void scrolling_text_strip_lru_push_front(scrolling_text_strip *strip)
+{
+	strip->lru_prev = NULL;
+	strip->lru_next = _stripLruHead;
+	if (_stripLruHead != NULL) _stripLruHead->lru_prev = strip;
+	else _stripLruTail = strip;
+	_stripLruHead = strip;
+}
+
+static void scrolling_text_strip_free(scrolling_text_strip *strip)
+{
+	scrolling_text_strip **link = &_stripHashTable[strip->hash % SCROLLING_TEXT_STRIP_HASH_SIZE];
+	while (*link != strip) link = &(*link)->hash_next;
+	*link = strip->hash_next;
+
+	scrolling_text_strip_lru_unlink(strip);
+	_stripCacheSize -= strip->size;
+
+	free(strip->text);
+	free(strip->columns);
+	free(strip->colours);
+	free(strip->repeat_colours);
+	free(strip);
+}
+
+/**
+ * Drops every rendered strip, for when the font changes.
+ */
+void scrolling_text_invalidate()
+{
+	while (_stripLruTail != NULL)
+		scrolling_text_strip_free(_stripLruTail);
+
+	// Slots drawn with the old font would otherwise still be matched, no scrolling mode is this high
+	for (int i = 0; i < 32; i++) {
+		gDrawScrollTextList[i].mode = 0xFFFF;
+		gDrawScrollTextList[i].id = 0;
+	}
+}
+
+static scrolling_text_strip *scrolling_text_get_strip(utf8 *text, uint8 initialColour)
+{
+	bool trueType = gUseTrueTypeFont;
+	uint32 hash = scrolling_text_strip_hash(text, initialColour, trueType);
+
+	scrolling_text_strip *strip = _stripHashTable[hash % SCROLLING_TEXT_STRIP_HASH_SIZE];
+	for (; strip != NULL; strip = strip->hash_next) {
+		if (strip->hash == hash && strip->initial_colour == initialColour && strip->true_type == trueType && strcmp(strip->text, text) == 0) {
+			scrolling_text_strip_lru_unlink(strip);
+			scrolling_text_strip_lru_push_front(strip);
+			return strip;
+		}
+	}
+
+	strip = calloc(1, sizeof(scrolling_text_strip));
+	strip->hash = hash;
+	strip->initial_colour = initialColour;
+	strip->true_type = trueType;
+	strip->text = _strdup(text);
+
+	// Building the TrueType strip strips the format codes from text
+	if (trueType) {
+		scrolling_text_strip_build_for_ttf(strip, text);
+	} else {
+		scrolling_text_strip_build_for_sprite(strip, text);
+	}
+	strip->size = sizeof(scrolling_text_strip) + strlen(strip->text) + 1 + strip->width * (strip->repeat_colours != NULL ? 3 : 2);
+
+	strip->hash_next = _stripHashTable[hash % SCROLLING_TEXT_STRIP_HASH_SIZE];
+	_stripHashTable[hash % SCROLLING_TEXT_STRIP_HASH_SIZE] = strip;
+	scrolling_text_strip_lru_push_front(strip);
+	_stripCacheSize += strip->size;
+
+	while (_stripCacheSize > SCROLLING_TEXT_STRIP_CACHE_BUDGET && _stripLruTail != strip)
+		scrolling_text_strip_free(_stripLruTail);
+
+	return strip;
+}
+
+/**
+ * Draws the visible window of a strip into a scrolling text bitmap. Each scrolling position offset takes the next
+ * column along from the scroll position, offsets of -1 end the text and other negative offsets are not drawn.
+ */
+static void scrolling_text_draw_strip(const scrolling_text_strip *strip, int scroll, uint8 *bitmap, const sint16 *scrollPositionOffsets)
+{
+	if (strip->width == 0)
+		return;
+
+	int column = scroll % strip->width;
+	bool repeating = scroll >= strip->width;
+	for (; *scrollPositionOffsets != -1; scrollPositionOffsets++) {
+		sint16 scrollPosition = *scrollPositionOffsets;
+		if (scrollPosition > -1) {
+			uint8 colour = repeating && strip->repeat_colours != NULL ? strip->repeat_colours[column] : strip->colours[column];
+			uint8 *dst = &bitmap[scrollPosition];
+			for (uint8 columnBits = strip->columns[column]; columnBits != 0; columnBits >>= 1) {
+				if (columnBits & 1) *dst = colour;
+
+				// Jump to next row
+				dst += 64;
+			}
+		}
+
+		if (++column == strip->width) {
+			column = 0;
+			repeating = true;
+		}
+	}
+}
+
 /**
  *
  *  rct2: 0x006C42D9
@@ -134,40 +295,34 @@ int scrolling_text_setup(rct_string_id stringId, uint16 scroll, uint16 scrolling
 	scrollText->mode = scrollingMode;
 	scrollText->id = RCT2_GLOBAL(RCT2_ADDRESS_DRAW_SCROLL_NEXT_ID, uint32);
 
-	// Create the string to draw
+	// Create the string to draw, the glyphs are only rendered the first time it is seen
 	utf8 scrollString[256];
 	scrolling_text_format(scrollString, scrollText);
+	uint8 initialColour = scrolling_text_get_colour(RCT2_GLOBAL(RCT2_ADDRESS_COMMON_FORMAT_ARGS + 7, uint8));
+	scrolling_text_strip *strip = scrolling_text_get_strip(scrollString, initialColour);
 
 	sint16* scrollingModePositions = RCT2_ADDRESS(RCT2_ADDRESS_SCROLLING_MODE_POSITIONS, sint16*)[scrollingMode];
 
 	memset(scrollText->bitmap, 0, 320 * 8);
-	if (gUseTrueTypeFont) {
-		scrolling_text_set_bitmap_for_ttf(scrollString, scroll, scrollText->bitmap, scrollingModePositions);
-	} else {
-		scrolling_text_set_bitmap_for_sprite(scrollString, scroll, scrollText->bitmap, scrollingModePositions);
-	}
+	scrolling_text_draw_strip(strip, scroll, scrollText->bitmap, scrollingModePositions);
 
 	return scrollIndex + 0x606;
 }
 
-void scrolling_text_set_bitmap_for_sprite(utf8 *text, int scroll, uint8 *bitmap, sint16 *scrollPositionOffsets)
+/**
+ * Goes once round the string with the sprite font, writing the columns and colours where given.
+ * @returns the width of the string in columns.
+ */
+static int scrolling_text_render_sprite(const utf8 *text, uint8 *colour, uint8 *columns, uint8 *colours)
 {
-	uint8 characterColour = scrolling_text_get_colour(RCT2_GLOBAL(RCT2_ADDRESS_COMMON_FORMAT_ARGS + 7, uint8));
-
-	utf8 *ch = text;
-	while (true) {
-		uint32 codepoint = utf8_get_next(ch, (const utf8**)&ch);
-
-		// If at the end of the string loop back to the start
-		if (codepoint == 0) {
-			ch = text;
-			continue;
-		}
-
+	int width = 0;
+	const utf8 *ch = text;
+	uint32 codepoint;
+	while ((codepoint = utf8_get_next(ch, &ch)) != 0) {
 		// Set any change in colour
 		if (codepoint <= FORMAT_COLOUR_CODE_END && codepoint >= FORMAT_COLOUR_CODE_START){
 			codepoint -= FORMAT_COLOUR_CODE_START;
-			characterColour = RCT2_GLOBAL(0x009FF048, uint8*)[codepoint * 4];
+			*colour = RCT2_GLOBAL(0x009FF048, uint8*)[codepoint * 4];
 			continue;
 		}
 
@@ -176,37 +331,39 @@ void scrolling_text_set_bitmap_for_sprite(utf8 *text, int scroll, uint8 *bitmap,
 
 		int characterWidth = font_sprite_get_codepoint_width(FONT_SPRITE_BASE_TINY, codepoint);
 		uint8 *characterBitmap = font_sprite_get_codepoint_bitmap(codepoint);
-		for (; characterWidth != 0; characterWidth--, characterBitmap++) {
-			// Skip any none displayed columns
-			if (scroll != 0) {
-				scroll--;
-				continue;
-			}
-
-			sint16 scrollPosition = *scrollPositionOffsets;
-			if (scrollPosition == -1) return;
-			if (scrollPosition > -1) {
-				uint8 *dst = &bitmap[scrollPosition];
-				for (uint8 char_bitmap = *characterBitmap; char_bitmap != 0; char_bitmap >>= 1){
-					if (char_bitmap & 1) *dst = characterColour;
-
-					// Jump to next row
-					dst += 64;
-				}
-			}
-			scrollPositionOffsets++;
+		for (; characterWidth != 0; characterWidth--, characterBitmap++, width++) {
+			if (columns != NULL) columns[width] = *characterBitmap;
+			if (colours != NULL) colours[width] = *colour;
 		}
 	}
+	return width;
+}
+
+static void scrolling_text_strip_build_for_sprite(scrolling_text_strip *strip, const utf8 *text)
+{
+	uint8 colour = strip->initial_colour;
+	strip->width = scrolling_text_render_sprite(text, &colour, NULL, NULL);
+	strip->columns = malloc(max(strip->width, 1));
+	strip->colours = malloc(max(strip->width, 1));
+
+	colour = strip->initial_colour;
+	scrolling_text_render_sprite(text, &colour, strip->columns, strip->colours);
+
+	// Every time round after the first starts with the colour the string ended on
+	if (strip->width != 0 && colour != strip->initial_colour) {
+		strip->repeat_colours = malloc(strip->width);
+		scrolling_text_render_sprite(text, &colour, NULL, strip->repeat_colours);
+	}
 }
 
 TTFFontDescriptor *ttf_get_font_from_sprite_base(uint16 spriteBase);
-SDL_Surface *_ttf_surface_cache_get_or_add(TTF_Font *font, const utf8 *text);
+uint8 *ttf_render_string_bitmap(int fontSize, const utf8 *text, int *outWidth, int *outHeight);
 
-void scrolling_text_set_bitmap_for_ttf(utf8 *text, int scroll, uint8 *bitmap, sint16 *scrollPositionOffsets)
+static void scrolling_text_strip_build_for_ttf(scrolling_text_strip *strip, utf8 *text)
 {
 	TTFFontDescriptor *fontDesc = ttf_get_font_from_sprite_base(FONT_SPRITE_BASE_TINY);
 	if (fontDesc->font == NULL) {
-		scrolling_text_set_bitmap_for_sprite(text, scroll, bitmap, scrollPositionOffsets);
+		scrolling_text_strip_build_for_sprite(strip, text);
 		return;
 	}
 
@@ -228,54 +385,36 @@ void scrolling_text_set_bitmap_for_ttf(utf8 *text, int scroll, uint8 *bitmap, si
 	*dstCh = 0;
 
 	if (colour == 0) {
-		colour = scrolling_text_get_colour(RCT2_GLOBAL(RCT2_ADDRESS_COMMON_FORMAT_ARGS + 7, uint8));
+		colour = strip->initial_colour;
 	} else {
 		colour = RCT2_GLOBAL(0x009FF048, uint8*)[(colour - FORMAT_COLOUR_CODE_START) * 4];
 	}
 
-	SDL_Surface *surface = _ttf_surface_cache_get_or_add(fontDesc->font, text);
-	if (surface == NULL) {
-		return;
-	}
-
-	if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) == -1) {
+	int width, height;
+	uint8 *bitmapText = ttf_render_string_bitmap(FONT_SIZE_TINY, text, &width, &height);
+	if (bitmapText == NULL) {
 		return;
 	}
 
-	int pitch = surface->pitch;
-	int width = surface->w;
-	int height = surface->h;
-	uint8 *src = surface->pixels;
+	int pitch = width;
+	uint8 *src = bitmapText;
 
 	// Offset
 	height -= 3;
 	src += 3 * pitch;
-	height = min(height, 8);
-
-	int x = 0;
-	while (true) {
-		// Skip any none displayed columns
-		if (scroll == 0) {
-			sint16 scrollPosition = *scrollPositionOffsets;
-			if (scrollPosition == -1) return;
-			if (scrollPosition > -1) {
-				uint8 *dst = &bitmap[scrollPosition];
-
-				for (int y = 0; y < height; y++) {
-					if (src[y * pitch + x] != 0) *dst = colour;
-
-					// Jump to next row
-					dst += 64;
-				}
-			}
-			scrollPositionOffsets++;
-		} else {
-			scroll--;
+	height = clamp(0, height, 8);
+
+	strip->width = width;
+	strip->columns = malloc(max(width, 1));
+	strip->colours = malloc(max(width, 1));
+	memset(strip->colours, colour, width);
+	for (int x = 0; x < width; x++) {
+		uint8 columnBits = 0;
+		for (int y = 0; y < height; y++) {
+			if (src[y * pitch + x] != 0) columnBits |= 1 << y;
 		}
-
-		x++;
-		if (x >= width) x = 0;
+		strip->columns[x] = columnBits;
 	}
 
-	if (SDL_MUSTLOCK(surface)) SDL_UnlockSurface(surface);
+	free(bitmapText);
 }
@@ -31,6 +31,46 @@ rct_gx g2;
 
 rct_g1_element *g1Elements = (rct_g1_element*)RCT2_ADDRESS_G1_ELEMENTS;
 
+// When a sprite archive is memory mapped its pixel data is read straight out of the mapping and only paged in when a
+// sprite is first drawn. Without a mapping the data is read into a heap buffer as before.
+static void *_g1Mapping = NULL;
+static size_t _g1MappingSize;
+static void *_g2Mapping = NULL;
+static size_t _g2MappingSize;
+
+/**
+ * Maps a g1 format file and checks it is large enough to hold the given number of element headers and the data size
+ * stored in its header. Returns a pointer to the element headers.
+ */
+static rct_g1_element *gfx_map_gx(const utf8 *path, rct_g1_header *header, uint32 numEntries, void **outMapping, size_t *outMappingSize)
+{
+	size_t size;
+	uint8 *mapping = platform_file_map(path, &size);
+	if (mapping == NULL) {
+		return NULL;
+	}
+
+	if (size < 8) {
+		platform_file_unmap(mapping, size);
+		return NULL;
+	}
+	memcpy(header, mapping, 8);
+	if (numEntries == 0) {
+		numEntries = header->num_entries;
+	}
+
+	uint64 requiredSize = 8 + (uint64)numEntries * sizeof(rct_g1_element) + header->total_size;
+	if (requiredSize > size) {
+		log_warning("%s is truncated, reading it normally", path);
+		platform_file_unmap(mapping, size);
+		return NULL;
+	}
+
+	*outMapping = mapping;
+	*outMappingSize = size;
+	return (rct_g1_element*)(mapping + 8);
+}
+
 /**
  *
  *  rct2: 0x00678998
@@ -43,12 +83,27 @@ int gfx_load_g1()
 	rct_g1_header header;
 	unsigned int i;
 
-	file = SDL_RWFromFile(get_file_path(PATH_ID_G1), "rb");
+	// number of elements is stored in g1.dat, but because the entry headers are static, this can't be variable until
+	// made into a dynamic array
+	const uint32 numEntries = 29294;
+
+	const utf8 *path = get_file_path(PATH_ID_G1);
+	rct_g1_element *mappedElements = gfx_map_gx(path, &header, numEntries, &_g1Mapping, &_g1MappingSize);
+	if (mappedElements != NULL) {
+		// The element headers are still copied as the rest of the game indexes the static array directly
+		memcpy(g1Elements, mappedElements, numEntries * sizeof(rct_g1_element));
+
+		uint8 *data = (uint8*)(mappedElements + numEntries);
+		for (i = 0; i < numEntries; i++)
+			g1Elements[i].offset += (int)data;
+
+		return 1;
+	}
+
+	file = SDL_RWFromFile(path, "rb");
 	if (file != NULL) {
 		if (SDL_RWread(file, &header, 8, 1) == 1) {
-			// number of elements is stored in g1.dat, but because the entry headers are static, this can't be variable until
-			// made into a dynamic array
-			header.num_entries = 29294;
+			header.num_entries = numEntries;
 
 			// Read element headers
 			SDL_RWread(file, g1Elements, header.num_entries * sizeof(rct_g1_element), 1);
@@ -76,11 +131,21 @@ int gfx_load_g1()
 
 void gfx_unload_g1()
 {
+	if (_g1Mapping != NULL) {
+		platform_file_unmap(_g1Mapping, _g1MappingSize);
+		_g1Mapping = NULL;
+	}
 	SafeFree(_g1Buffer);
 }
 
 void gfx_unload_g2()
 {
+	if (_g2Mapping != NULL) {
+		platform_file_unmap(_g2Mapping, _g2MappingSize);
+		_g2Mapping = NULL;
+	} else {
+		SafeFree(g2.data);
+	}
 	SafeFree(g2.elements);
 }
 
@@ -96,6 +161,20 @@ int gfx_load_g2()
 
 	platform_get_openrct_data_path(dataPath);
 	sprintf(path, "%s%cg2.dat", dataPath, platform_get_path_separator());
+
+	rct_g1_element *mappedElements = gfx_map_gx(path, &g2.header, 0, &_g2Mapping, &_g2MappingSize);
+	if (mappedElements != NULL) {
+		// Offsets are fixed up in a copy of the headers so the mapping itself stays clean and shared with the file
+		g2.elements = malloc(g2.header.num_entries * sizeof(rct_g1_element));
+		memcpy(g2.elements, mappedElements, g2.header.num_entries * sizeof(rct_g1_element));
+
+		g2.data = (uint8*)(mappedElements + g2.header.num_entries);
+		for (i = 0; i < g2.header.num_entries; i++)
+			g2.elements[i].offset += (int)g2.data;
+
+		return 1;
+	}
+
 	file = SDL_RWFromFile(path, "rb");
 	if (file != NULL) {
 		if (SDL_RWread(file, &g2.header, 8, 1) == 1) {
@@ -32,32 +32,52 @@ static void ttf_draw_string(rct_drawpixelinfo *dpi, char *buffer, int colour, in
 
 static bool _ttfInitialised = false;
 
-#define TTF_SURFACE_CACHE_SIZE 256
-#define TTF_GETWIDTH_CACHE_SIZE 1024
+enum {
+	TEXT_DRAW_FLAG_INSET = 1 << 0,
+	TEXT_DRAW_FLAG_OUTLINE = 1 << 1,
+	TEXT_DRAW_FLAG_Y_OFFSET_EFFECT = 1 << 29,
+	TEXT_DRAW_FLAG_TTF = 1 << 30,
+	TEXT_DRAW_FLAG_NO_DRAW = 1 << 31
+};
 
-typedef struct {
-	SDL_Surface *surface;
-	TTF_Font *font;
-	utf8 *text;
-	uint32 lastUseTick;
-} ttf_cache_entry;
+// Glyphs are packed into rows of this width, the atlas grows downwards as more glyphs are needed
+#define TTF_GLYPH_ATLAS_WIDTH 256
+#define TTF_GLYPH_ATLAS_INITIAL_HEIGHT 64
+// Glyphs for codepoints below this are looked up directly, others are kept in a hash table
+#define TTF_GLYPH_DIRECT_COUNT 256
+#define TTF_GLYPH_HASH_INITIAL_SIZE 64
+// Kerning between pairs of codepoints below this is cached
+#define TTF_KERNING_CACHE_COUNT 128
+#define TTF_KERNING_UNKNOWN -128
 
-static ttf_cache_entry _ttfSurfaceCache[TTF_SURFACE_CACHE_SIZE] = { 0 };
-static int _ttfSurfaceCacheCount = 0;
-static int _ttfSurfaceCacheHitCount = 0;
-static int _ttfSurfaceCacheMissCount = 0;
+typedef struct {
+	bool loaded;
+	uint32 codepoint;
+	uint16 atlas_x;
+	uint16 atlas_y;
+	uint16 width;
+	uint16 height;
+	sint16 offset_x;
+	sint16 offset_y;
+	sint16 lead;
+	sint16 advance;
+} ttf_glyph;
 
 typedef struct {
-	uint32 width;
 	TTF_Font *font;
-	utf8 *text;
-	uint32 lastUseTick;
-} ttf_getwidth_cache_entry;
-
-static ttf_getwidth_cache_entry _ttfGetWidthCache[TTF_GETWIDTH_CACHE_SIZE] = { 0 };
-static int _ttfGetWidthCacheCount = 0;
-static int _ttfGetWidthCacheHitCount = 0;
-static int _ttfGetWidthCacheMissCount = 0;
+	uint8 *pixels;
+	int height;
+	int row_x;
+	int row_y;
+	int row_height;
+	ttf_glyph direct_glyphs[TTF_GLYPH_DIRECT_COUNT];
+	ttf_glyph *glyphs;
+	int glyph_capacity;
+	int glyph_count;
+	sint8 kerning[TTF_KERNING_CACHE_COUNT][TTF_KERNING_CACHE_COUNT];
+} ttf_glyph_atlas;
+
+static ttf_glyph_atlas _ttfGlyphAtlases[FONT_SIZE_COUNT] = { 0 };
 
 /**
  *
@@ -720,142 +740,325 @@ void gfx_draw_string_centred_wrapped_partial(rct_drawpixelinfo *dpi, int x, int
 	}
 }
 
-static uint32 _ttf_surface_cache_hash(TTF_Font *font, const utf8 *text)
+static ttf_glyph_atlas *ttf_get_glyph_atlas(int fontSize)
 {
-	uint32 hash = ((uint32)font * 23) ^ 0xAAAAAAAA;
-	for (const utf8 *ch = text; *ch != 0; ch++) {
-		hash = ror32(hash, 3) ^ (*ch * 13);
+	ttf_glyph_atlas *atlas = &_ttfGlyphAtlases[fontSize];
+	if (atlas->font == NULL) {
+		atlas->font = gCurrentTTFFontSet->size[fontSize].font;
+		memset(atlas->kerning, TTF_KERNING_UNKNOWN, sizeof(atlas->kerning));
 	}
-	return hash;
+	return atlas;
 }
 
-static void _ttf_surface_cache_dispose(ttf_cache_entry *entry)
+static void ttf_glyph_atlas_dispose(ttf_glyph_atlas *atlas)
 {
-	if (entry->surface != NULL) {
-		SDL_FreeSurface(entry->surface);
-		free(entry->text);
-
-		entry->surface = NULL;
-		entry->font = NULL;
-		entry->text = NULL;
-	}
+	free(atlas->pixels);
+	free(atlas->glyphs);
+	memset(atlas, 0, sizeof(ttf_glyph_atlas));
 }
 
-static void _ttf_surface_cache_dispose_all()
+static bool ttf_glyph_atlas_allocate(ttf_glyph_atlas *atlas, int width, int height, int *outX, int *outY)
 {
-	for (int i = 0; i < TTF_SURFACE_CACHE_SIZE; i++) {
-		_ttf_surface_cache_dispose(&_ttfSurfaceCache[i]);
-		_ttfSurfaceCacheCount--;
+	if (width > TTF_GLYPH_ATLAS_WIDTH) {
+		return false;
 	}
-}
 
-SDL_Surface *_ttf_surface_cache_get_or_add(TTF_Font *font, const utf8 *text)
-{
-	ttf_cache_entry *entry;
-
-	uint32 hash = _ttf_surface_cache_hash(font, text);
-	int index = hash % TTF_SURFACE_CACHE_SIZE;
-	for (int i = 0; i < TTF_SURFACE_CACHE_SIZE; i++) {
-		entry = &_ttfSurfaceCache[index];
-
-		// Check if entry is a hit
-		if (entry->surface == NULL) break;
-		if (entry->font == font && strcmp(entry->text, text) == 0) {
-			_ttfSurfaceCacheHitCount++;
-			entry->lastUseTick = gCurrentDrawCount;
-			return entry->surface;
+	if (atlas->row_x + width > TTF_GLYPH_ATLAS_WIDTH) {
+		atlas->row_x = 0;
+		atlas->row_y += atlas->row_height;
+		atlas->row_height = 0;
+	}
+
+	int requiredHeight = atlas->row_y + height;
+	if (requiredHeight > atlas->height) {
+		int newHeight = max(atlas->height * 2, TTF_GLYPH_ATLAS_INITIAL_HEIGHT);
+		while (newHeight < requiredHeight) {
+			newHeight *= 2;
 		}
 
-		// If entry hasn't been used for a while, replace it
-		if (entry->lastUseTick < gCurrentDrawCount - 64) {
-			break;
+		uint8 *pixels = realloc(atlas->pixels, TTF_GLYPH_ATLAS_WIDTH * newHeight);
+		if (pixels == NULL) {
+			return false;
 		}
+		memset(pixels + TTF_GLYPH_ATLAS_WIDTH * atlas->height, 0, TTF_GLYPH_ATLAS_WIDTH * (newHeight - atlas->height));
+		atlas->pixels = pixels;
+		atlas->height = newHeight;
+	}
+
+	*outX = atlas->row_x;
+	*outY = atlas->row_y;
+	atlas->row_x += width;
+	atlas->row_height = max(atlas->row_height, height);
+	return true;
+}
+
+static void ttf_glyph_atlas_load(ttf_glyph_atlas *atlas, uint32 codepoint, ttf_glyph *glyph)
+{
+	memset(glyph, 0, sizeof(ttf_glyph));
+	glyph->loaded = true;
+	glyph->codepoint = codepoint;
 
-		// Check if next entry is a hit
-		if (++index >= TTF_SURFACE_CACHE_SIZE) index = 0;
+	int minX, maxX, minY, maxY, advance;
+	if (codepoint > 0xFFFF || TTF_GlyphMetrics(atlas->font, (uint16)codepoint, &minX, &maxX, &minY, &maxY, &advance) != 0) {
+		return;
 	}
+	glyph->advance = advance;
 
-	// Cache miss, replace entry with new surface
-	entry = &_ttfSurfaceCache[index];
-	_ttf_surface_cache_dispose(entry);
+	// SDL_ttf moves a string to the right when its first glyph extends left of the pen
+	glyph->lead = max(-minX, 0);
 
+	// Render the glyph as a string of its own so it is positioned exactly as it would be within a
+	// longer string
+	utf8 text[8];
+	*utf8_write_codepoint(text, codepoint) = 0;
 	SDL_Color c = { 0, 0, 0, 255 };
-	SDL_Surface *surface = TTF_RenderUTF8_Solid(font, text, c);
+	SDL_Surface *surface = TTF_RenderUTF8_Solid(atlas->font, text, c);
 	if (surface == NULL) {
-		return NULL;
+		return;
+	}
+	if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0) {
+		SDL_FreeSurface(surface);
+		return;
+	}
+
+	// Only store the part of the glyph that has any pixels set
+	int left = surface->w, top = surface->h, right = -1, bottom = -1;
+	for (int y = 0; y < surface->h; y++) {
+		const uint8 *src = (const uint8*)surface->pixels + y * surface->pitch;
+		for (int x = 0; x < surface->w; x++) {
+			if (src[x] != 0) {
+				left = min(left, x);
+				right = max(right, x);
+				top = min(top, y);
+				bottom = y;
+			}
+		}
+	}
+
+	int atlasX, atlasY;
+	int width = right - left + 1;
+	int height = bottom - top + 1;
+	if (right >= 0 && ttf_glyph_atlas_allocate(atlas, width, height, &atlasX, &atlasY)) {
+		for (int y = 0; y < height; y++) {
+			const uint8 *src = (const uint8*)surface->pixels + (top + y) * surface->pitch + left;
+			uint8 *dst = &atlas->pixels[(atlasY + y) * TTF_GLYPH_ATLAS_WIDTH + atlasX];
+			for (int x = 0; x < width; x++) {
+				dst[x] = src[x] != 0 ? 1 : 0;
+			}
+		}
+		glyph->atlas_x = atlasX;
+		glyph->atlas_y = atlasY;
+		glyph->width = width;
+		glyph->height = height;
+		glyph->offset_x = left - glyph->lead;
+		glyph->offset_y = top;
+	}
+
+	if (SDL_MUSTLOCK(surface)) {
+		SDL_UnlockSurface(surface);
 	}
+	SDL_FreeSurface(surface);
+}
+
+static ttf_glyph *ttf_glyph_atlas_find_hashed(ttf_glyph_atlas *atlas, uint32 codepoint)
+{
+	uint32 mask = atlas->glyph_capacity - 1;
+	uint32 index = (codepoint * 2654435761u) & mask;
+	while (atlas->glyphs[index].loaded && atlas->glyphs[index].codepoint != codepoint) {
+		index = (index + 1) & mask;
+	}
+	return &atlas->glyphs[index];
+}
+
+static bool ttf_glyph_atlas_grow_hash(ttf_glyph_atlas *atlas)
+{
+	ttf_glyph *oldGlyphs = atlas->glyphs;
+	int oldCapacity = atlas->glyph_capacity;
 
-	_ttfSurfaceCacheMissCount++;
-	// printf("CACHE HITS: %d   MISSES: %d)\n", _ttfSurfaceCacheHitCount, _ttfSurfaceCacheMissCount);
+	int capacity = max(oldCapacity * 2, TTF_GLYPH_HASH_INITIAL_SIZE);
+	ttf_glyph *glyphs = calloc(capacity, sizeof(ttf_glyph));
+	if (glyphs == NULL) {
+		return false;
+	}
 
-	_ttfSurfaceCacheCount++;
-	entry->surface = surface;
-	entry->font = font;
-	entry->text = _strdup(text);
-	entry->lastUseTick = gCurrentDrawCount;
-	return entry->surface;
+	atlas->glyphs = glyphs;
+	atlas->glyph_capacity = capacity;
+	for (int i = 0; i < oldCapacity; i++) {
+		if (oldGlyphs[i].loaded) {
+			*ttf_glyph_atlas_find_hashed(atlas, oldGlyphs[i].codepoint) = oldGlyphs[i];
+		}
+	}
+	free(oldGlyphs);
+	return true;
 }
 
-static void _ttf_getwidth_cache_dispose(ttf_getwidth_cache_entry *entry)
+static const ttf_glyph *ttf_get_glyph(ttf_glyph_atlas *atlas, uint32 codepoint)
 {
-	if (entry->text != NULL) {
-		free(entry->text);
+	static const ttf_glyph emptyGlyph = { 0 };
+
+	ttf_glyph *glyph;
+	if (codepoint < TTF_GLYPH_DIRECT_COUNT) {
+		glyph = &atlas->direct_glyphs[codepoint];
+	} else {
+		if (atlas->glyph_count * 2 >= atlas->glyph_capacity && !ttf_glyph_atlas_grow_hash(atlas)) {
+			return &emptyGlyph;
+		}
+		glyph = ttf_glyph_atlas_find_hashed(atlas, codepoint);
+		if (!glyph->loaded) {
+			atlas->glyph_count++;
+		}
+	}
 
-		entry->width = 0;
-		entry->font = NULL;
-		entry->text = NULL;
+	if (!glyph->loaded) {
+		ttf_glyph_atlas_load(atlas, codepoint, glyph);
 	}
+	return glyph;
 }
 
-static void _ttf_getwidth_cache_dispose_all()
+static int ttf_get_kerning(ttf_glyph_atlas *atlas, uint32 previousCodepoint, uint32 codepoint)
 {
-	for (int i = 0; i < TTF_GETWIDTH_CACHE_SIZE; i++) {
-		_ttf_getwidth_cache_dispose(&_ttfGetWidthCache[i]);
-		_ttfGetWidthCacheCount--;
+#ifdef SDL_TTF_VERSION_ATLEAST
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 14)
+	if (previousCodepoint > 0xFFFF || codepoint > 0xFFFF) {
+		return 0;
+	}
+	if (previousCodepoint >= TTF_KERNING_CACHE_COUNT || codepoint >= TTF_KERNING_CACHE_COUNT) {
+		return TTF_GetFontKerningSizeGlyphs(atlas->font, (uint16)previousCodepoint, (uint16)codepoint);
+	}
+
+	sint8 *kerning = &atlas->kerning[previousCodepoint][codepoint];
+	if (*kerning == TTF_KERNING_UNKNOWN) {
+		*kerning = (sint8)TTF_GetFontKerningSizeGlyphs(atlas->font, (uint16)previousCodepoint, (uint16)codepoint);
 	}
+	return *kerning;
+#endif
+#endif
+	return 0;
 }
 
-static uint32 _ttf_getwidth_cache_get_or_add(TTF_Font *font, const utf8 *text)
+static void ttf_draw_glyph(rct_drawpixelinfo *dpi, const ttf_glyph_atlas *atlas, const ttf_glyph *glyph, int x, int y, uint8 colour, uint8 shadowColour, int flags)
 {
-	ttf_getwidth_cache_entry *entry;
-
-	uint32 hash = _ttf_surface_cache_hash(font, text);
-	int index = hash % TTF_GETWIDTH_CACHE_SIZE;
-	for (int i = 0; i < TTF_GETWIDTH_CACHE_SIZE; i++) {
-		entry = &_ttfGetWidthCache[index];
-
-		// Check if entry is a hit
-		if (entry->text == NULL) break;
-		if (entry->font == font && strcmp(entry->text, text) == 0) {
-			_ttfGetWidthCacheHitCount++;
-			entry->lastUseTick = gCurrentDrawCount;
-			return entry->width;
+	int width = glyph->width;
+	int height = glyph->height;
+	int skipX = x + glyph->offset_x - dpi->x;
+	int skipY = y + glyph->offset_y - dpi->y;
+	const uint8 *src = &atlas->pixels[glyph->atlas_y * TTF_GLYPH_ATLAS_WIDTH + glyph->atlas_x];
+
+	if (skipX < 0) {
+		width += skipX;
+		src += -skipX;
+		skipX = 0;
+	}
+	if (skipY < 0) {
+		height += skipY;
+		src += -skipY * TTF_GLYPH_ATLAS_WIDTH;
+		skipY = 0;
+	}
+	width = min(width, dpi->width - skipX);
+	height = min(height, dpi->height - skipY);
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+
+	int dstPitch = dpi->width + dpi->pitch;
+	uint8 *dst = dpi->bits + skipX + skipY * dstPitch;
+	int srcScanSkip = TTF_GLYPH_ATLAS_WIDTH - width;
+	int dstScanSkip = dstPitch - width;
+
+	if (flags & TEXT_DRAW_FLAG_OUTLINE) {
+		for (int yy = 0; yy < height; yy++) {
+			for (int xx = 0; xx < width; xx++) {
+				if (*src != 0) {
+					*(dst + 1) = shadowColour; // right
+					*(dst - 1) = shadowColour; // left
+					*(dst - dstPitch) = shadowColour; // top
+					*(dst + dstPitch) = shadowColour; // bottom
+				}
+				src++;
+				dst++;
+			}
+			src += srcScanSkip;
+			dst += dstScanSkip;
+		}
+	} else {
+		for (int yy = 0; yy < height; yy++) {
+			for (int xx = 0; xx < width; xx++) {
+				if (*src != 0) {
+					if (flags & TEXT_DRAW_FLAG_INSET) {
+						*(dst + dstPitch + 1) = shadowColour;
+					}
+					*dst = colour;
+				}
+				src++;
+				dst++;
+			}
+			src += srcScanSkip;
+			dst += dstScanSkip;
 		}
+	}
+}
 
-		// If entry hasn't been used for a while, replace it
-		if (entry->lastUseTick < gCurrentDrawCount - 64) {
+/**
+ * Draws the glyphs of text up to the next format code and returns the width of the run. Nothing
+ * is drawn when dpi is NULL. With TEXT_DRAW_FLAG_TTF set, the run also ends at codepoints that
+ * are drawn using sprites.
+ */
+static int ttf_draw_glyph_run(rct_drawpixelinfo *dpi, ttf_glyph_atlas *atlas, const utf8 *text, int x, int y, uint8 colour, uint8 shadowColour, int flags)
+{
+	const utf8 *ch = text;
+	uint32 previousCodepoint = 0;
+	int codepoint;
+	int penX = 0;
+	while (!utf8_is_format_code(codepoint = utf8_get_next(ch, &ch))) {
+		if ((flags & TEXT_DRAW_FLAG_TTF) && utf8_should_use_sprite_for_codepoint(codepoint)) {
 			break;
 		}
 
-		// Check if next entry is a hit
-		if (++index >= TTF_GETWIDTH_CACHE_SIZE) index = 0;
+		const ttf_glyph *glyph = ttf_get_glyph(atlas, codepoint);
+		if (previousCodepoint == 0) {
+			penX = glyph->lead;
+		} else {
+			penX += ttf_get_kerning(atlas, previousCodepoint, codepoint);
+		}
+		if (dpi != NULL && glyph->width != 0) {
+			ttf_draw_glyph(dpi, atlas, glyph, x + penX, y, colour, shadowColour, flags);
+		}
+		penX += glyph->advance;
+		previousCodepoint = codepoint;
+	}
+	return penX;
+}
+
+uint8 *ttf_render_string_bitmap(int fontSize, const utf8 *text, int *outWidth, int *outHeight)
+{
+	if (!_ttfInitialised && !ttf_initialise())
+		return NULL;
+
+	ttf_glyph_atlas *atlas = ttf_get_glyph_atlas(fontSize);
+	if (atlas->font == NULL) {
+		return NULL;
 	}
 
-	// Cache miss, replace entry with new width
-	entry = &_ttfGetWidthCache[index];
-	_ttf_getwidth_cache_dispose(entry);
+	int width = ttf_draw_glyph_run(NULL, atlas, text, 0, 0, 0, 0, 0);
+	int height = TTF_FontHeight(atlas->font);
+	if (width <= 0 || height <= 0) {
+		return NULL;
+	}
 
-	int width, height;
-	TTF_SizeUTF8(font, text, &width, &height);
+	uint8 *bits = calloc(width * height, 1);
+	if (bits == NULL) {
+		return NULL;
+	}
 
-	_ttfGetWidthCacheMissCount++;
+	rct_drawpixelinfo dpi = { 0 };
+	dpi.bits = bits;
+	dpi.width = width;
+	dpi.height = height;
+	ttf_draw_glyph_run(&dpi, atlas, text, 0, 0, 1, 0, 0);
 
-	_ttfGetWidthCacheCount++;
-	entry->width = width;
-	entry->font = font;
-	entry->text = _strdup(text);
-	entry->lastUseTick = gCurrentDrawCount;
-	return entry->width;
+	*outWidth = width;
+	*outHeight = height;
+	return bits;
 }
 
 bool ttf_initialise()
@@ -891,8 +1094,9 @@ void ttf_dispose()
 	if (!_ttfInitialised)
 		return;
 
-	_ttf_surface_cache_dispose_all();
-	_ttf_getwidth_cache_dispose_all();
+	for (int i = 0; i < FONT_SIZE_COUNT; i++) {
+		ttf_glyph_atlas_dispose(&_ttfGlyphAtlases[i]);
+	}
 
 	for (int i = 0; i < 4; i++) {
 		TTFFontDescriptor *fontDesc = &(gCurrentTTFFontSet->size[i]);
@@ -911,14 +1115,6 @@ TTFFontDescriptor *ttf_get_font_from_sprite_base(uint16 spriteBase)
 	return &gCurrentTTFFontSet->size[font_get_size_from_sprite_base(spriteBase)];
 }
 
-enum {
-	TEXT_DRAW_FLAG_INSET = 1 << 0,
-	TEXT_DRAW_FLAG_OUTLINE = 1 << 1,
-	TEXT_DRAW_FLAG_Y_OFFSET_EFFECT = 1 << 29,
-	TEXT_DRAW_FLAG_TTF = 1 << 30,
-	TEXT_DRAW_FLAG_NO_DRAW = 1 << 31
-};
-
 typedef struct {
 	int startX;
 	int startY;
@@ -958,6 +1154,9 @@ static void ttf_draw_string_raw_sprite(rct_drawpixelinfo *dpi, const utf8 *text,
 	int codepoint;
 
 	while (!utf8_is_format_code(codepoint = utf8_get_next(ch, &ch))) {
+		if ((info->flags & TEXT_DRAW_FLAG_TTF) && utf8_should_use_sprite_for_codepoint(codepoint)) {
+			break;
+		}
 		ttf_draw_character_sprite(dpi, codepoint, info);
 	};
 }
@@ -973,98 +1172,23 @@ static void ttf_draw_string_raw_ttf(rct_drawpixelinfo *dpi, const utf8 *text, te
 		return;
 	}
 
+	int fontSize = font_get_size_from_sprite_base(info->font_sprite_base);
+	ttf_glyph_atlas *atlas = ttf_get_glyph_atlas(fontSize);
 	if (info->flags & TEXT_DRAW_FLAG_NO_DRAW) {
-		info->x += _ttf_getwidth_cache_get_or_add(fontDesc->font, text);
+		info->x += ttf_draw_glyph_run(NULL, atlas, text, 0, 0, 0, 0, info->flags);
 		return;
-	} else {
-		uint8 colour = info->palette[1];
-		SDL_Surface *surface = _ttf_surface_cache_get_or_add(fontDesc->font, text);
-		if (surface == NULL)
-			return;
-
-		if (SDL_MUSTLOCK(surface)) {
-			if (SDL_LockSurface(surface) != 0) {
-				return;
-			}
-		}
-
-		int fontSize = font_get_size_from_sprite_base(info->font_sprite_base);
-		int drawX = info->x + fontDesc->offset_x;
-		int drawY = info->y + fontDesc->offset_y;
-		int width = surface->w;
-		int height = surface->h;
-
-		int overflowX = (dpi->x + dpi->width) - (drawX + width);
-		int overflowY = (dpi->y + dpi->height) - (drawY + height);
-		if (overflowX < 0) width += overflowX;
-		if (overflowY < 0) height += overflowY;
-		int skipX = drawX - dpi->x;
-		int skipY = drawY - dpi->y;
-		info->x += width;
-
-		uint8 *src = surface->pixels;
-		uint8 *dst = dpi->bits;
-
-		if (skipX < 0) {
-			width += skipX;
-			src += -skipX;
-			skipX = 0;
-		}
-		if (skipY < 0) {
-			height += skipY;
-			src += (-skipY * surface->pitch);
-			skipY = 0;
-		}
-
-		dst += skipX;
-		dst += skipY * (dpi->width + dpi->pitch);
-
-		int srcScanSkip = surface->pitch - width;
-		int dstScanSkip = dpi->width + dpi->pitch - width;
-		uint8 *dst_orig = dst;
-		uint8 *src_orig = src;
-
-		// Draw shadow/outline
-		if (info->flags & TEXT_DRAW_FLAG_OUTLINE) {
-			for (int yy = 0; yy < height - 0; yy++) {
-				for (int xx = 0; xx < width - 0; xx++) {
-					if (*src != 0) {
-						*(dst + 1) = info->palette[3]; // right
-						*(dst - 1) = info->palette[3]; // left
-						*(dst - width - dstScanSkip) = info->palette[3]; // top
-						*(dst + width + dstScanSkip) = info->palette[3]; // bottom
-					}
-					src++;
-					dst++;
-				}
-				// Skip any remaining bits
-				src += srcScanSkip;
-				dst += dstScanSkip;
-			}
-		}
-		{
-			dst = dst_orig;
-			src = src_orig;
-			for (int yy = 0; yy < height; yy++) {
-				for (int xx = 0; xx < width; xx++) {
-					if (*src != 0) {
-						if (info->flags & TEXT_DRAW_FLAG_INSET) {
-							*(dst + width + dstScanSkip + 1) = info->palette[3];
-						}
-						*dst = colour;
-					}
-					src++;
-					dst++;
-				}
-				src += srcScanSkip;
-				dst += dstScanSkip;
-			}
-		}
+	}
 
-		if (SDL_MUSTLOCK(surface)) {
-			SDL_UnlockSurface(surface);
-		}
+	// The outline of every glyph is drawn before any of the glyphs themselves so it never covers
+	// part of a neighbouring glyph
+	int drawX = info->x + fontDesc->offset_x;
+	int drawY = info->y + fontDesc->offset_y;
+	uint8 colour = info->palette[1];
+	uint8 shadowColour = info->palette[3];
+	if (info->flags & TEXT_DRAW_FLAG_OUTLINE) {
+		ttf_draw_glyph_run(dpi, atlas, text, drawX, drawY, colour, shadowColour, info->flags);
 	}
+	info->x += ttf_draw_glyph_run(dpi, atlas, text, drawX, drawY, colour, shadowColour, info->flags & ~TEXT_DRAW_FLAG_OUTLINE);
 }
 
 static void ttf_draw_string_raw(rct_drawpixelinfo *dpi, const utf8 *text, text_draw_info *info)
@@ -1182,11 +1306,11 @@ static const utf8 *ttf_process_format_code(rct_drawpixelinfo *dpi, const utf8 *t
 
 static const utf8 *ttf_process_glyph_run(rct_drawpixelinfo *dpi, const utf8 *text, text_draw_info *info)
 {
-	utf8 buffer[512];
 	const utf8 *ch = text;
 	const utf8 *lastCh;
 	int codepoint;
 
+	// Both the sprite and the TrueType renderer stop drawing at the end of the run by themselves
 	bool isTTF = info->flags & TEXT_DRAW_FLAG_TTF;
 	while (!utf8_is_format_code(codepoint = utf8_get_next(ch, &lastCh))) {
 		if (isTTF && utf8_should_use_sprite_for_codepoint(codepoint)) {
@@ -1194,16 +1318,8 @@ static const utf8 *ttf_process_glyph_run(rct_drawpixelinfo *dpi, const utf8 *tex
 		}
 		ch = lastCh;
 	}
-	if (codepoint == 0) {
-		ttf_draw_string_raw(dpi, text, info);
-		return ch;
-	} else {
-		int length = ch - text;
-		memcpy(buffer, text, length);
-		buffer[length] = 0;
-		ttf_draw_string_raw(dpi, buffer, info);
-		return ch;
-	}
+	ttf_draw_string_raw(dpi, text, info);
+	return ch;
 }
 
 static void ttf_process_string(rct_drawpixelinfo *dpi, const utf8 *text, text_draw_info *info)
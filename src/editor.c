@@ -41,6 +41,7 @@
 #include "world/climate.h"
 #include "world/footpath.h"
 #include "world/map.h"
+#include "world/map_animation.h"
 #include "world/park.h"
 #include "world/scenery.h"
 #include "world/sprite.h"
@@ -388,6 +389,7 @@ static int editor_read_s6(const char *path)
 
 		reset_loaded_objects();
 		map_update_tile_pointers();
+		map_animation_mark_loaded();
 		map_remove_all_rides();
 
 		//
@@ -41,6 +41,7 @@
 #include "peep/peep.h"
 #include "peep/staff.h"
 #include "platform/platform.h"
+#include "replay.h"
 #include "ride/ride.h"
 #include "ride/ride_ratings.h"
 #include "ride/vehicle.h"
@@ -64,6 +65,7 @@
 int gGameSpeed = 1;
 float gDayNightCycle = 0;
 bool gInUpdateCode = false;
+int gGameUpdateThreads = 0;
 
 extern void game_command_callback_place_banner(int eax, int ebx, int ecx, int edx, int esi, int edi, int ebp);
 
@@ -82,6 +84,8 @@ int game_command_playerid = -1;
 rct_string_id gGameCommandErrorTitle;
 rct_string_id gGameCommandErrorText;
 
+rct_game_command_batch gGameCommandBatch;
+
 int game_command_callback_get_index(GAME_COMMAND_CALLBACK_POINTER* callback)
 {
 	for (int i = 0; i < countof(game_command_callback_table); i++ ) {
@@ -352,12 +356,19 @@ void game_logic_update()
 			return;
 		}
 	}
+	replay_update();
+
+	// Every command for this tick has run by now, later ones are given the next tick. Clients check
+	// the hash at the same point, after running the tick's commands in network_update.
+	network_update_state_hash();
+
 	RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32)++;
 	RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_TICKS, uint32)++;
 	RCT2_GLOBAL(RCT2_ADDRESS_SCREEN_AGE, sint16)++;
 	if (RCT2_GLOBAL(RCT2_ADDRESS_SCREEN_AGE, sint16) == 0)
 		RCT2_GLOBAL(RCT2_ADDRESS_SCREEN_AGE, sint16)--;
 
+	scenario_rand_begin_tick();
 	sub_68B089();
 	scenario_update();
 	climate_update();
@@ -376,10 +387,13 @@ void game_logic_update()
 	///////////////////////////
 
 	map_animation_invalidate_all();
-	vehicle_sounds_update();
-	peep_update_crowd_noise();
-	climate_update_sound();
-	editor_open_windows_for_current_step();
+	if (!gOpenRCT2Headless) {
+		// Nobody is there to hear the sounds or use the windows when headless
+		vehicle_sounds_update();
+		peep_update_crowd_noise();
+		climate_update_sound();
+		editor_open_windows_for_current_step();
+	}
 
 	RCT2_GLOBAL(RCT2_ADDRESS_SAVED_AGE, uint16)++;
 
@@ -429,6 +443,38 @@ int game_do_command(int eax, int ebx, int ecx, int edx, int esi, int edi, int eb
 	return game_do_command_p(esi, &eax, &ebx, &ecx, &edx, &esi, &edi, &ebp);
 }
 
+/**
+ * Whether a command can change map elements the ride ratings look at without adding or removing
+ * them, which map_element_insert and map_element_remove already account for.
+ */
+static bool game_command_changes_map_elements_in_place(int command)
+{
+	switch (command) {
+	case GAME_COMMAND_SET_LAND_HEIGHT:
+	case GAME_COMMAND_SET_WATER_HEIGHT:
+	case GAME_COMMAND_RAISE_LAND:
+	case GAME_COMMAND_LOWER_LAND:
+	case GAME_COMMAND_EDIT_LAND_SMOOTH:
+	case GAME_COMMAND_RAISE_WATER:
+	case GAME_COMMAND_LOWER_WATER:
+	case GAME_COMMAND_PLACE_PATH:
+	case GAME_COMMAND_PLACE_PATH_FROM_TRACK:
+	case GAME_COMMAND_SET_MAZE_TRACK:
+	case GAME_COMMAND_CHEAT:
+		return true;
+	case GAME_COMMAND_BATCH:
+		for (int i = 0; i < gGameCommandBatch.count; i++) {
+			int subCommand = gGameCommandBatch.entries[i].command;
+			if (subCommand != GAME_COMMAND_BATCH && game_command_changes_map_elements_in_place(subCommand)) {
+				return true;
+			}
+		}
+		return false;
+	default:
+		return false;
+	}
+}
+
 /**
 *
 *  rct2: 0x006677F2 with pointers as arguments
@@ -509,9 +555,19 @@ int game_do_command_p(int command, int *eax, int *ebx, int *ecx, int *edx, int *
 				}
 			}
 
+			// Record the same top-level commands that would be sent over the network
+			if (RCT2_GLOBAL(0x009A8C28, uint8) == 1 && !(flags & GAME_COMMAND_FLAG_GHOST) && !(flags & GAME_COMMAND_FLAG_5) && command != GAME_COMMAND_LOAD_OR_QUIT) {
+				replay_record_command(*eax, *ebx, *ecx, *edx, *esi, *edi, *ebp, game_command_playerid);
+			}
+
 			// Second call to actually perform the operation
 			new_game_command_table[command](eax, ebx, ecx, edx, esi, edi, ebp);
 
+			// Ghosts and nested commands are left out as they run far too often, e.g. on every mouse move
+			if (RCT2_GLOBAL(0x009A8C28, uint8) == 1 && !(flags & GAME_COMMAND_FLAG_GHOST) && game_command_changes_map_elements_in_place(command)) {
+				ride_ratings_invalidate_proximity_cache();
+			}
+
 			// Do the callback (required for multiplayer to work correctly), but only for top level commands
 			if (RCT2_GLOBAL(0x009A8C28, uint8) == 1) {
 				if (game_command_callback && !(flags & GAME_COMMAND_FLAG_GHOST)) {
@@ -567,6 +623,168 @@ int game_do_command_p(int command, int *eax, int *ebx, int *ecx, int *edx, int *
 	return MONEY32_UNDEFINED;
 }
 
+/**
+ * Starts collecting game commands into gGameCommandBatch instead of running them one by one.
+ */
+void game_command_batch_begin()
+{
+	gGameCommandBatch.count = 0;
+}
+
+/**
+ * Adds a command to the current batch. The flags in ebx are combined with the flags the batch is
+ * run with, so GAME_COMMAND_FLAG_APPLY should not be set.
+ */
+bool game_command_batch_add(int command, int eax, int ebx, int ecx, int edx, int edi, int ebp)
+{
+	if (gGameCommandBatch.count >= GAME_COMMAND_BATCH_MAX_SIZE) {
+		return false;
+	}
+
+	rct_game_command_batch_entry *entry = &gGameCommandBatch.entries[gGameCommandBatch.count++];
+	entry->command = command;
+	entry->eax = eax;
+	entry->ebx = ebx & ~GAME_COMMAND_FLAG_APPLY;
+	entry->ecx = ecx;
+	entry->edx = edx;
+	entry->edi = edi;
+	entry->ebp = ebp;
+	return true;
+}
+
+/**
+ * Runs every command added since game_command_batch_begin as a single game command, which is costed,
+ * paid for and sent over the network once.
+ */
+money32 game_command_batch_end(int flags)
+{
+	if (gGameCommandBatch.count == 0) {
+		return MONEY32_UNDEFINED;
+	}
+	return game_do_command(0, flags, 0, 0, GAME_COMMAND_BATCH, 0, 0);
+}
+
+// Space taken by each command of the batch being checked
+static rct_map_clearance _gameCommandBatchClearances[GAME_COMMAND_BATCH_MAX_SIZE];
+
+/**
+ * Only commands whose check records the space they take in gSceneryPlaceClearance can be batched, as
+ * that is what lets the batch make sure its commands don't get in each other's way.
+ */
+static bool game_command_batch_is_allowed(int command)
+{
+	return command == GAME_COMMAND_PLACE_SCENERY;
+}
+
+/**
+ * Whether there are enough free map elements for every command of the batch. Inserting an element
+ * moves its whole tile to the end of the element list, including what earlier commands of the batch
+ * added to it.
+ */
+static bool game_command_batch_has_room()
+{
+	int required = 0;
+	for (int i = 0; i < gGameCommandBatch.count; i++) {
+		const rct_game_command_batch_entry *entry = &gGameCommandBatch.entries[i];
+		rct_map_element *mapElement = map_get_first_element_at(entry->eax / 32, entry->ecx / 32);
+		do {
+			required++;
+		} while (!map_element_is_last_for_tile(mapElement++));
+
+		for (int j = 0; j <= i; j++) {
+			if (gGameCommandBatch.entries[j].eax / 32 == entry->eax / 32 && gGameCommandBatch.entries[j].ecx / 32 == entry->ecx / 32) {
+				required++;
+			}
+		}
+	}
+
+	rct_map_element *mapElementsEnd = RCT2_ADDRESS(RCT2_ADDRESS_MAP_ELEMENTS_END, rct_map_element);
+	if (mapElementsEnd - RCT2_GLOBAL(RCT2_ADDRESS_NEXT_FREE_MAP_ELEMENT, rct_map_element*) >= required) {
+		return true;
+	}
+	map_reorganise_elements();
+	return mapElementsEnd - RCT2_GLOBAL(RCT2_ADDRESS_NEXT_FREE_MAP_ELEMENT, rct_map_element*) >= required;
+}
+
+/**
+ * Runs each command in gGameCommandBatch as a nested command. The commands are all checked against
+ * the map as it was before the batch, so the check also fails the batch if any two of them take the
+ * same space or the map would run out of elements part way through. Once the check passes none of
+ * the commands can fail, so the batch is either applied whole or not at all. All tile invalidation
+ * is deferred to a single pass over the affected area once the batch has been applied.
+ *
+ *  ebx: flags
+ */
+void game_command_batch(int *eax, int *ebx, int *ecx, int *edx, int *esi, int *edi, int *ebp)
+{
+	int flags = *ebx;
+	int playerId = game_command_playerid;
+	GAME_COMMAND_CALLBACK_POINTER *callback = game_command_callback;
+	money32 totalCost = 0;
+
+	if (!(flags & GAME_COMMAND_FLAG_APPLY)) {
+		for (int i = 0; i < gGameCommandBatch.count; i++) {
+			if (!game_command_batch_is_allowed(gGameCommandBatch.entries[i].command)) {
+				gGameCommandErrorText = STR_NONE;
+				*ebx = MONEY32_UNDEFINED;
+				return;
+			}
+		}
+	} else {
+		map_invalidate_begin_deferred();
+	}
+
+	for (int i = 0; i < gGameCommandBatch.count; i++) {
+		const rct_game_command_batch_entry *entry = &gGameCommandBatch.entries[i];
+		int subEax = entry->eax;
+		int subEbx = (entry->ebx & ~(GAME_COMMAND_FLAG_APPLY | GAME_COMMAND_FLAG_GHOST | GAME_COMMAND_FLAG_NETWORKED)) |
+			(flags & (GAME_COMMAND_FLAG_APPLY | GAME_COMMAND_FLAG_GHOST | GAME_COMMAND_FLAG_NETWORKED));
+		int subEcx = entry->ecx;
+		int subEdx = entry->edx;
+		int subEsi = entry->command;
+		int subEdi = entry->edi;
+		int subEbp = entry->ebp;
+
+		// Nested commands reset the player and callback when they finish or fail
+		game_command_playerid = playerId;
+		money32 cost = game_do_command_p(entry->command, &subEax, &subEbx, &subEcx, &subEdx, &subEsi, &subEdi, &subEbp);
+		game_command_callback = callback;
+		if (cost == MONEY32_UNDEFINED) {
+			if (!(flags & GAME_COMMAND_FLAG_APPLY)) {
+				game_command_playerid = playerId;
+				*ebx = MONEY32_UNDEFINED;
+				return;
+			}
+			log_error("Command %d of a batch failed to apply after passing its check", entry->command);
+			continue;
+		}
+
+		if (!(flags & GAME_COMMAND_FLAG_APPLY)) {
+			_gameCommandBatchClearances[i] = gSceneryPlaceClearance;
+			for (int j = 0; j < i; j++) {
+				if (map_clearances_intersect(&_gameCommandBatchClearances[i], &_gameCommandBatchClearances[j])) {
+					game_command_playerid = playerId;
+					gGameCommandErrorText = STR_OBJECT_IN_THE_WAY;
+					*ebx = MONEY32_UNDEFINED;
+					return;
+				}
+			}
+		}
+
+		totalCost += cost;
+	}
+	game_command_playerid = playerId;
+
+	if (flags & GAME_COMMAND_FLAG_APPLY) {
+		map_invalidate_end_deferred();
+	} else if (!game_command_batch_has_room()) {
+		gGameCommandErrorText = 894;
+		*ebx = MONEY32_UNDEFINED;
+		return;
+	}
+	*ebx = totalCost;
+}
+
 void pause_toggle()
 {
 	RCT2_GLOBAL(RCT2_ADDRESS_GAME_PAUSED, uint32) ^= 1;
@@ -777,6 +995,7 @@ int game_load_sv6(SDL_RWops* rw)
 	// The rest is the same as in scenario_load
 	reset_loaded_objects();
 	map_update_tile_pointers();
+	map_animation_mark_loaded();
 	reset_0x69EBE4();
 	openrct2_reset_object_tween_locations();
 	game_convert_strings_to_utf8();
@@ -892,6 +1111,7 @@ int game_load_network(SDL_RWops* rw)
 	// The rest is the same as in scenario load and play
 	reset_loaded_objects();
 	map_update_tile_pointers();
+	map_animation_mark_loaded();
 	reset_0x69EBE4();
 	openrct2_reset_object_tween_locations();
 	game_convert_strings_to_utf8();
@@ -945,6 +1165,9 @@ void game_load_init()
 {
 	rct_window *mainWindow;
 
+	// A recording is only valid for the park it started in
+	replay_stop_recording();
+
 	RCT2_GLOBAL(RCT2_ADDRESS_SCREEN_FLAGS, uint8) = SCREEN_FLAGS_PLAYING;
 	viewport_init_all();
 	game_create_windows();
@@ -1187,7 +1410,7 @@ void game_load_or_quit_no_save_prompt()
 	}
 }
 
-GAME_COMMAND_POINTER* new_game_command_table[66] = {
+GAME_COMMAND_POINTER* new_game_command_table[67] = {
 	game_command_set_ride_appearance,
 	game_command_set_land_height,
 	game_pause_toggle,
@@ -1253,5 +1476,6 @@ GAME_COMMAND_POINTER* new_game_command_table[66] = {
 	game_command_set_player_group,
 	game_command_modify_groups,
 	game_command_kick_player,
-	game_command_cheat
+	game_command_cheat,
+	game_command_batch
 };
@@ -91,7 +91,8 @@ enum GAME_COMMAND {
 	GAME_COMMAND_SET_PLAYER_GROUP,
 	GAME_COMMAND_MODIFY_GROUPS,
 	GAME_COMMAND_KICK_PLAYER,
-	GAME_COMMAND_CHEAT
+	GAME_COMMAND_CHEAT,
+	GAME_COMMAND_BATCH
 };
 
 enum {
@@ -108,6 +109,24 @@ enum {
 
 
 
+// Maximum number of sub-commands that can be sent in a single GAME_COMMAND_BATCH
+#define GAME_COMMAND_BATCH_MAX_SIZE 256
+
+typedef struct {
+	uint8 command;
+	sint32 eax;
+	sint32 ebx;
+	sint32 ecx;
+	sint32 edx;
+	sint32 edi;
+	sint32 ebp;
+} rct_game_command_batch_entry;
+
+typedef struct {
+	uint16 count;
+	rct_game_command_batch_entry entries[GAME_COMMAND_BATCH_MAX_SIZE];
+} rct_game_command_batch;
+
 typedef void (GAME_COMMAND_POINTER)(int* eax, int* ebx, int* ecx, int* edx, int* esi, int* edi, int* ebp);
 
 typedef void (GAME_COMMAND_CALLBACK_POINTER)(int eax, int ebx, int ecx, int edx, int esi, int edi, int ebp);
@@ -120,12 +139,18 @@ extern int game_command_playerid;
 extern rct_string_id gGameCommandErrorTitle;
 extern rct_string_id gGameCommandErrorText;
 
-extern GAME_COMMAND_POINTER* new_game_command_table[66];
+extern GAME_COMMAND_POINTER* new_game_command_table[67];
+
+extern rct_game_command_batch gGameCommandBatch;
 
 extern int gGameSpeed;
 extern float gDayNightCycle;
 extern bool gInUpdateCode;
 
+// Threads used for the parts of a tick that run in parallel when the park has entity random streams on, 0 for one
+// per processor
+extern int gGameUpdateThreads;
+
 void game_increase_game_speed();
 void game_reduce_game_speed();
 
@@ -138,6 +163,11 @@ void update_palette_effects();
 int game_do_command(int eax, int ebx, int ecx, int edx, int esi, int edi, int ebp);
 int game_do_command_p(int command, int *eax, int *ebx, int *ecx, int *edx, int *esi, int *edi, int *ebp);
 
+void game_command_batch_begin();
+bool game_command_batch_add(int command, int eax, int ebx, int ecx, int edx, int edi, int ebp);
+money32 game_command_batch_end(int flags);
+void game_command_batch(int *eax, int *ebx, int *ecx, int *edx, int *esi, int *edi, int *ebp);
+
 void game_increase_game_speed();
 void game_reduce_game_speed();
 
@@ -17,6 +17,9 @@
 #include "../world/banner.h"
 #include "../world/scenery.h"
 #include "../management/research.h"
+#include "../network/network.h"
+#include "../replay.h"
+#include "../state_hash.h"
 #include "../util/util.h"
 #include "console.h"
 #include "window.h"
@@ -493,6 +496,9 @@ static int cc_get(const utf8 **argv, int argc)
 		else if (strcmp(argv[0], "park_open") == 0) {
 			console_printf("park_open %d", (RCT2_GLOBAL(RCT2_ADDRESS_PARK_FLAGS, uint32) & PARK_FLAGS_PARK_OPEN) != 0);
 		}
+		else if (strcmp(argv[0], "entity_random_streams") == 0) {
+			console_printf("entity_random_streams %d", (RCT2_GLOBAL(RCT2_ADDRESS_PARK_FLAGS, uint32) & PARK_FLAGS_ENTITY_RANDOM_STREAMS) != 0);
+		}
 		else if (strcmp(argv[0], "land_rights_cost") == 0) {
 			console_printf("land_rights_cost %d.%d0", RCT2_GLOBAL(RCT2_ADDRESS_LAND_COST, money16) / 10, RCT2_GLOBAL(RCT2_ADDRESS_LAND_COST, money16) % 10);
 		}
@@ -633,6 +639,14 @@ static int cc_set(const utf8 **argv, int argc)
 			SET_FLAG(RCT2_GLOBAL(RCT2_ADDRESS_PARK_FLAGS, uint32), PARK_FLAGS_PARK_OPEN, int_val[0]);
 			console_execute_silent("get park_open");
 		}
+		else if (strcmp(argv[0], "entity_random_streams") == 0 && invalidArguments(&invalidArgs, int_valid[0])) {
+			if (network_get_mode() != NETWORK_MODE_NONE) {
+				console_writeline_error("Entity random streams can not be changed in a network game.");
+			} else {
+				SET_FLAG(RCT2_GLOBAL(RCT2_ADDRESS_PARK_FLAGS, uint32), PARK_FLAGS_ENTITY_RANDOM_STREAMS, int_val[0]);
+				console_execute_silent("get entity_random_streams");
+			}
+		}
 		else if (strcmp(argv[0], "land_rights_cost") == 0 && invalidArguments(&invalidArgs, double_valid[0])) {
 			RCT2_GLOBAL(RCT2_ADDRESS_LAND_COST, money16) = clamp(MONEY((int)double_val[0], ((int)(double_val[0] * 100)) % 100), MONEY(0, 0), MONEY(200, 0));
 			console_execute_silent("get land_rights_cost");
@@ -860,6 +874,54 @@ static int cc_fix_banner_count(const utf8 **argv, int argc)
 	return 0;
 }
 
+static int cc_dump_state(const utf8 **argv, int argc)
+{
+	if (argc < 1) {
+		console_writeline_error("Expected a file path.");
+		return 1;
+	}
+
+	rct_state_dump dump;
+	if (!state_hash_dump_create(&dump)) {
+		console_writeline_error("Unable to create game state dump.");
+		return 1;
+	}
+	if (state_hash_dump_save(&dump, argv[0])) {
+		console_printf("Game state at tick %u written to %s", dump.tick, argv[0]);
+	} else {
+		console_writeline_error("Unable to write game state dump.");
+	}
+	state_hash_dump_dispose(&dump);
+	return 0;
+}
+
+static int cc_record_replay(const utf8 **argv, int argc)
+{
+	if (argc < 1) {
+		console_writeline_error("Expected a file path.");
+		return 1;
+	}
+
+	if (replay_start_recording(argv[0])) {
+		console_printf("Recording game commands to %s", argv[0]);
+	} else {
+		console_writeline_error("Unable to start recording.");
+	}
+	return 0;
+}
+
+static int cc_stop_replay(const utf8 **argv, int argc)
+{
+	if (!replay_is_recording()) {
+		console_writeline_error("No replay is being recorded.");
+		return 1;
+	}
+
+	replay_stop_recording();
+	console_writeline("Recording stopped.");
+	return 0;
+}
+
 static int cc_open(const utf8 **argv, int argc) {
 	if (argc > 0) {
 		bool title = (RCT2_GLOBAL(RCT2_ADDRESS_SCREEN_FLAGS, uint8) & SCREEN_FLAGS_TITLE_DEMO) != 0;
@@ -918,6 +980,7 @@ utf8* console_variable_table[] = {
 	"land_rights_cost",
 	"construction_rights_cost",
 	"park_open",
+	"entity_random_streams",
 	"climate",
 	"game_speed",
 	"console_small_font",
@@ -952,7 +1015,12 @@ console_command console_command_table[] = {
 	{ "object_count", cc_object_count, "Shows the number of objects of each type in the scenario.", "object_count" },
 	{ "twitch", cc_twitch, "Twitch API" },
 	{ "reset_user_strings", cc_reset_user_strings, "Resets all user-defined strings, to fix incorrectly occurring 'Chosen name in use already' errors.", "reset_user_strings" },
-	{ "fix_banner_count", cc_fix_banner_count, "Fixes incorrectly appearing 'Too many banners' error by marking every banner entry without a map element as null.", "fix_banner_count" }
+	{ "fix_banner_count", cc_fix_banner_count, "Fixes incorrectly appearing 'Too many banners' error by marking every banner entry without a map element as null.", "fix_banner_count" },
+	{ "dump_state", cc_dump_state, "Writes a hash of every tile, sprite and ride to a file.\n"
+									"Compare two dumps with 'openrct2 state diff'.", "dump_state <file>" },
+	{ "record_replay", cc_record_replay, "Records the park and every game command from now on to a file.\n"
+										"Play it back with 'openrct2 replay'.", "record_replay <file>" },
+	{ "stop_replay", cc_stop_replay, "Stops recording a replay.", "stop_replay" }
 };
 
 static int cc_windows(const utf8 **argv, int argc) {
@@ -89,6 +89,7 @@ void viewport_init_all()
 	colours_init_maps();
 
 	// Setting up windows
+	window_free_surfaces();
 	gWindowNextSlot = g_window_list;
 	RCT2_GLOBAL(0x01423604, sint32) = 0;
 
@@ -2987,6 +2988,111 @@ void sub_68862C()
 	}
 }
 
+/**
+ * Pick results are kept for as long as nothing is drawn over the picked pixel, so repeated queries for a mouse
+ * position that has not moved (construction tools, tooltips and footpath placement all pick every frame, often
+ * several times with different flags) do not run the paint pipeline again. An entry is dropped when the dirty
+ * block containing its pixel is invalidated, which is exactly when a redraw could show something different there,
+ * or when map elements are moved in memory.
+ */
+#define VIEWPORT_PICK_CACHE_SIZE 4
+
+typedef struct {
+	bool valid;
+	sint16 screen_x;
+	sint16 screen_y;
+	uint16 flags;
+	rct_viewport *viewport;
+	sint16 x;
+	sint16 y;
+	sint16 width;
+	sint16 height;
+	sint16 view_x;
+	sint16 view_y;
+	uint8 zoom;
+	uint32 viewport_flags;
+	uint8 interaction_type;
+	uint8 interaction_var_29;
+	sint16 map_x;
+	sint16 map_y;
+	rct_map_element *map_element;
+} viewport_pick_cache_entry;
+
+static viewport_pick_cache_entry _pickCache[VIEWPORT_PICK_CACHE_SIZE];
+static int _pickCacheNextIndex;
+
+void viewport_pick_cache_invalidate()
+{
+	for (int i = 0; i < VIEWPORT_PICK_CACHE_SIZE; i++)
+		_pickCache[i].valid = false;
+}
+
+/**
+ * Left, top, right and bottom are inclusive dirty block indices, as marked by gfx_set_dirty_blocks.
+ */
+void viewport_pick_cache_invalidate_blocks(int left, int top, int right, int bottom)
+{
+	for (int i = 0; i < VIEWPORT_PICK_CACHE_SIZE; i++) {
+		viewport_pick_cache_entry *entry = &_pickCache[i];
+		if (!entry->valid)
+			continue;
+
+		int blockX = entry->screen_x >> RCT2_GLOBAL(0x009ABDF0, sint8);
+		int blockY = entry->screen_y >> RCT2_GLOBAL(0x009ABDF1, sint8);
+		if (blockX >= left && blockX <= right && blockY >= top && blockY <= bottom)
+			entry->valid = false;
+	}
+}
+
+static viewport_pick_cache_entry *viewport_pick_cache_find(int screenX, int screenY, int flags, rct_viewport *viewport)
+{
+	for (int i = 0; i < VIEWPORT_PICK_CACHE_SIZE; i++) {
+		viewport_pick_cache_entry *entry = &_pickCache[i];
+		if (entry->valid &&
+			entry->screen_x == screenX &&
+			entry->screen_y == screenY &&
+			entry->flags == (flags & 0xFFFF) &&
+			entry->viewport == viewport &&
+			entry->x == viewport->x &&
+			entry->y == viewport->y &&
+			entry->width == viewport->width &&
+			entry->height == viewport->height &&
+			entry->view_x == viewport->view_x &&
+			entry->view_y == viewport->view_y &&
+			entry->zoom == viewport->zoom &&
+			entry->viewport_flags == viewport->flags
+		) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+static void viewport_pick_cache_add(int screenX, int screenY, int flags, rct_viewport *viewport)
+{
+	viewport_pick_cache_entry *entry = &_pickCache[_pickCacheNextIndex];
+	_pickCacheNextIndex = (_pickCacheNextIndex + 1) % VIEWPORT_PICK_CACHE_SIZE;
+
+	entry->valid = true;
+	entry->screen_x = screenX;
+	entry->screen_y = screenY;
+	entry->flags = flags & 0xFFFF;
+	entry->viewport = viewport;
+	entry->x = viewport->x;
+	entry->y = viewport->y;
+	entry->width = viewport->width;
+	entry->height = viewport->height;
+	entry->view_x = viewport->view_x;
+	entry->view_y = viewport->view_y;
+	entry->zoom = viewport->zoom;
+	entry->viewport_flags = viewport->flags;
+	entry->interaction_type = RCT2_GLOBAL(0x9AC148, uint8_t);
+	entry->interaction_var_29 = RCT2_GLOBAL(0x9AC149, uint8_t);
+	entry->map_x = RCT2_GLOBAL(0x9AC14C, int16_t);
+	entry->map_y = RCT2_GLOBAL(0x9AC14E, int16_t);
+	entry->map_element = RCT2_GLOBAL(0x9AC150, rct_map_element*);
+}
+
 /**
  *
  *  rct2: 0x00685ADC
@@ -3007,11 +3113,23 @@ void get_map_coordinates_from_pos(int screenX, int screenY, int flags, sint16 *x
 	if (window != NULL && window->viewport != NULL)
 	{
 		rct_viewport* myviewport = window->viewport;
+		int originalScreenX = screenX;
+		int originalScreenY = screenY;
 		RCT2_GLOBAL(0x9AC138 + 4, int16_t) = screenX;
 		RCT2_GLOBAL(0x9AC138 + 6, int16_t) = screenY;
 		screenX -= (int)myviewport->x;
 		screenY -= (int)myviewport->y;
-		if (screenX >= 0 && screenX < (int)myviewport->width && screenY >= 0 && screenY < (int)myviewport->height)
+		// Entries are only added for positions inside the viewport and are keyed on its bounds
+		viewport_pick_cache_entry *cachedPick = viewport_pick_cache_find(originalScreenX, originalScreenY, flags, myviewport);
+		if (cachedPick != NULL)
+		{
+			RCT2_GLOBAL(0x9AC148, uint8_t) = cachedPick->interaction_type;
+			RCT2_GLOBAL(0x9AC149, uint8_t) = cachedPick->interaction_var_29;
+			RCT2_GLOBAL(0x9AC14C, int16_t) = cachedPick->map_x;
+			RCT2_GLOBAL(0x9AC14E, int16_t) = cachedPick->map_y;
+			RCT2_GLOBAL(0x9AC150, rct_map_element*) = cachedPick->map_element;
+		}
+		else if (screenX >= 0 && screenX < (int)myviewport->width && screenY >= 0 && screenY < (int)myviewport->height)
 		{
 			screenX <<= myviewport->zoom;
 			screenY <<= myviewport->zoom;
@@ -3034,6 +3152,7 @@ void get_map_coordinates_from_pos(int screenX, int screenY, int flags, sint16 *x
 			viewport_paint_setup();
 			sub_688217();
 			sub_68862C();
+			viewport_pick_cache_add(originalScreenX, originalScreenY, flags, myviewport);
 		}
 		if (viewport != NULL) *viewport = myviewport;
 	}
@@ -3071,7 +3190,7 @@ void viewport_invalidate(rct_viewport *viewport, int left, int top, int right, i
 		top += viewport->y;
 		right += viewport->x;
 		bottom += viewport->y;
-		gfx_set_dirty_blocks(left, top, right, bottom);
+		gfx_mark_dirty_blocks(left, top, right, bottom);
 	}
 }
 
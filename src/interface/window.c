@@ -37,6 +37,21 @@
 #define RCT2_LAST_WINDOW		(gWindowNextSlot - 1)
 #define RCT2_NEW_WINDOW			(gWindowNextSlot)
 
+/**
+ * A window's last drawing, kept so it can be copied to the screen when something behind the window
+ * is redrawn rather than painting the whole window again.
+ */
+typedef struct rct_window_surface {
+	uint8 *bits;
+	sint16 width;
+	sint16 height;
+	// Region relative to the window that needs painting again, empty when left >= right
+	sint16 dirty_left;
+	sint16 dirty_top;
+	sint16 dirty_right;
+	sint16 dirty_bottom;
+} rct_window_surface;
+
 rct_window g_window_list[MAX_WINDOW_COUNT];
 rct_window * gWindowFirst;
 rct_window * gWindowNextSlot;
@@ -74,6 +89,10 @@ float window_scroll_locations[][2] = {
 static bool sub_6EA95D(int x, int y, int width, int height);
 static void window_all_wheel_input();
 static int window_draw_split(rct_window *w, int left, int top, int right, int bottom);
+static bool window_draw_retained(rct_window *w, rct_drawpixelinfo *dpi);
+static void window_paint(rct_window *w, rct_drawpixelinfo *dpi);
+static void window_surface_invalidate(rct_window *w, int left, int top, int right, int bottom);
+static void window_surface_free(rct_window *w);
 
 int window_get_widget_index(rct_window *w, rct_widget *widget)
 {
@@ -458,6 +477,7 @@ rct_window *window_create(int x, int y, int width, int height, rct_window_event_
 	w->var_492 = 0;
 	w->selected_tab = 0;
 	w->var_4AE = 0;
+	w->surface = NULL;
 	RCT2_NEW_WINDOW++;
 
 	window_invalidate(w);
@@ -707,6 +727,7 @@ void window_close(rct_window* window)
 
 	// Invalidate the window (area)
 	window_invalidate(window);
+	window_surface_free(window);
 
 	// Remove window from list and reshift all windows
 	RCT2_NEW_WINDOW--;
@@ -922,8 +943,10 @@ int window_find_widget_from_point(rct_window *w, int x, int y)
  */
 void window_invalidate(rct_window *window)
 {
-	if (window != NULL)
-		gfx_set_dirty_blocks(window->x, window->y, window->x + window->width, window->y + window->height);
+	if (window != NULL) {
+		window_surface_invalidate(window, 0, 0, window->width, window->height);
+		gfx_mark_dirty_blocks(window->x, window->y, window->x + window->width, window->y + window->height);
+	}
 }
 
 /**
@@ -980,7 +1003,8 @@ void widget_invalidate(rct_window *w, int widgetIndex)
 	if (widget->left == -2)
 		return;
 
-	gfx_set_dirty_blocks(w->x + widget->left, w->y + widget->top, w->x + widget->right + 1, w->y + widget->bottom + 1);
+	window_surface_invalidate(w, widget->left, widget->top, widget->right + 1, widget->bottom + 1);
+	gfx_mark_dirty_blocks(w->x + widget->left, w->y + widget->top, w->x + widget->right + 1, w->y + widget->bottom + 1);
 }
 
 /**
@@ -1569,22 +1593,180 @@ void window_draw(rct_window *w, int left, int top, int right, int bottom)
 				continue;
 		}
 
-		RCT2_GLOBAL(0x01420070, sint32) = v->x;
+		if (window_draw_retained(v, dpi))
+			continue;
+
+		window_paint(v, dpi);
+	}
+}
+
+/**
+ * Calls the window's invalidate and paint events to draw it into the given pixels.
+ */
+static void window_paint(rct_window *w, rct_drawpixelinfo *dpi)
+{
+	RCT2_GLOBAL(0x01420070, sint32) = w->x;
+
+	// Invalidate modifies the window colours so first get the correct
+	// colour before setting the global variables for the string painting
+	window_event_invalidate_call(w);
 
-		// Invalidate modifies the window colours so first get the correct
-		// colour before setting the global variables for the string painting
-		window_event_invalidate_call(v);
+	// Text colouring
+	RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_WINDOW_COLOUR_1, uint8) = w->colours[0] & 0x7F;
+	RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_WINDOW_COLOUR_2, uint8) = w->colours[1] & 0x7F;
+	RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_WINDOW_COLOUR_3, uint8) = w->colours[2] & 0x7F;
+	RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_WINDOW_COLOUR_4, uint8) = w->colours[3] & 0x7F;
 
-		// Text colouring
-		RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_WINDOW_COLOUR_1, uint8) = v->colours[0] & 0x7F;
-		RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_WINDOW_COLOUR_2, uint8) = v->colours[1] & 0x7F;
-		RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_WINDOW_COLOUR_3, uint8) = v->colours[2] & 0x7F;
-		RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_WINDOW_COLOUR_4, uint8) = v->colours[3] & 0x7F;
+	window_event_paint_call(w, dpi);
+}
 
-		window_event_paint_call(v, dpi);
+/**
+ * Whether a window only draws over its own pixels, so that a drawing of it can be kept and copied
+ * to the screen. Windows with viewports change too often to be worth keeping.
+ */
+static bool window_can_retain_surface(rct_window *w)
+{
+	if (w->flags & (WF_TRANSPARENT | WF_NO_BACKGROUND))
+		return false;
+	if (w->viewport != NULL)
+		return false;
+	for (int i = 0; i < 4; i++)
+		if (w->colours[i] & COLOUR_FLAG_TRANSLUCENT)
+			return false;
+	return true;
+}
+
+static void window_surface_free(rct_window *w)
+{
+	if (w->surface != NULL) {
+		free(w->surface->bits);
+		free(w->surface);
+		w->surface = NULL;
 	}
 }
 
+/**
+ * Marks a region of the window's retained drawing, relative to the window, to be painted again.
+ */
+static void window_surface_invalidate(rct_window *w, int left, int top, int right, int bottom)
+{
+	rct_window_surface *surface = w->surface;
+	if (surface == NULL)
+		return;
+
+	left = max(left, 0);
+	top = max(top, 0);
+	right = min(right, surface->width);
+	bottom = min(bottom, surface->height);
+	if (left >= right || top >= bottom)
+		return;
+
+	if (surface->dirty_left >= surface->dirty_right) {
+		surface->dirty_left = left;
+		surface->dirty_top = top;
+		surface->dirty_right = right;
+		surface->dirty_bottom = bottom;
+	} else {
+		surface->dirty_left = min(surface->dirty_left, left);
+		surface->dirty_top = min(surface->dirty_top, top);
+		surface->dirty_right = max(surface->dirty_right, right);
+		surface->dirty_bottom = max(surface->dirty_bottom, bottom);
+	}
+}
+
+/**
+ * Marks the parts of all windows inside the given screen region to be painted again.
+ */
+void window_invalidate_surfaces(int left, int top, int right, int bottom)
+{
+	rct_window *w;
+
+	for (w = g_window_list; w < RCT2_NEW_WINDOW; w++) {
+		if (w->surface == NULL)
+			continue;
+
+		window_surface_invalidate(w, left - w->x, top - w->y, right - w->x, bottom - w->y);
+	}
+}
+
+/**
+ * Frees the retained drawings of all windows, for when the window list is reset without closing them.
+ */
+void window_free_surfaces()
+{
+	rct_window *w;
+
+	for (w = g_window_list; w < RCT2_NEW_WINDOW; w++) {
+		window_surface_free(w);
+	}
+}
+
+/**
+ * Draws the window by copying from its retained drawing, first painting any part of it that has
+ * been invalidated since. Returns false if the window has to be painted directly instead.
+ */
+static bool window_draw_retained(rct_window *w, rct_drawpixelinfo *dpi)
+{
+	rct_window_surface *surface;
+	rct_drawpixelinfo surfaceDPI;
+	uint8 *src, *dst;
+
+	if (!window_can_retain_surface(w)) {
+		window_surface_free(w);
+		return false;
+	}
+
+	surface = w->surface;
+	if (surface == NULL || surface->width != w->width || surface->height != w->height) {
+		window_surface_free(w);
+		surface = malloc(sizeof(rct_window_surface));
+		if (surface == NULL)
+			return false;
+
+		surface->bits = malloc(w->width * w->height);
+		if (surface->bits == NULL) {
+			free(surface);
+			return false;
+		}
+		surface->width = w->width;
+		surface->height = w->height;
+		surface->dirty_left = 0;
+		surface->dirty_top = 0;
+		surface->dirty_right = w->width;
+		surface->dirty_bottom = w->height;
+		w->surface = surface;
+	}
+
+	if (surface->dirty_left < surface->dirty_right) {
+		surfaceDPI.bits = surface->bits + surface->dirty_left + (surface->dirty_top * surface->width);
+		surfaceDPI.x = w->x + surface->dirty_left;
+		surfaceDPI.y = w->y + surface->dirty_top;
+		surfaceDPI.width = surface->dirty_right - surface->dirty_left;
+		surfaceDPI.height = surface->dirty_bottom - surface->dirty_top;
+		surfaceDPI.pitch = surface->width - surfaceDPI.width;
+		surfaceDPI.zoom_level = 0;
+		surface->dirty_right = surface->dirty_left;
+
+		window_paint(w, &surfaceDPI);
+
+		// The invalidate event may have changed the colours
+		if (!window_can_retain_surface(w)) {
+			window_surface_free(w);
+			window_paint(w, dpi);
+			return true;
+		}
+	}
+
+	src = surface->bits + (dpi->x - w->x) + ((dpi->y - w->y) * surface->width);
+	dst = dpi->bits;
+	for (int y = 0; y < dpi->height; y++) {
+		memcpy(dst, src, dpi->width);
+		src += surface->width;
+		dst += dpi->width + dpi->pitch;
+	}
+	return true;
+}
+
 /**
  * Splits a drawing of a window into regions that can be seen and are not hidden
  * by other opaque overlapping windows.
@@ -1686,8 +1868,8 @@ void window_move_position(rct_window *w, int dx, int dy)
 	if (dx == 0 && dy == 0)
 		return;
 
-	// Invalidate old region
-	window_invalidate(w);
+	// Invalidate old region, the retained drawing is relative to the window so is still valid
+	gfx_mark_dirty_blocks(w->x, w->y, w->x + w->width, w->y + w->height);
 
 	// Translate window and viewport
 	w->x += dx;
@@ -1698,7 +1880,7 @@ void window_move_position(rct_window *w, int dx, int dy)
 	}
 
 	// Invalidate new region
-	window_invalidate(w);
+	gfx_mark_dirty_blocks(w->x, w->y, w->x + w->width, w->y + w->height);
 }
 
 void window_resize(rct_window *w, int dw, int dh)
@@ -2216,7 +2398,7 @@ void window_invalidate_pressed_image_buttons(rct_window *w)
 			continue;
 
 		if (widget_is_pressed(w, widgetIndex) || widget_is_active_tool(w, widgetIndex))
-			gfx_set_dirty_blocks(w->x, w->y, w->x + w->width, w->y + w->height);
+			window_invalidate(w);
 	}
 }
 
@@ -2512,6 +2694,13 @@ void window_update_textbox_caret()
 	gTextBoxFrameNo++;
 	if (gTextBoxFrameNo > 30)
 		gTextBoxFrameNo = 0;
+
+	// Windows keep their last drawing, so the text box needs repainting when the caret blinks
+	if (gUsingWidgetTextBox && (gTextBoxFrameNo == 0 || gTextBoxFrameNo == 16)) {
+		rct_window *w = window_find_by_number(gCurrentTextBox.window.classification, gCurrentTextBox.window.number);
+		if (w != NULL)
+			widget_invalidate(w, gCurrentTextBox.widget_index);
+	}
 }
 
 void window_update_textbox()
@@ -291,6 +291,7 @@ typedef struct rct_window {
 	sint8 var_4B8;
 	sint8 var_4B9;
 	uint8 colours[6];			// 0x4BA
+	struct rct_window_surface *surface;	// Retained drawing of the window, see window_draw
 } rct_window;
 
 #define RCT_WINDOW_RIGHT(w) (w->x + w->width)
@@ -561,6 +562,8 @@ void window_show_textinput(rct_window *w, int widgetIndex, uint16 title, uint16
 void window_text_input_key(rct_window* w, int key);
 
 void window_draw(rct_window *w, int left, int top, int right, int bottom);
+void window_invalidate_surfaces(int left, int top, int right, int bottom);
+void window_free_surfaces();
 void window_draw_widgets(rct_window *w, rct_drawpixelinfo *dpi);
 void window_draw_viewport(rct_drawpixelinfo *dpi, rct_window *w);
 
@@ -9,13 +9,62 @@ static const encoding_convert_entry GB2312ToUnicodeTable[7445];
 static const encoding_convert_entry Big5ToUnicodeTable[13710];
 static const encoding_convert_entry RCT2ToUnicodeTable[256];
 
+// Characters in this range are encoded the same way in RCT2 strings and UTF-8
+#define ENCODING_PLAIN_FIRST 0x20
+#define ENCODING_PLAIN_LAST 0x7A
+
+// Dense lookup table for a double byte character set, built from its conversion table on first use
+typedef struct {
+	const encoding_convert_entry *entries;
+	int count;
+	uint8 lead_first;
+	uint8 lead_last;
+	uint8 trail_first;
+	uint8 trail_last;
+	uint16 *unicode;
+} encoding_lookup_table;
+
+static encoding_lookup_table _gb2312LookupTable = { GB2312ToUnicodeTable, countof(GB2312ToUnicodeTable), 0x21, 0x77, 0x21, 0x7E, NULL };
+static encoding_lookup_table _big5LookupTable = { Big5ToUnicodeTable, countof(Big5ToUnicodeTable), 0xA1, 0xF9, 0x40, 0xFE, NULL };
+
+// Indexed by unicode codepoint, 0 for codepoints that are not in RCT2ToUnicodeTable
+static uint8 *_unicodeToRct2 = NULL;
+
+/**
+ * Checks whether the 16 bytes at src are all plain characters that do not need converting.
+ */
+static bool encoding_is_plain_block(const char *src)
+{
+	const uint64 ones = UINT64_MAX / 255;
+	const uint64 highBits = ones * 0x80;
+
+	uint64 a, b;
+	memcpy(&a, src, sizeof(a));
+	memcpy(&b, src + sizeof(a), sizeof(b));
+
+	// Sets the high bit of some byte if any byte is below the first or above the last plain character
+	uint64 belowFirst = ((a - ones * ENCODING_PLAIN_FIRST) & ~a) | ((b - ones * ENCODING_PLAIN_FIRST) & ~b);
+	uint64 aboveLast = ((a + ones * (127 - ENCODING_PLAIN_LAST)) | a) | ((b + ones * (127 - ENCODING_PLAIN_LAST)) | b);
+	return ((belowFirst | aboveLast) & highBits) == 0;
+}
+
 int rct2_to_utf8(utf8 *dst, const char *src)
 {
 	int codepoint;
 
 	utf8 *start = dst;
 	const char *ch = src;
+	const char *end = src + strlen(src);
 	while (*ch != 0) {
+		while (end - ch >= 16 && encoding_is_plain_block(ch)) {
+			memcpy(dst, ch, 16);
+			dst += 16;
+			ch += 16;
+		}
+		if (*ch == 0) {
+			break;
+		}
+
 		if (*ch == (char)0xFF) {
 			ch++;
 
@@ -38,8 +87,18 @@ int utf8_to_rct2(char *dst, const utf8 *src)
 {
 	char *start = dst;
 	const utf8 *ch = src;
+	const utf8 *end = src + strlen(src);
 	int codepoint;
-	while ((codepoint = utf8_get_next(ch, &ch)) != 0) {
+	for (;;) {
+		while (end - ch >= 16 && encoding_is_plain_block(ch)) {
+			memcpy(dst, ch, 16);
+			dst += 16;
+			ch += 16;
+		}
+		if ((codepoint = utf8_get_next(ch, &ch)) == 0) {
+			break;
+		}
+
 		codepoint = encoding_convert_unicode_to_rct2(codepoint);
 		if (codepoint < 256) {
 			*dst++ = (char)codepoint;
@@ -53,44 +112,78 @@ int utf8_to_rct2(char *dst, const utf8 *src)
 	return dst - start;
 }
 
-static int encoding_search_compare(const void *pKey, const void *pEntry)
+static bool encoding_build_lookup_table(encoding_lookup_table *table)
 {
-	uint16 key = *((uint16*)pKey);
-	encoding_convert_entry *entry = (encoding_convert_entry*)pEntry;
-	if (key < entry->code) return -1;
-	if (key > entry->code) return 1;
-	return 0;
+	int trailCount = table->trail_last - table->trail_first + 1;
+	int size = (table->lead_last - table->lead_first + 1) * trailCount;
+	table->unicode = calloc(size, sizeof(uint16));
+	if (table->unicode == NULL) {
+		return false;
+	}
+
+	for (int i = 0; i < table->count; i++) {
+		int lead = table->entries[i].code >> 8;
+		int trail = table->entries[i].code & 0xFF;
+		table->unicode[(lead - table->lead_first) * trailCount + (trail - table->trail_first)] = table->entries[i].unicode;
+	}
+	return true;
 }
 
-static wchar_t encoding_convert_x_to_unicode(wchar_t code, const encoding_convert_entry *table, int count)
+static wchar_t encoding_convert_x_to_unicode(wchar_t code, encoding_lookup_table *table)
 {
-	encoding_convert_entry *entry = bsearch(&code, table, count, sizeof(encoding_convert_entry), encoding_search_compare);
-	if (entry == NULL) return code;
-	else return entry->unicode;
+	if (table->unicode == NULL && !encoding_build_lookup_table(table)) {
+		return code;
+	}
+
+	// Only the low 16 bits are used for the lookup
+	int lead = (code >> 8) & 0xFF;
+	int trail = code & 0xFF;
+	if (lead < table->lead_first || lead > table->lead_last || trail < table->trail_first || trail > table->trail_last) {
+		return code;
+	}
+
+	int trailCount = table->trail_last - table->trail_first + 1;
+	uint16 unicode = table->unicode[(lead - table->lead_first) * trailCount + (trail - table->trail_first)];
+	return unicode == 0 ? code : unicode;
 }
 
 wchar_t encoding_convert_unicode_to_rct2(wchar_t unicode)
 {
-	// Can't do a binary search as its sorted by RCT2 code, not unicode
-	for (int i = 0; i < countof(RCT2ToUnicodeTable); i++) {
-		if (RCT2ToUnicodeTable[i].unicode == unicode) return RCT2ToUnicodeTable[i].code;
+	if (_unicodeToRct2 == NULL) {
+		_unicodeToRct2 = calloc(0x10000, sizeof(uint8));
+		if (_unicodeToRct2 == NULL) {
+			return unicode;
+		}
+
+		// Go backwards so the lowest RCT2 code wins when several map to the same codepoint
+		for (int i = countof(RCT2ToUnicodeTable) - 1; i >= 0; i--) {
+			_unicodeToRct2[RCT2ToUnicodeTable[i].unicode] = (uint8)RCT2ToUnicodeTable[i].code;
+		}
 	}
-	return unicode;
+
+	if ((uint32)unicode > 0xFFFF || _unicodeToRct2[unicode] == 0) {
+		return unicode;
+	}
+	return _unicodeToRct2[unicode];
 }
 
 wchar_t encoding_convert_rct2_to_unicode(wchar_t rct2str)
 {
-	return encoding_convert_x_to_unicode(rct2str, RCT2ToUnicodeTable, countof(RCT2ToUnicodeTable));
+	// RCT2ToUnicodeTable has an entry for every code, in order
+	if (rct2str < 0 || rct2str >= countof(RCT2ToUnicodeTable)) {
+		return rct2str;
+	}
+	return RCT2ToUnicodeTable[rct2str].unicode;
 }
 
 wchar_t encoding_convert_gb2312_to_unicode(wchar_t gb2312)
 {
-	return encoding_convert_x_to_unicode(gb2312 - 0x8080, GB2312ToUnicodeTable, countof(GB2312ToUnicodeTable));
+	return encoding_convert_x_to_unicode(gb2312 - 0x8080, &_gb2312LookupTable);
 }
 
 wchar_t encoding_convert_big5_to_unicode(wchar_t big5)
 {
-	return encoding_convert_x_to_unicode(big5, Big5ToUnicodeTable, countof(Big5ToUnicodeTable));
+	return encoding_convert_x_to_unicode(big5, &_big5LookupTable);
 }
 
 static const encoding_convert_entry RCT2ToUnicodeTable[256] = {
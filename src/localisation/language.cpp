@@ -212,6 +212,8 @@ void language_close_all()
 {
 	SafeDelete(_languageFallback);
 	SafeDelete(_languageCurrent);
+	format_string_templates_clear();
+	scrolling_text_invalidate();
 	gCurrentLanguage = LANGUAGE_UNDEFINED;
 }
 
@@ -399,6 +401,7 @@ rct_string_id object_get_localised_text(uint8_t** pStringTable/*ebp*/, int type/
 		// Until all string related functions are finished copy
 		// to old array as well.
 		_languageOriginal[stringid] = *cacheString;
+		format_string_template_invalidate(stringid);
 		return stringid;
 	} else {
 		int stringid = STEX_BASE_STRING_ID + tableindex;
@@ -421,6 +424,7 @@ rct_string_id object_get_localised_text(uint8_t** pStringTable/*ebp*/, int type/
 		// Until all string related functions are finished copy
 		// to old array as well.
 		_languageOriginal[stringid] = *cacheString;
+		format_string_template_invalidate(stringid);
 		return stringid;
 	}
 }
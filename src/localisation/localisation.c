@@ -189,8 +189,229 @@ int utf8_get_format_code_arg_length(int codepoint)
 
 #pragma endregion
 
-void format_string_part_from_raw(char **dest, const char *src, char **args);
-void format_string_part(char **dest, rct_string_id format, char **args);
+void format_string_part_from_raw(utf8 **dest, size_t *size, const utf8 *src, char **args);
+void format_string_part(utf8 **dest, size_t *size, rct_string_id format, char **args);
+void format_string_code(unsigned int format_code, utf8 **dest, size_t *size, char **args);
+
+#pragma region Bounded output
+
+// Large enough for any number, currency or real name written by a single format code
+#define FORMAT_CODE_BUFFER_SIZE 128
+
+/**
+ * Gets the length of the character or control code with its arguments at the start of a string.
+ */
+static size_t format_get_unit_length(const utf8 *src)
+{
+	uint8 code = *src;
+	if (code < ' ') {
+		if (code <= 4) return 2;
+		if (code <= 16) return 1;
+		if (code <= 22) return 3;
+		return 5;
+	}
+	if (code < 0x80) return 1;
+	if ((code & 0xE0) == 0xC0) return 2;
+	if ((code & 0xF0) == 0xE0) return 3;
+	return 4;
+}
+
+/**
+ * Appends text to a string being formatted and terminates it. size is the space left including the
+ * terminator. Text that does not fit is cut before the first character or control code that would
+ * not fit whole, and nothing is appended after a cut.
+ */
+static void format_append(utf8 **dest, size_t *size, const utf8 *src, size_t length)
+{
+	if (length >= *size) {
+		size_t fitLength = 0;
+		while (fitLength < length) {
+			size_t unitLength = format_get_unit_length(src + fitLength);
+			if (fitLength + unitLength >= *size || fitLength + unitLength > length) {
+				break;
+			}
+			fitLength += unitLength;
+		}
+		length = fitLength;
+		*size = length + 1;
+	}
+	memcpy(*dest, src, length);
+	*dest += length;
+	*size -= length;
+	**dest = 0;
+}
+
+#pragma endregion
+
+#pragma region Format templates
+
+// Language strings are compiled into a list of operations the first time they are formatted so
+// the format codes do not need to be interpreted again on every call
+enum {
+	FORMAT_OP_END,
+	FORMAT_OP_LITERAL,	// uint16 length, followed by the text to copy
+	FORMAT_OP_CODE		// uint32 format code that consumes arguments
+};
+
+#define FORMAT_TEMPLATE_MAX_STRING_ID 0x8000
+
+typedef struct {
+	const utf8 *source;
+	uint8 *ops;
+} format_template;
+
+static format_template *_formatTemplates = NULL;
+static bool _formatTemplatesEnabled = true;
+
+static uint8 *format_template_write_literal(uint8 *op, const utf8 *literal, int length)
+{
+	while (length > 0) {
+		uint16 spanLength = (uint16)min(length, UINT16_MAX);
+		*op++ = FORMAT_OP_LITERAL;
+		memcpy(op, &spanLength, sizeof(spanLength));
+		op += sizeof(spanLength);
+		memcpy(op, literal, spanLength);
+		op += spanLength;
+		literal += spanLength;
+		length -= spanLength;
+	}
+	return op;
+}
+
+/**
+ * Compiles a string into format template operations. The literal text is produced in exactly the
+ * same way format_string_part_from_raw would write it, so control codes are never split between
+ * operations.
+ */
+static uint8 *format_template_compile(const utf8 *src)
+{
+	// Literal text can at most double in length when re-encoded and every character may need an
+	// operation header
+	size_t srcLength = strlen(src);
+	utf8 *literal = malloc(srcLength * 2 + 8);
+	uint8 *ops = malloc(srcLength * 8 + 8);
+	if (literal == NULL || ops == NULL) {
+		free(literal);
+		free(ops);
+		return NULL;
+	}
+
+	utf8 *literalEnd = literal;
+	uint8 *op = ops;
+	unsigned int code;
+	while ((code = utf8_get_next(src, &src)) != 0) {
+		if (code < ' ') {
+			int argLength;
+			if (code <= 4) argLength = 1;
+			else if (code <= 16) argLength = 0;
+			else if (code <= 22) argLength = 2;
+			else argLength = 4;
+
+			*literalEnd++ = code;
+			for (int i = 0; i < argLength; i++) {
+				*literalEnd++ = *src++;
+			}
+		} else if (code <= 'z') {
+			*literalEnd++ = code;
+		} else if (code < FORMAT_COLOUR_CODE_START || code == FORMAT_COMMA1DP16) {
+			op = format_template_write_literal(op, literal, literalEnd - literal);
+			literalEnd = literal;
+
+			uint32 formatCode = code;
+			*op++ = FORMAT_OP_CODE;
+			memcpy(op, &formatCode, sizeof(formatCode));
+			op += sizeof(formatCode);
+		} else {
+			literalEnd = utf8_write_codepoint(literalEnd, code);
+		}
+	}
+	op = format_template_write_literal(op, literal, literalEnd - literal);
+	*op++ = FORMAT_OP_END;
+	free(literal);
+
+	uint8 *shrunkOps = realloc(ops, op - ops);
+	return shrunkOps != NULL ? shrunkOps : ops;
+}
+
+static const uint8 *format_template_get(rct_string_id id, const utf8 *source)
+{
+	if (_formatTemplates == NULL) {
+		_formatTemplates = calloc(FORMAT_TEMPLATE_MAX_STRING_ID, sizeof(format_template));
+		if (_formatTemplates == NULL) {
+			return NULL;
+		}
+	}
+
+	format_template *formatTemplate = &_formatTemplates[id];
+	if (formatTemplate->ops == NULL || formatTemplate->source != source) {
+		free(formatTemplate->ops);
+		formatTemplate->source = source;
+		formatTemplate->ops = format_template_compile(source);
+	}
+	return formatTemplate->ops;
+}
+
+static void format_string_part_from_template(utf8 **dest, size_t *size, const uint8 *op, char **args)
+{
+	for (;;) {
+		switch (*op++) {
+		case FORMAT_OP_LITERAL:
+		{
+			uint16 length;
+			memcpy(&length, op, sizeof(length));
+			op += sizeof(length);
+			format_append(dest, size, (const utf8*)op, length);
+			op += length;
+			break;
+		}
+		case FORMAT_OP_CODE:
+		{
+			uint32 code;
+			memcpy(&code, op, sizeof(code));
+			op += sizeof(code);
+			format_string_code(code, dest, size, args);
+			break;
+		}
+		default:
+			return;
+		}
+	}
+}
+
+/**
+ * Discards the compiled template of a string whose text has changed.
+ */
+void format_string_template_invalidate(rct_string_id id)
+{
+	if (_formatTemplates != NULL && id < FORMAT_TEMPLATE_MAX_STRING_ID) {
+		format_template *formatTemplate = &_formatTemplates[id];
+		free(formatTemplate->ops);
+		formatTemplate->ops = NULL;
+		formatTemplate->source = NULL;
+	}
+}
+
+/**
+ * Turns compiled templates off so language strings are interpreted directly again, which lets the
+ * output of the two be compared.
+ */
+void format_string_templates_set_enabled(bool enabled)
+{
+	_formatTemplatesEnabled = enabled;
+}
+
+void format_string_templates_clear()
+{
+	if (_formatTemplates != NULL) {
+		for (int i = 0; i < FORMAT_TEMPLATE_MAX_STRING_ID; i++) {
+			free(_formatTemplates[i].ops);
+		}
+		free(_formatTemplates);
+		_formatTemplates = NULL;
+	}
+}
+
+#pragma endregion
 
 void format_integer(char **dest, long long value)
 {
@@ -502,15 +723,14 @@ void format_currency_2dp(char **dest, long long value)
 	}
 }
 
-void format_date(char **dest, uint16 value)
+void format_date(utf8 **dest, size_t *size, uint16 value)
 {
 	uint16 args[] = { date_get_month(value), date_get_year(value) + 1 };
 	uint16 *argsRef = args;
-	format_string_part(dest, 2736, (char**)&argsRef);
-	(*dest)--;
+	format_string_part(dest, size, 2736, (char**)&argsRef);
 }
 
-void format_length(char **dest, sint16 value)
+void format_length(utf8 **dest, size_t *size, sint16 value)
 {
 	rct_string_id stringId = 2733;
 
@@ -520,11 +740,10 @@ void format_length(char **dest, sint16 value)
 	}
 
 	sint16 *argRef = &value;
-	format_string_part(dest, stringId, (char**)&argRef);
-	(*dest)--;
+	format_string_part(dest, size, stringId, (char**)&argRef);
 }
 
-void format_velocity(char **dest, uint16 value)
+void format_velocity(utf8 **dest, size_t *size, uint16 value)
 {
 	rct_string_id stringId;
 
@@ -543,11 +762,10 @@ void format_velocity(char **dest, uint16 value)
 	}
 
 	uint16 *argRef = &value;
-	format_string_part(dest, stringId, (char**)&argRef);
-	(*dest)--;
+	format_string_part(dest, size, stringId, (char**)&argRef);
 }
 
-void format_duration(char **dest, uint16 value)
+void format_duration(utf8 **dest, size_t *size, uint16 value)
 {
 	uint16 minutes = value / 60;
 	uint16 seconds = value % 60;
@@ -566,11 +784,10 @@ void format_duration(char **dest, uint16 value)
 	if (seconds != 1)
 		stringId++;
 
-	format_string_part(dest, stringId, (char**)&argsRef);
-	(*dest)--;
+	format_string_part(dest, size, stringId, (char**)&argsRef);
 }
 
-void format_realtime(char **dest, uint16 value)
+void format_realtime(utf8 **dest, size_t *size, uint16 value)
 {
 	uint16 hours = value / 60;
 	uint16 minutes = value % 60;
@@ -589,13 +806,15 @@ void format_realtime(char **dest, uint16 value)
 	if (minutes != 1)
 		stringId++;
 
-	format_string_part(dest, stringId, (char**)&argsRef);
-	(*dest)--;
+	format_string_part(dest, size, stringId, (char**)&argsRef);
 }
 
-void format_string_code(unsigned int format_code, char **dest, char **args)
+void format_string_code(unsigned int format_code, utf8 **dest, size_t *size, char **args)
 {
 	int value;
+	// Numbers and sprites are written here first so they are only appended if they fit whole
+	utf8 buffer[FORMAT_CODE_BUFFER_SIZE];
+	utf8 *bufferEnd = buffer;
 
 	switch (format_code) {
 	case FORMAT_COMMA32:
@@ -603,56 +822,56 @@ void format_string_code(unsigned int format_code, char **dest, char **args)
 		value = *((sint32*)*args);
 		*args += 4;
 
-		format_comma_separated_integer(dest, value);
+		format_comma_separated_integer(&bufferEnd, value);
 		break;
 	case FORMAT_INT32:
 		// Pop argument
 		value = *((sint32*)*args);
 		*args += 4;
 
-		format_integer(dest, value);
+		format_integer(&bufferEnd, value);
 		break;
 	case FORMAT_COMMA2DP32:
 		// Pop argument
 		value = *((sint32*)*args);
 		*args += 4;
 
-		format_comma_separated_fixed_2dp(dest, value);
+		format_comma_separated_fixed_2dp(&bufferEnd, value);
 		break;
 		case FORMAT_COMMA1DP16:
 		// Pop argument
 		value = *((sint16*)*args);
 		*args += 2;
 
-		format_comma_separated_fixed_1dp(dest, value);
+		format_comma_separated_fixed_1dp(&bufferEnd, value);
 		break;
 	case FORMAT_COMMA16:
 		// Pop argument
 		value = *((sint16*)*args);
 		*args += 2;
 
-		format_comma_separated_integer(dest, value);
+		format_comma_separated_integer(&bufferEnd, value);
 		break;
 	case FORMAT_UINT16:
 		// Pop argument
 		value = *((uint16*)*args);
 		*args += 2;
 
-		format_integer(dest, value);
+		format_integer(&bufferEnd, value);
 		break;
 	case FORMAT_CURRENCY2DP:
 		// Pop argument
 		value = *((sint32*)*args);
 		*args += 4;
 
-		format_currency_2dp(dest, value);
+		format_currency_2dp(&bufferEnd, value);
 		break;
 	case FORMAT_CURRENCY:
 		// Pop argument
 		value = *((sint32*)*args);
 		*args += 4;
 
-		format_currency(dest, value);
+		format_currency(&bufferEnd, value);
 		break;
 	case FORMAT_STRINGID:
 	case FORMAT_STRINGID2:
@@ -660,8 +879,7 @@ void format_string_code(unsigned int format_code, char **dest, char **args)
 		value = *((uint16*)*args);
 		*args += 2;
 
-		format_string_part(dest, value, args);
-		(*dest)--;
+		format_string_part(dest, size, value, args);
 		break;
 	case FORMAT_STRING:
 		// Pop argument
@@ -669,8 +887,7 @@ void format_string_code(unsigned int format_code, char **dest, char **args)
 		*args += 4;
 
 		if (value != 0) {
-			strcpy(*dest, (char*)value);
-			*dest += strlen(*dest);
+			format_append(dest, size, (const utf8*)value, strlen((const utf8*)value));
 		}
 		break;
 	case FORMAT_MONTHYEAR:
@@ -678,22 +895,24 @@ void format_string_code(unsigned int format_code, char **dest, char **args)
 		value = *((uint16*)*args);
 		*args += 2;
 
-		format_date(dest, value);
+		format_date(dest, size, value);
 		break;
 	case FORMAT_MONTH:
+	{
 		// Pop argument
 		value = *((uint16*)*args);
 		*args += 2;
 
-		strcpy(*dest, language_get_string(STR_MONTH_MARCH + date_get_month(value)));
-		*dest += strlen(*dest);
+		const utf8 *month = language_get_string(STR_MONTH_MARCH + date_get_month(value));
+		format_append(dest, size, month, strlen(month));
 		break;
+	}
 	case FORMAT_VELOCITY:
 		// Pop argument
 		value = *((sint16*)*args);
 		*args += 2;
 
-		format_velocity(dest, value);
+		format_velocity(dest, size, value);
 		break;
 	case FORMAT_POP16:
 		*args += 2;
@@ -706,76 +925,89 @@ void format_string_code(unsigned int format_code, char **dest, char **args)
 		value = *((uint16*)*args);
 		*args += 2;
 
-		format_duration(dest, value);
+		format_duration(dest, size, value);
 		break;
 	case FORMAT_REALTIME:
 		// Pop argument
 		value = *((uint16*)*args);
 		*args += 2;
 
-		format_realtime(dest, value);
+		format_realtime(dest, size, value);
 		break;
 	case FORMAT_LENGTH:
 		// Pop argument
 		value = *((sint16*)*args);
 		*args += 2;
 
-		format_length(dest, value);
+		format_length(dest, size, value);
 		break;
 	case FORMAT_SPRITE:
 		// Pop argument
 		value = *((uint32*)*args);
 		*args += 4;
 
-		*(*dest)++ = 23;
-		*((uint32*)(*dest)) = value;
-		*dest += 4;
+		*bufferEnd++ = 23;
+		memcpy(bufferEnd, &value, sizeof(uint32));
+		bufferEnd += sizeof(uint32);
 		break;
 	}
+
+	if (bufferEnd != buffer) {
+		format_append(dest, size, buffer, bufferEnd - buffer);
+	}
 }
 
-void format_string_part_from_raw(utf8 **dest, const utf8 *src, char **args)
+/**
+ * Writes a string with its format codes replaced, leaving dest at the terminator.
+ */
+void format_string_part_from_raw(utf8 **dest, size_t *size, const utf8 *src, char **args)
 {
 	unsigned int code;
+	**dest = 0;
 	while (1) {
+		const utf8 *unit = src;
 		code = utf8_get_next(src, &src);
 		if (code < ' ') {
 			if (code == 0) {
-				*(*dest)++ = code;
 				break;
-			} else if (code <= 4) {
-				*(*dest)++ = code;
-				*(*dest)++ = *src++;
-			} else if (code <= 16) {
-				*(*dest)++ = code;
-			} else if (code <= 22) {
-				*(*dest)++ = code;
-				*(*dest)++ = *src++;
-				*(*dest)++ = *src++;
-			} else {
-				*(*dest)++ = code;
-				*(*dest)++ = *src++;
-				*(*dest)++ = *src++;
-				*(*dest)++ = *src++;
-				*(*dest)++ = *src++;
 			}
-		} else if (code <= 'z') {
-			*(*dest)++ = code;
+			// Control codes are copied whole with their arguments
+			size_t unitLength = format_get_unit_length(unit);
+			format_append(dest, size, unit, unitLength);
+			src = unit + unitLength;
 		} else if (code < FORMAT_COLOUR_CODE_START || code == FORMAT_COMMA1DP16) {
-			format_string_code(code, dest, args);
+			if (code <= 'z') {
+				utf8 ch = (utf8)code;
+				format_append(dest, size, &ch, 1);
+			} else {
+				format_string_code(code, dest, size, args);
+			}
 		} else {
-			*dest = utf8_write_codepoint(*dest, code);
+			utf8 buffer[8];
+			utf8 *bufferEnd = utf8_write_codepoint(buffer, code);
+			format_append(dest, size, buffer, bufferEnd - buffer);
 		}
 	}
 }
 
-void format_string_part(utf8 **dest, rct_string_id format, char **args)
+/**
+ * Writes a string with its format codes replaced, leaving dest at the terminator. size is the space
+ * left in dest including the terminator, and is reduced by what is written.
+ */
+void format_string_part(utf8 **dest, size_t *size, rct_string_id format, char **args)
 {
+	**dest = 0;
 	if (format == STR_NONE) {
-		**dest = 0;
+		return;
 	} else if (format < 0x8000) {
 		// Language string
-		format_string_part_from_raw(dest, language_get_string(format), args);
+		const utf8 *source = language_get_string(format);
+		const uint8 *ops = _formatTemplatesEnabled ? format_template_get(format, source) : NULL;
+		if (ops != NULL) {
+			format_string_part_from_template(dest, size, ops, args);
+		} else {
+			format_string_part_from_raw(dest, size, source, args);
+		}
 	} else if (format < 0x9000) {
 		// Custom string
 		format -= 0x8000;
@@ -784,16 +1016,17 @@ void format_string_part(utf8 **dest, rct_string_id format, char **args)
 		*args += (format & 0xC00) >> 9;
 		format &= ~0xC00;
 
-		strcpy(*dest, RCT2_ADDRESS(0x135A8F4 + (format * 32), char));
-		*dest = strchr(*dest, 0) + 1;
+		const utf8 *customString = RCT2_ADDRESS(0x135A8F4 + (format * 32), char);
+		format_append(dest, size, customString, strlen(customString));
 	} else if (format < 0xE000) {
 		// Real name
 		format -= -0xA000;
-		sprintf(*dest, "%s %c.",
+		utf8 buffer[FORMAT_CODE_BUFFER_SIZE];
+		int length = snprintf(buffer, sizeof(buffer), "%s %c.",
 			real_names[format % countof(real_names)],
 			real_name_initials[(format >> 10) % countof(real_name_initials)]
 		);
-		*dest = strchr(*dest, 0) + 1;
+		format_append(dest, size, buffer, min(length, (int)sizeof(buffer) - 1));
 
 		*args += 4;
 	} else {
@@ -813,12 +1046,27 @@ void format_string_part(utf8 **dest, rct_string_id format, char **args)
  */
 void format_string(utf8 *dest, rct_string_id format, void *args)
 {
-	format_string_part(&dest, format, (char**)&args);
+	size_t size = SIZE_MAX;
+	format_string_part(&dest, &size, format, (char**)&args);
 }
 
 void format_string_raw(utf8 *dest, utf8 *src, void *args)
 {
-	format_string_part_from_raw(&dest, src, (char**)&args);
+	size_t size = SIZE_MAX;
+	format_string_part_from_raw(&dest, &size, src, (char**)&args);
+}
+
+/**
+ * Writes a formatted string to a buffer of the given size, cutting it before the first character or
+ * control code that does not fit.
+ */
+void format_string_bounded(utf8 *dest, size_t size, rct_string_id format, void *args)
+{
+	if (size == 0) {
+		return;
+	}
+
+	format_string_part(&dest, &size, format, (char**)&args);
 }
 
 /**
@@ -34,7 +34,11 @@ int utf8_get_format_code_arg_length(int codepoint);
 
 void format_string(char *dest, rct_string_id format, void *args);
 void format_string_raw(char *dest, char *src, void *args);
+void format_string_bounded(char *dest, size_t size, rct_string_id format, void *args);
 void format_string_to_upper(char *dest, rct_string_id format, void *args);
+void format_string_template_invalidate(rct_string_id id);
+void format_string_templates_set_enabled(bool enabled);
+void format_string_templates_clear();
 void generate_string_file();
 void error_string_quit(int error, rct_string_id format);
 utf8 *get_string_end(const utf8 *text);
@@ -110,6 +110,7 @@ NetworkPacket::NetworkPacket()
 	transferred = 0;
 	read = 0;
 	size = 0;
+	size_prefix = 0;
 	data = std::make_shared<std::vector<uint8>>();
 }
 
@@ -118,9 +119,10 @@ std::unique_ptr<NetworkPacket> NetworkPacket::Allocate()
 	return std::unique_ptr<NetworkPacket>(new NetworkPacket); // change to make_unique in c++14
 }
 
-std::unique_ptr<NetworkPacket> NetworkPacket::Duplicate(NetworkPacket& packet)
+void NetworkPacket::EncodeSize()
 {
-	return std::unique_ptr<NetworkPacket>(new NetworkPacket(packet)); // change to make_unique in c++14
+	size = (uint16)data->size();
+	size_prefix = htons(size);
 }
 
 uint8* NetworkPacket::GetData()
@@ -325,6 +327,8 @@ NetworkConnection::NetworkConnection()
 	authstatus = NETWORK_AUTH_NONE;
 	player = 0;
 	socket = INVALID_SOCKET;
+	io_disconnected = false;
+	shutdown_pending = false;
 	ResetLastPacketTime();
 	last_disconnect_reason = NULL;
 }
@@ -342,81 +346,357 @@ NetworkConnection::~NetworkConnection()
 
 int NetworkConnection::ReadPacket()
 {
- 	if (inboundpacket.transferred < sizeof(inboundpacket.size)) {
-		// read packet size
-		int readBytes = recv(socket, &((char*)&inboundpacket.size)[inboundpacket.transferred], sizeof(inboundpacket.size) - inboundpacket.transferred, 0);
-		if (readBytes == SOCKET_ERROR || readBytes == 0) {
-			if (LAST_SOCKET_ERROR() != EWOULDBLOCK && LAST_SOCKET_ERROR() != EAGAIN) {
-				return NETWORK_READPACKET_DISCONNECTED;
-			} else {
-				return NETWORK_READPACKET_NO_DATA;
-			}
-		}
-		inboundpacket.transferred += readBytes;
-		if (inboundpacket.transferred == sizeof(inboundpacket.size)) {
-			inboundpacket.size = ntohs(inboundpacket.size);
-			if(inboundpacket.size == 0){ // Can't have a size 0 packet
-				return NETWORK_READPACKET_DISCONNECTED;
-			}
-			inboundpacket.data->resize(inboundpacket.size);
-		}
-	} else {
-		// read packet data
-		if (inboundpacket.data->capacity() > 0) {
-			int readBytes = recv(socket, (char*)&inboundpacket.GetData()[inboundpacket.transferred - sizeof(inboundpacket.size)], sizeof(inboundpacket.size) + inboundpacket.size - inboundpacket.transferred, 0);
-			if (readBytes == SOCKET_ERROR || readBytes == 0) {
-				if (LAST_SOCKET_ERROR() != EWOULDBLOCK && LAST_SOCKET_ERROR() != EAGAIN) {
-					return NETWORK_READPACKET_DISCONNECTED;
-				} else {
-					return NETWORK_READPACKET_NO_DATA;
-				}
-			}
-			inboundpacket.transferred += readBytes;
-		}
-		if (inboundpacket.transferred == sizeof(inboundpacket.size) + inboundpacket.size) {
-			last_packet_time = SDL_GetTicks();
+	int status;
+	do {
+		status = ReadNextPacket();
+		// Nothing more is handled from a closing connection. Its last packet time is left alone so it still times
+		// out if what was queued before closing can't be sent.
+	} while (closing && status == NETWORK_READPACKET_SUCCESS);
+
+	if (status == NETWORK_READPACKET_SUCCESS) {
+		last_packet_time = SDL_GetTicks();
+	}
+	return status;
+}
+
+int NetworkConnection::ReadNextPacket()
+{
+	if (threaded) {
+		// Check for a disconnection first so no packet received before it is missed
+		bool disconnected = io_disconnected;
+		std::shared_ptr<NetworkPacket> packet;
+		if (inbound_handoff.TryPop(&packet)) {
+			inboundpacket = *packet;
 			return NETWORK_READPACKET_SUCCESS;
 		}
+		return disconnected ? NETWORK_READPACKET_DISCONNECTED : NETWORK_READPACKET_NO_DATA;
 	}
-	return NETWORK_READPACKET_MORE_DATA;
+
+	return ReceivePacket(inboundpacket);
 }
 
-bool NetworkConnection::SendPacket(NetworkPacket& packet)
+int NetworkConnection::ReceivePacket(NetworkPacket& packet)
 {
-	uint16 sizen = htons(packet.size);
-	std::vector<uint8> tosend;
-	tosend.reserve(sizeof(sizen) + packet.size);
-	tosend.insert(tosend.end(), (uint8*)&sizen, (uint8*)&sizen + sizeof(sizen));
-	tosend.insert(tosend.end(), packet.data->begin(), packet.data->end());
-	while (1) {
-		int sentBytes = send(socket, (const char*)&tosend[packet.transferred], tosend.size() - packet.transferred, 0);
-		if (sentBytes == SOCKET_ERROR) {
-			return false;
-		}
-		packet.transferred += sentBytes;
-		if (packet.transferred == tosend.size()) {
-			return true;
+	int status = ReadBufferedPacket(packet);
+	if (status != NETWORK_READPACKET_MORE_DATA) {
+		return status;
+	}
+
+	// Not enough data buffered for another packet, read as much as the socket has available so
+	// that several packets can be handled per recv
+	if (inbound_buffer.empty()) {
+		inbound_buffer.resize(NETWORK_INBOUND_BUFFER_SIZE);
+	}
+	if (inbound_start == inbound_end) {
+		inbound_start = 0;
+		inbound_end = 0;
+	} else if (inbound_buffer.size() - inbound_end < NETWORK_MAX_PACKET_FRAME_SIZE) {
+		memmove(&inbound_buffer[0], &inbound_buffer[inbound_start], inbound_end - inbound_start);
+		inbound_end -= inbound_start;
+		inbound_start = 0;
+	}
+
+	int readBytes = recv(socket, (char*)&inbound_buffer[inbound_end], (int)(inbound_buffer.size() - inbound_end), 0);
+	if (readBytes == SOCKET_ERROR || readBytes == 0) {
+		if (LAST_SOCKET_ERROR() != EWOULDBLOCK && LAST_SOCKET_ERROR() != EAGAIN) {
+			return NETWORK_READPACKET_DISCONNECTED;
+		} else {
+			return NETWORK_READPACKET_NO_DATA;
 		}
 	}
-	return false;
+	inbound_end += readBytes;
+	return ReadBufferedPacket(packet);
+}
+
+int NetworkConnection::ReadBufferedPacket(NetworkPacket& packet)
+{
+	size_t available = inbound_end - inbound_start;
+	if (available < sizeof(uint16)) {
+		return NETWORK_READPACKET_MORE_DATA;
+	}
+
+	uint16 size;
+	memcpy(&size, &inbound_buffer[inbound_start], sizeof(size));
+	size = ntohs(size);
+	if (size == 0) { // Can't have a size 0 packet
+		return NETWORK_READPACKET_DISCONNECTED;
+	}
+	if (available < sizeof(uint16) + size) {
+		return NETWORK_READPACKET_MORE_DATA;
+	}
+
+	// Don't overwrite data that is still shared with a duplicate of the previous packet
+	if (!packet.data.unique()) {
+		packet.data = std::make_shared<std::vector<uint8>>();
+	}
+	const uint8* payload = &inbound_buffer[inbound_start + sizeof(uint16)];
+	packet.data->assign(payload, payload + size);
+	packet.size = size;
+	packet.transferred = sizeof(uint16) + size;
+	inbound_start += sizeof(uint16) + size;
+	return NETWORK_READPACKET_SUCCESS;
+}
+
+static void SetIoBuffer(NetworkIoBuffer& buffer, const uint8* data, size_t length)
+{
+#ifdef __WINDOWS__
+	buffer.buf = (char*)data;
+	buffer.len = (ULONG)length;
+#else
+	buffer.iov_base = (void*)data;
+	buffer.iov_len = length;
+#endif
+}
+
+static int SendIoBuffers(SOCKET socket, NetworkIoBuffer* buffers, size_t count)
+{
+#ifdef __WINDOWS__
+	DWORD sentBytes;
+	if (WSASend(socket, buffers, (DWORD)count, &sentBytes, 0, NULL, NULL) == SOCKET_ERROR) {
+		return SOCKET_ERROR;
+	}
+	return (int)sentBytes;
+#else
+	msghdr message = { 0 };
+	message.msg_iov = buffers;
+	message.msg_iovlen = count;
+	return (int)sendmsg(socket, &message, 0);
+#endif
+}
+
+static int PollSockets(NetworkPollSocket* sockets, size_t count, int timeout)
+{
+#ifdef __WINDOWS__
+	return WSAPoll(sockets, (ULONG)count, timeout);
+#else
+	return poll(sockets, (nfds_t)count, timeout);
+#endif
+}
+
+NetworkIoWakeup::NetworkIoWakeup()
+{
+	signalled = false;
+}
+
+bool NetworkIoWakeup::Open()
+{
+	sockaddr_in address = { 0 };
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+	socklen_t addressLength = sizeof(address);
+
+	socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (socket == INVALID_SOCKET) {
+		return false;
+	}
+	if (bind(socket, (sockaddr*)&address, addressLength) != 0 ||
+		getsockname(socket, (sockaddr*)&address, &addressLength) != 0 ||
+		connect(socket, (sockaddr*)&address, addressLength) != 0 ||
+		!NetworkConnection::SetNonBlocking(socket, true)
+	) {
+		Close();
+		return false;
+	}
+	signalled = false;
+	return true;
+}
+
+void NetworkIoWakeup::Close()
+{
+	if (socket != INVALID_SOCKET) {
+		closesocket(socket);
+		socket = INVALID_SOCKET;
+	}
+}
+
+void NetworkIoWakeup::Signal()
+{
+	if (!signalled.exchange(true)) {
+		char wakeup = 0;
+		send(socket, &wakeup, sizeof(wakeup), 0);
+	}
+}
+
+/**
+ * Called by the network thread before it looks for work, so a signal given while it works wakes it again.
+ */
+void NetworkIoWakeup::Reset()
+{
+	char buffer[16];
+	while (recv(socket, buffer, sizeof(buffer), 0) > 0) { }
+	// Exchanged rather than stored so that whatever was handed over before the last signal is seen
+	signalled.exchange(false);
 }
 
-void NetworkConnection::QueuePacket(std::unique_ptr<NetworkPacket> packet, bool front)
+SOCKET NetworkIoWakeup::GetSocket() const
+{
+	return socket;
+}
+
+void NetworkConnection::QueuePacket(std::shared_ptr<NetworkPacket> packet, bool front)
+{
+	packet->EncodeSize();
+	QueueEncodedPacket(std::move(packet), front);
+}
+
+void NetworkConnection::QueueEncodedPacket(std::shared_ptr<NetworkPacket> packet, bool front)
 {
 	if (authstatus == NETWORK_AUTH_OK || !packet->CommandRequiresAuth()) {
-		packet->size = (uint16)packet->data->size();
-		if (front) {
-			outboundpackets.push_front(std::move(packet));
+		if (threaded) {
+			QueuedPacket queuedPacket = { std::move(packet), front };
+			outbound_handoff.Push(std::move(queuedPacket));
+			io_wakeup->Signal();
 		} else {
-			outboundpackets.push_back(std::move(packet));
+			AddOutboundPacket(std::move(packet), front);
 		}
 	}
 }
 
+void NetworkConnection::AddOutboundPacket(std::shared_ptr<NetworkPacket> packet, bool front)
+{
+	OutboundPacket outboundPacket = { std::move(packet), 0 };
+	if (front) {
+		// Never put a packet in the middle of one that is partially sent
+		auto position = outboundpackets.begin();
+		if (position != outboundpackets.end() && position->transferred != 0) {
+			position++;
+		}
+		outboundpackets.insert(position, std::move(outboundPacket));
+	} else {
+		outboundpackets.push_back(std::move(outboundPacket));
+	}
+}
+
 void NetworkConnection::SendQueuedPackets()
 {
-	while (outboundpackets.size() > 0 && SendPacket(*(outboundpackets.front()).get())) {
-		outboundpackets.remove(outboundpackets.front());
+	// The network thread sends the packets of threaded connections
+	if (!threaded) {
+		SendOutboundPackets();
+		ShutdownIfSent();
+	}
+}
+
+/**
+ * Closes the connection once the packets queued so far have been sent, so the client gets to see why it was
+ * disconnected. Shutting the socket down straight away could lose them as the connection is removed as soon as its
+ * disconnection is noticed.
+ */
+void NetworkConnection::ShutdownAfterSending()
+{
+	closing = true;
+	shutdown_pending = true;
+	if (threaded) {
+		io_wakeup->Signal();
+	}
+	SendQueuedPackets();
+}
+
+void NetworkConnection::ShutdownIfSent()
+{
+	if (shutdown_pending && outboundpackets.empty()) {
+		shutdown(socket, SHUT_RD);
+		shutdown_pending = false;
+	}
+}
+
+/**
+ * Hands the socket I/O of the connection to the network thread, which wakeup wakes, or back to the game thread if it
+ * is null.
+ */
+void NetworkConnection::SetThreaded(NetworkIoWakeup* wakeup)
+{
+	threaded = wakeup != nullptr;
+	io_wakeup = wakeup;
+}
+
+/**
+ * Called by the network thread for threaded connections. Sends the packets queued by the game
+ * thread and hands every complete packet received to the game thread.
+ */
+void NetworkConnection::UpdateIo()
+{
+	// Checked before taking the queued packets so every packet queued before the shutdown was asked for is sent first
+	bool shutdownPending = shutdown_pending;
+	QueuedPacket queuedPacket;
+	while (outbound_handoff.TryPop(&queuedPacket)) {
+		AddOutboundPacket(std::move(queuedPacket.packet), queuedPacket.front);
+	}
+	SendOutboundPackets();
+	if (shutdownPending) {
+		ShutdownIfSent();
+	}
+
+	if (io_disconnected) {
+		return;
+	}
+	int status;
+	do {
+		std::shared_ptr<NetworkPacket> packet = std::make_shared<NetworkPacket>();
+		status = ReceivePacket(*packet);
+		if (status == NETWORK_READPACKET_SUCCESS) {
+			inbound_handoff.Push(std::move(packet));
+		}
+	} while (status == NETWORK_READPACKET_SUCCESS || status == NETWORK_READPACKET_MORE_DATA);
+	if (status == NETWORK_READPACKET_DISCONNECTED) {
+		io_disconnected = true;
+	}
+}
+
+bool NetworkConnection::IsIoDisconnected()
+{
+	return io_disconnected;
+}
+
+/**
+ * Whether there are packets the socket could not take yet. Only for the thread doing the connection's socket I/O.
+ */
+bool NetworkConnection::HasOutboundPackets()
+{
+	return !outboundpackets.empty();
+}
+
+void NetworkConnection::SendOutboundPackets()
+{
+	while (!outboundpackets.empty()) {
+		// Hand the size prefixes and data of as many queued packets as possible to the socket in one
+		// call without copying them
+		NetworkIoBuffer buffers[NETWORK_MAX_PACKETS_PER_SEND * 2];
+		size_t numBuffers = 0;
+		size_t numPackets = 0;
+		size_t totalBytes = 0;
+		for (auto it = outboundpackets.begin(); it != outboundpackets.end() && numPackets < NETWORK_MAX_PACKETS_PER_SEND; it++, numPackets++) {
+			const NetworkPacket& packet = *it->packet;
+			unsigned int offset = it->transferred;
+			if (offset < sizeof(uint16)) {
+				SetIoBuffer(buffers[numBuffers++], (const uint8*)&packet.size_prefix + offset, sizeof(uint16) - offset);
+				offset = sizeof(uint16);
+			}
+			SetIoBuffer(buffers[numBuffers++], packet.data->data() + (offset - sizeof(uint16)), packet.size - (offset - sizeof(uint16)));
+			totalBytes += sizeof(uint16) + packet.size - it->transferred;
+		}
+
+		int sentBytes = SendIoBuffers(socket, buffers, numBuffers);
+		if (sentBytes == SOCKET_ERROR) {
+			return;
+		}
+
+		size_t remaining = (size_t)sentBytes;
+		while (remaining > 0) {
+			OutboundPacket& outboundPacket = outboundpackets.front();
+			size_t packetRemaining = sizeof(uint16) + outboundPacket.packet->size - outboundPacket.transferred;
+			if (remaining < packetRemaining) {
+				outboundPacket.transferred += (unsigned int)remaining;
+				break;
+			}
+			remaining -= packetRemaining;
+			outboundpackets.pop_front();
+		}
+
+		// Stop once the socket's send buffer is full
+		if ((size_t)sentBytes < totalBytes) {
+			return;
+		}
 	}
 }
 
@@ -561,6 +841,7 @@ Network::Network()
 	last_tick_sent_time = 0;
 	last_ping_sent_time = 0;
 	last_advertise_time = 0;
+	io_thread_running = false;
 	client_command_handlers.resize(NETWORK_COMMAND_MAX, 0);
 	client_command_handlers[NETWORK_COMMAND_AUTH] = &Network::Client_Handle_AUTH;
 	client_command_handlers[NETWORK_COMMAND_MAP] = &Network::Client_Handle_MAP;
@@ -613,6 +894,7 @@ void Network::Close()
 		// which may no longer be valid on Linux and would cause a segfault.
 		return;
 	}
+	StopIoThread();
 	if (mode == NETWORK_MODE_CLIENT) {
 		closesocket(server_connection.socket);
 	} else
@@ -725,6 +1007,7 @@ bool Network::BeginServer(unsigned short port, const char* address)
 	last_heartbeat_time = 0;
 	advertise_token = "";
 	advertise_key = GenerateAdvertiseKey();
+	StartIoThread();
 
 #ifndef DISABLE_HTTP
 	if (gConfigNetwork.advertise) {
@@ -930,7 +1213,10 @@ void Network::UpdateClient()
 		ProcessGameCommandQueue();
 
 		// Check synchronisation
-		if (!_desynchronised && !CheckSRAND(RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32), RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_SRAND_0, uint32))) {
+		if (!_desynchronised && (
+			!CheckSRAND(RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32), RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_SRAND_0, uint32)) ||
+			!CheckStateHash(RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32))
+		)) {
 			_desynchronised = true;
 			char str_desync[256];
 			format_string(str_desync, STR_MULTIPLAYER_DESYNC, NULL);
@@ -1005,13 +1291,131 @@ const char* Network::FormatChat(NetworkPlayer* fromplayer, const char* text)
 	return formatted;
 }
 
-void Network::SendPacketToClients(NetworkPacket& packet, bool front)
+void Network::SendPacketToClients(std::unique_ptr<NetworkPacket> packet, bool front)
 {
+	// Every client queues the same packet, so it is only encoded once
+	std::shared_ptr<NetworkPacket> sharedPacket = std::move(packet);
+	sharedPacket->EncodeSize();
 	for (auto it = client_connection_list.begin(); it != client_connection_list.end(); it++) {
-		(*it)->QueuePacket(std::move(NetworkPacket::Duplicate(packet)), front);
+		(*it)->QueueEncodedPacket(sharedPacket, front);
 	}
 }
 
+/**
+ * Times SendPacketToClients for the given number of clients connected to this process over loopback. queueMs is set
+ * to the time spent queueing the packets and deliveryMs to the time until every client has received all of them.
+ */
+bool Network::BenchmarkBroadcast(int numClients, int numPackets, int packetSize, double* queueMs, double* deliveryMs)
+{
+	Close();
+	if (!Init())
+		return false;
+
+	// Close only closes the listening socket once in server mode, so every socket is closed here
+	// whichever step failed
+	std::vector<SOCKET> clientSockets;
+	auto closeAll = [this, &clientSockets]() -> void {
+		for (SOCKET clientSocket : clientSockets) {
+			closesocket(clientSocket);
+		}
+		if (listening_socket != INVALID_SOCKET) {
+			closesocket(listening_socket);
+			listening_socket = INVALID_SOCKET;
+		}
+		mode = NETWORK_MODE_NONE;
+		Close();
+	};
+
+	sockaddr_in address = { 0 };
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+	socklen_t addressLength = sizeof(address);
+
+	listening_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listening_socket == INVALID_SOCKET) {
+		log_error("Unable to create socket.");
+		closeAll();
+		return false;
+	}
+	if (bind(listening_socket, (sockaddr*)&address, addressLength) != 0 ||
+		listen(listening_socket, SOMAXCONN) != 0 ||
+		getsockname(listening_socket, (sockaddr*)&address, &addressLength) != 0
+	) {
+		log_error("Unable to listen on loopback.");
+		closeAll();
+		return false;
+	}
+	mode = NETWORK_MODE_SERVER;
+	status = NETWORK_STATUS_CONNECTED;
+	StartIoThread();
+
+	// The clients are plain sockets, the server side of each is set up the same way as in UpdateServer
+	for (int i = 0; i < numClients; i++) {
+		SOCKET clientSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (clientSocket == INVALID_SOCKET) {
+			log_error("Unable to create socket.");
+			closeAll();
+			return false;
+		}
+		clientSockets.push_back(clientSocket);
+		if (connect(clientSocket, (sockaddr*)&address, addressLength) != 0) {
+			log_error("Unable to connect to loopback.");
+			closeAll();
+			return false;
+		}
+
+		SOCKET serverSocket = accept(listening_socket, NULL, NULL);
+		if (serverSocket == INVALID_SOCKET || !NetworkConnection::SetNonBlocking(serverSocket, true)) {
+			log_error("Failed to accept client.");
+			if (serverSocket != INVALID_SOCKET) {
+				closesocket(serverSocket);
+			}
+			closeAll();
+			return false;
+		}
+		AddClient(serverSocket);
+
+		// The packets are game commands, which are only sent to authenticated clients
+		client_connection_list.back()->authstatus = NETWORK_AUTH_OK;
+	}
+
+	std::vector<uint8> payload(packetSize - sizeof(uint32));
+	uint64 startTime = SDL_GetPerformanceCounter();
+	for (int i = 0; i < numPackets; i++) {
+		std::unique_ptr<NetworkPacket> packet = NetworkPacket::Allocate();
+		*packet << (uint32)NETWORK_COMMAND_GAMECMD;
+		packet->Write(payload.data(), (unsigned int)payload.size());
+		SendPacketToClients(std::move(packet));
+	}
+	uint64 queuedTime = SDL_GetPerformanceCounter();
+
+	bool received = true;
+	size_t expectedSize = (size_t)numPackets * (sizeof(uint16) + packetSize);
+	std::vector<char> buffer(NETWORK_MAX_PACKET_FRAME_SIZE);
+	for (SOCKET clientSocket : clientSockets) {
+		size_t remaining = expectedSize;
+		while (remaining > 0) {
+			int readBytes = recv(clientSocket, buffer.data(), (int)(std::min)(buffer.size(), remaining), 0);
+			if (readBytes <= 0) {
+				log_error("Client stopped receiving after %u of %u bytes.", (uint32)(expectedSize - remaining), (uint32)expectedSize);
+				received = false;
+				break;
+			}
+			remaining -= readBytes;
+		}
+		if (!received) {
+			break;
+		}
+	}
+	uint64 endTime = SDL_GetPerformanceCounter();
+
+	closeAll();
+	*queueMs = (double)(queuedTime - startTime) * 1000 / SDL_GetPerformanceFrequency();
+	*deliveryMs = (double)(endTime - startTime) * 1000 / SDL_GetPerformanceFrequency();
+	return received;
+}
+
 bool Network::CheckSRAND(uint32 tick, uint32 srand0)
 {
 	if (server_srand0_tick == 0)
@@ -1031,6 +1435,66 @@ bool Network::CheckSRAND(uint32 tick, uint32 srand0)
 	return true;
 }
 
+bool Network::CheckStateHash(uint32 tick)
+{
+	if (!server_state_hash_pending)
+		return true;
+
+	if (tick > server_state_hash.tick) {
+		server_state_hash_pending = false;
+		return true;
+	}
+
+	if (tick == server_state_hash.tick) {
+		server_state_hash_pending = false;
+
+		rct_state_hash localHash;
+		state_hash_compute(&localHash);
+
+		int category, bucket;
+		if (state_hash_find_divergence(&localHash, &server_state_hash, &category, &bucket)) {
+			// Narrow the bucket down to the first entity that differs
+			int first, last;
+			state_hash_get_bucket_range(category, bucket, &first, &last);
+			log_warning("Game state diverged at tick %u in %s bucket %d (%d - %d)", tick, state_hash_category_name(category), bucket, first, last);
+
+			// Keep a full dump so it can be compared against a dump from the server with 'openrct2 state diff'
+			rct_state_dump dump;
+			if (state_hash_dump_create(&dump)) {
+				utf8 path[MAX_PATH];
+				char fileName[32];
+				snprintf(fileName, sizeof(fileName), "desync_%u.dat", tick);
+				platform_get_user_directory(path, NULL);
+				strcat(path, fileName);
+				if (state_hash_dump_save(&dump, path)) {
+					log_warning("Local game state dump written to '%s'", path);
+				}
+				state_hash_dump_dispose(&dump);
+			}
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Periodically hashes the game state for the clients to check against. Must be called once all the
+ * game commands for the current tick have run, i.e. just before the tick counter is advanced, which
+ * is also where clients check it.
+ */
+void Network::UpdateStateHash()
+{
+	if (GetMode() != NETWORK_MODE_SERVER)
+		return;
+
+	uint32 tick = RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32);
+	if (tick - last_state_hash_tick >= NETWORK_STATE_HASH_INTERVAL) {
+		last_state_hash_tick = tick;
+		state_hash_compute(&state_hash);
+		state_hash_pending = true;
+	}
+}
+
 void Network::KickPlayer(int playerId)
 {
 	NetworkPlayer *player = GetPlayerByID(playerId);
@@ -1041,8 +1505,7 @@ void Network::KickPlayer(int playerId)
 			char str_disconnect_msg[256];
 			format_string(str_disconnect_msg, STR_MULTIPLAYER_KICKED_REASON, NULL);
 			Server_Send_SETDISCONNECTMSG(*(*it), str_disconnect_msg);
-			shutdown((*it)->socket, SHUT_RD);
-			(*it)->SendQueuedPackets();
+			(*it)->ShutdownAfterSending();
 			break;
 		}
 	}
@@ -1333,8 +1796,7 @@ void Network::Server_Send_AUTH(NetworkConnection& connection)
 	}
 	connection.QueuePacket(std::move(packet));
 	if (connection.authstatus != NETWORK_AUTH_OK && connection.authstatus != NETWORK_AUTH_REQUIREPASSWORD) {
-		shutdown(connection.socket, SHUT_RD);
-		connection.SendQueuedPackets();
+		connection.ShutdownAfterSending();
 	}
 }
 
@@ -1385,7 +1847,7 @@ void Network::Server_Send_MAP(NetworkConnection* connection)
 		if (connection) {
 			connection->QueuePacket(std::move(packet));
 		} else {
-			SendPacketToClients(*packet);
+			SendPacketToClients(std::move(packet));
 		}
 	}
 	free(header);
@@ -1405,13 +1867,16 @@ void Network::Server_Send_CHAT(const char* text)
 	std::unique_ptr<NetworkPacket> packet = std::move(NetworkPacket::Allocate());
 	*packet << (uint32)NETWORK_COMMAND_CHAT;
 	packet->WriteString(text);
-	SendPacketToClients(*packet);
+	SendPacketToClients(std::move(packet));
 }
 
 void Network::Client_Send_GAMECMD(uint32 eax, uint32 ebx, uint32 ecx, uint32 edx, uint32 esi, uint32 edi, uint32 ebp, uint8 callback)
 {
 	std::unique_ptr<NetworkPacket> packet = std::move(NetworkPacket::Allocate());
 	*packet << (uint32)NETWORK_COMMAND_GAMECMD << (uint32)RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32) << eax << (ebx | GAME_COMMAND_FLAG_NETWORKED) << ecx << edx << esi << edi << ebp << callback;
+	if (esi == GAME_COMMAND_BATCH) {
+		WriteGameCommandBatch(*packet);
+	}
 	server_connection.QueuePacket(std::move(packet));
 }
 
@@ -1419,7 +1884,35 @@ void Network::Server_Send_GAMECMD(uint32 eax, uint32 ebx, uint32 ecx, uint32 edx
 {
 	std::unique_ptr<NetworkPacket> packet = std::move(NetworkPacket::Allocate());
 	*packet << (uint32)NETWORK_COMMAND_GAMECMD << (uint32)RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32) << eax << (ebx | GAME_COMMAND_FLAG_NETWORKED) << ecx << edx << esi << edi << ebp << playerid << callback;
-	SendPacketToClients(*packet);
+	if (esi == GAME_COMMAND_BATCH) {
+		WriteGameCommandBatch(*packet);
+	}
+	SendPacketToClients(std::move(packet));
+}
+
+// Sub-commands of a GAME_COMMAND_BATCH follow the registers of the command itself
+void Network::WriteGameCommandBatch(NetworkPacket& packet)
+{
+	packet << gGameCommandBatch.count;
+	for (int i = 0; i < gGameCommandBatch.count; i++) {
+		const rct_game_command_batch_entry& entry = gGameCommandBatch.entries[i];
+		packet << entry.command << entry.eax << entry.ebx << entry.ecx << entry.edx << entry.edi << entry.ebp;
+	}
+}
+
+bool Network::ReadGameCommandBatch(NetworkPacket& packet, std::vector<rct_game_command_batch_entry>& batch)
+{
+	uint16 count;
+	packet >> count;
+	if (count == 0 || count > GAME_COMMAND_BATCH_MAX_SIZE) {
+		return false;
+	}
+
+	batch.resize(count);
+	for (auto it = batch.begin(); it != batch.end(); it++) {
+		packet >> it->command >> it->eax >> it->ebx >> it->ecx >> it->edx >> it->edi >> it->ebp;
+	}
+	return true;
 }
 
 void Network::Server_Send_TICK()
@@ -1427,7 +1920,20 @@ void Network::Server_Send_TICK()
 	last_tick_sent_time = SDL_GetTicks();
 	std::unique_ptr<NetworkPacket> packet = std::move(NetworkPacket::Allocate());
 	*packet << (uint32)NETWORK_COMMAND_TICK << (uint32)RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32) << (uint32)RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_SRAND_0, uint32);
-	SendPacketToClients(*packet);
+
+	// Include the last state hash taken so clients can tell what diverged
+	if (state_hash_pending) {
+		state_hash_pending = false;
+		*packet << (uint8)1 << state_hash.tick;
+		for (int category = 0; category < STATE_HASH_CATEGORY_COUNT; category++) {
+			for (int bucket = 0; bucket < STATE_HASH_BUCKET_COUNT; bucket++) {
+				*packet << state_hash.buckets[category][bucket];
+			}
+		}
+	} else {
+		*packet << (uint8)0;
+	}
+	SendPacketToClients(std::move(packet));
 }
 
 void Network::Server_Send_PLAYERLIST()
@@ -1437,7 +1943,7 @@ void Network::Server_Send_PLAYERLIST()
 	for (unsigned int i = 0; i < player_list.size(); i++) {
 		player_list[i]->Write(*packet);
 	}
-	SendPacketToClients(*packet);
+	SendPacketToClients(std::move(packet));
 }
 
 void Network::Client_Send_PING()
@@ -1455,7 +1961,7 @@ void Network::Server_Send_PING()
 	for (auto it = client_connection_list.begin(); it != client_connection_list.end(); it++) {
 		(*it)->ping_time = SDL_GetTicks();
 	}
-	SendPacketToClients(*packet, true);
+	SendPacketToClients(std::move(packet), true);
 }
 
 void Network::Server_Send_PINGLIST()
@@ -1465,7 +1971,7 @@ void Network::Server_Send_PINGLIST()
 	for (unsigned int i = 0; i < player_list.size(); i++) {
 		*packet << player_list[i]->id << player_list[i]->ping;
 	}
-	SendPacketToClients(*packet);
+	SendPacketToClients(std::move(packet));
 }
 
 void Network::Server_Send_SETDISCONNECTMSG(NetworkConnection& connection, const char* msg)
@@ -1526,7 +2032,7 @@ void Network::Server_Send_EVENT_PLAYER_JOINED(const char *playerName)
 	*packet << (uint32)NETWORK_COMMAND_EVENT;
 	*packet << (uint16)SERVER_EVENT_PLAYER_JOINED;
 	packet->WriteString(playerName);
-	SendPacketToClients(*packet);
+	SendPacketToClients(std::move(packet));
 }
 
 void Network::Server_Send_EVENT_PLAYER_DISCONNECTED(const char *playerName, const char *reason)
@@ -1536,7 +2042,7 @@ void Network::Server_Send_EVENT_PLAYER_DISCONNECTED(const char *playerName, cons
 	*packet << (uint16)SERVER_EVENT_PLAYER_DISCONNECTED;
 	packet->WriteString(playerName);
 	packet->WriteString(reason);
-	SendPacketToClients(*packet);
+	SendPacketToClients(std::move(packet));
 }
 
 bool Network::ProcessConnection(NetworkConnection& connection)
@@ -1607,7 +2113,12 @@ void Network::ProcessGameCommandQueue()
 		}
 		game_command_playerid = gc.playerid;
 		int command = gc.esi;
-		money32 cost = game_do_command_p(command, (int*)&gc.eax, (int*)&gc.ebx, (int*)&gc.ecx, (int*)&gc.edx, (int*)&gc.esi, (int*)&gc.edi, (int*)&gc.ebp);
+		if (command == GAME_COMMAND_BATCH) {
+			gGameCommandBatch.count = (uint16)gc.batch.size();
+			std::copy(gc.batch.begin(), gc.batch.end(), gGameCommandBatch.entries);
+			command = gc.batch.front().command;
+		}
+		money32 cost = game_do_command_p(gc.esi, (int*)&gc.eax, (int*)&gc.ebx, (int*)&gc.ecx, (int*)&gc.edx, (int*)&gc.esi, (int*)&gc.edi, (int*)&gc.ebp);
 		if (cost != MONEY32_UNDEFINED) {
 			NetworkPlayer* player = GetPlayerByID(gc.playerid);
 			if (player) {
@@ -1625,7 +2136,13 @@ void Network::AddClient(SOCKET socket)
 	auto connection = std::unique_ptr<NetworkConnection>(new NetworkConnection);  // change to make_unique in c++14
 	connection->socket = socket;
 	connection->SetTCPNoDelay(true);
+	connection->SetThreaded(io_thread != nullptr ? &io_wakeup : nullptr);
+	SDL_LockMutex(connection_list_mutex);
 	client_connection_list.push_back(std::move(connection));
+	SDL_UnlockMutex(connection_list_mutex);
+	if (io_thread != nullptr) {
+		io_wakeup.Signal();
+	}
 }
 
 void Network::RemoveClient(std::unique_ptr<NetworkConnection>& connection)
@@ -1647,10 +2164,89 @@ void Network::RemoveClient(std::unique_ptr<NetworkConnection>& connection)
 		gNetwork.Server_Send_EVENT_PLAYER_DISCONNECTED((char*)connection_player->name, connection->getLastDisconnectReason());
 	}
 	player_list.erase(std::remove_if(player_list.begin(), player_list.end(), [connection_player](std::unique_ptr<NetworkPlayer>& player){ return player.get() == connection_player; }), player_list.end());
+	SDL_LockMutex(connection_list_mutex);
 	client_connection_list.remove(connection);
+	SDL_UnlockMutex(connection_list_mutex);
 	Server_Send_PLAYERLIST();
 }
 
+/**
+ * Starts the thread that does the socket I/O of every client connection so that sending and
+ * receiving is not limited to once per game frame and large map transfers do not stall the game.
+ * Accepting clients and handling packets still happens on the game thread.
+ */
+void Network::StartIoThread()
+{
+	connection_list_mutex = SDL_CreateMutex();
+	if (connection_list_mutex == nullptr) {
+		log_error("Unable to create network mutex, using game thread for socket I/O.");
+		return;
+	}
+	if (!io_wakeup.Open()) {
+		log_error("Unable to create network wakeup socket, using game thread for socket I/O.");
+		return;
+	}
+	io_thread_running = true;
+	io_thread = SDL_CreateThread(IoThreadFunc, "network", this);
+	if (io_thread == nullptr) {
+		log_error("Unable to create network thread, using game thread for socket I/O.");
+		io_thread_running = false;
+		io_wakeup.Close();
+	}
+}
+
+void Network::StopIoThread()
+{
+	if (io_thread != nullptr) {
+		io_thread_running = false;
+		io_wakeup.Signal();
+		SDL_WaitThread(io_thread, nullptr);
+		io_thread = nullptr;
+	}
+	io_wakeup.Close();
+	if (connection_list_mutex != nullptr) {
+		SDL_DestroyMutex(connection_list_mutex);
+		connection_list_mutex = nullptr;
+	}
+}
+
+int Network::IoThreadFunc(void* pointer)
+{
+	Network* network = (Network*)pointer;
+	// poll rather than select as select can't take sockets numbered FD_SETSIZE or above
+	std::vector<NetworkPollSocket> pollSockets;
+	while (network->io_thread_running) {
+		network->io_wakeup.Reset();
+		pollSockets.clear();
+
+		NetworkPollSocket wakeupSocket = { 0 };
+		wakeupSocket.fd = network->io_wakeup.GetSocket();
+		wakeupSocket.events = POLLIN;
+		pollSockets.push_back(wakeupSocket);
+
+		SDL_LockMutex(network->connection_list_mutex);
+		for (auto it = network->client_connection_list.begin(); it != network->client_connection_list.end(); it++) {
+			NetworkConnection* connection = it->get();
+			connection->UpdateIo();
+			if (!connection->IsIoDisconnected()) {
+				NetworkPollSocket pollSocket = { 0 };
+				pollSocket.fd = connection->socket;
+				pollSocket.events = POLLIN;
+				if (connection->HasOutboundPackets()) {
+					pollSocket.events |= POLLOUT;
+				}
+				pollSockets.push_back(pollSocket);
+			}
+		}
+		SDL_UnlockMutex(network->connection_list_mutex);
+
+		// Sleep until a client sends something, a socket that was full can take more, or the game thread signals
+		// that it queued packets, added a client or is stopping the thread
+		PollSockets(pollSockets.data(), pollSockets.size(), -1);
+	}
+	return 0;
+}
+
 NetworkPlayer* Network::AddPlayer()
 {
 	NetworkPlayer* addedplayer = nullptr;
@@ -1803,6 +2399,7 @@ void Network::Client_Handle_MAP(NetworkConnection& connection, NetworkPacket& pa
 			game_command_queue.clear();
 			server_tick = RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32);
 			server_srand0_tick = 0;
+			server_state_hash_pending = false;
 			// window_network_status_open("Loaded new map from network");
 			_desynchronised = false;
 
@@ -1855,6 +2452,10 @@ void Network::Client_Handle_GAMECMD(NetworkConnection& connection, NetworkPacket
 	packet >> tick >> args[0] >> args[1] >> args[2] >> args[3] >> args[4] >> args[5] >> args[6] >> playerid >> callback;
 
 	GameCommand gc = GameCommand(tick, args, playerid, callback);
+	if (gc.esi == GAME_COMMAND_BATCH && !ReadGameCommandBatch(packet, gc.batch)) {
+		log_warning("Received an invalid game command batch.");
+		return;
+	}
 	game_command_queue.insert(gc);
 }
 
@@ -1879,7 +2480,34 @@ void Network::Server_Handle_GAMECMD(NetworkConnection& connection, NetworkPacket
 	
 	// Check if player's group permission allows command to run
 	NetworkGroup* group = GetGroupByID(connection.player->group);
-	if (!group || (group && !group->CanPerformCommand(commandCommand))) {
+	if (commandCommand == GAME_COMMAND_BATCH) {
+		std::vector<rct_game_command_batch_entry> batch;
+		if (!ReadGameCommandBatch(packet, batch)) {
+			return;
+		}
+		// Every command in a batch needs the same permission as when sent on its own and several
+		// scenery placements in one batch is a cluster
+		int numSceneryPlacements = 0;
+		for (auto it = batch.begin(); it != batch.end(); it++) {
+			if (!group || !group->CanPerformCommand(it->command) ||
+				it->command == GAME_COMMAND_TOGGLE_PAUSE ||
+				it->command == GAME_COMMAND_LOAD_OR_QUIT
+			) {
+				Server_Send_SHOWERROR(connection, STR_CANT_DO_THIS, STR_PERMISSION_DENIED);
+				return;
+			}
+			if (it->command == GAME_COMMAND_PLACE_SCENERY) {
+				numSceneryPlacements++;
+			}
+		}
+		if (numSceneryPlacements > 1 && !group->CanPerformCommand(-2)) {
+			Server_Send_SHOWERROR(connection, STR_CANT_DO_THIS, STR_CANT_DO_THIS);
+			return;
+		}
+		gGameCommandBatch.count = (uint16)batch.size();
+		std::copy(batch.begin(), batch.end(), gGameCommandBatch.entries);
+		commandCommand = batch.front().command;
+	} else if (!group || (group && !group->CanPerformCommand(commandCommand))) {
 		Server_Send_SHOWERROR(connection, STR_CANT_DO_THIS, STR_PERMISSION_DENIED);
 		return;
 	}
@@ -1918,11 +2546,21 @@ void Network::Server_Handle_GAMECMD(NetworkConnection& connection, NetworkPacket
 void Network::Client_Handle_TICK(NetworkConnection& connection, NetworkPacket& packet)
 {
 	uint32 srand0;
-	packet >> server_tick >> srand0;
+	uint8 hasStateHash;
+	packet >> server_tick >> srand0 >> hasStateHash;
 	if (server_srand0_tick == 0) {
 		server_srand0 = srand0;
 		server_srand0_tick = server_tick;
 	}
+	if (hasStateHash && !server_state_hash_pending) {
+		packet >> server_state_hash.tick;
+		for (int category = 0; category < STATE_HASH_CATEGORY_COUNT; category++) {
+			for (int bucket = 0; bucket < STATE_HASH_BUCKET_COUNT; bucket++) {
+				packet >> server_state_hash.buckets[category][bucket];
+			}
+		}
+		server_state_hash_pending = true;
+	}
 }
 
 void Network::Client_Handle_PLAYERLIST(NetworkConnection& connection, NetworkPacket& packet)
@@ -2078,11 +2716,21 @@ int network_begin_server(int port)
 	return gNetwork.BeginServer(port);
 }
 
+bool network_benchmark_broadcast(int numClients, int numPackets, int packetSize, double *queueMs, double *deliveryMs)
+{
+	return gNetwork.BenchmarkBroadcast(numClients, numPackets, packetSize, queueMs, deliveryMs);
+}
+
 void network_update()
 {
 	gNetwork.Update();
 }
 
+void network_update_state_hash()
+{
+	gNetwork.UpdateStateHash();
+}
+
 int network_get_mode()
 {
 	return gNetwork.GetMode();
@@ -2489,8 +3137,10 @@ uint32 network_get_server_tick() { return RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS
 void network_send_gamecmd(uint32 eax, uint32 ebx, uint32 ecx, uint32 edx, uint32 esi, uint32 edi, uint32 ebp, uint8 callback) {}
 void network_send_map() {}
 void network_update() {}
+void network_update_state_hash() {}
 int network_begin_client(const char *host, int port) { return 1; }
 int network_begin_server(int port) { return 1; }
+bool network_benchmark_broadcast(int numClients, int numPackets, int packetSize, double *queueMs, double *deliveryMs) { return false; }
 int network_get_num_players() { return 1; }
 const char* network_get_player_name(unsigned int index) { return "local (OpenRCT2 compiled without MP)"; }
 uint32 network_get_player_flags(unsigned int index) { return 0; }
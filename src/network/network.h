@@ -59,6 +59,7 @@ extern "C" {
 #include "../game.h"
 #include "../platform/platform.h"
 #include "../localisation/string_ids.h"
+#include "../state_hash.h"
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -68,11 +69,21 @@ extern "C" {
 // This define specifies which version of network stream current build uses.
 // It is used for making sure only compatible builds get connected, even within
 // single OpenRCT2 version.
-#define NETWORK_STREAM_VERSION "6"
+#define NETWORK_STREAM_VERSION "10"
 #define NETWORK_STREAM_ID OPENRCT2_VERSION "-" NETWORK_STREAM_VERSION
 
 #define NETWORK_DISCONNECT_REASON_BUFFER_SIZE 256
 
+// Number of game ticks between game state hashes sent with NETWORK_COMMAND_TICK
+#define NETWORK_STATE_HASH_INTERVAL 40
+
+// Largest packet including its size prefix
+#define NETWORK_MAX_PACKET_FRAME_SIZE (sizeof(uint16) + UINT16_MAX)
+// Big enough that a partially received packet can always be completed after compacting the buffer
+#define NETWORK_INBOUND_BUFFER_SIZE (2 * NETWORK_MAX_PACKET_FRAME_SIZE)
+// Number of queued packets handed to the socket in a single call
+#define NETWORK_MAX_PACKETS_PER_SEND 64
+
 #ifdef __WINDOWS__
 	#include <winsock2.h>
 	#include <ws2tcpip.h>
@@ -85,14 +96,20 @@ extern "C" {
 	#ifndef SHUT_RDWR
 		#define SHUT_RDWR SD_BOTH
 	#endif
+	typedef WSABUF NetworkIoBuffer;
+	typedef WSAPOLLFD NetworkPollSocket;
 #else
 	#include <errno.h>
 	#include <arpa/inet.h>
 	#include <netdb.h>
 	#include <netinet/tcp.h>
+	#include <poll.h>
 	#include <sys/socket.h>
+	#include <sys/uio.h>
 	#include <fcntl.h>
 	typedef int SOCKET;
+	typedef struct iovec NetworkIoBuffer;
+	typedef struct pollfd NetworkPollSocket;
 	#define SOCKET_ERROR -1
 	#define INVALID_SOCKET -1
 	#define LAST_SOCKET_ERROR() errno
@@ -100,6 +117,12 @@ extern "C" {
 	#define ioctlsocket ioctl
 #endif // __WINDOWS__
 
+#ifdef __cplusplus
+// Included before the packing below so the atomics in the queue keep their natural alignment
+#include <atomic>
+#include "../core/SpscQueue.hpp"
+#endif
+
 // Fixes issues on OS X
 #if defined(_RCT2_H_) && !defined(_MSC_VER)
 // use similar struct packing as MSVC for our structs
@@ -109,6 +132,7 @@ extern "C" {
 #ifdef __cplusplus
 
 #include <array>
+#include <deque>
 #include <list>
 #include <set>
 #include <memory>
@@ -132,7 +156,6 @@ class NetworkPacket
 public:
 	NetworkPacket();
 	static std::unique_ptr<NetworkPacket> Allocate();
-	static std::unique_ptr<NetworkPacket> Duplicate(NetworkPacket& packet);
 	uint8* GetData();
 	uint32 GetCommand();
 	template <typename T>
@@ -145,8 +168,10 @@ public:
 	const char* ReadString();
 	void Clear();
 	bool CommandRequiresAuth();
+	void EncodeSize();
 
 	uint16 size;
+	uint16 size_prefix; // size in network byte order, sent in front of the data
 	std::shared_ptr<std::vector<uint8>> data;
 	unsigned int transferred;
 	int read;
@@ -229,14 +254,40 @@ private:
 	rct_string_id name_string_id;
 };
 
+/**
+ * Wakes the network thread from PollSockets when the game thread has handed it something to do. It is a UDP socket
+ * connected to itself, as WSAPoll only accepts sockets.
+ */
+class NetworkIoWakeup
+{
+public:
+	NetworkIoWakeup();
+	bool Open();
+	void Close();
+	void Signal();
+	void Reset();
+	SOCKET GetSocket() const;
+
+private:
+	SOCKET socket = INVALID_SOCKET;
+	// Set from the first signal until the network thread wakes, so later ones don't write to the socket again
+	std::atomic<bool> signalled;
+};
+
 class NetworkConnection
 {
 public:
 	NetworkConnection();
 	~NetworkConnection();
 	int ReadPacket();
-	void QueuePacket(std::unique_ptr<NetworkPacket> packet, bool front = false);
+	void QueuePacket(std::shared_ptr<NetworkPacket> packet, bool front = false);
+	void QueueEncodedPacket(std::shared_ptr<NetworkPacket> packet, bool front = false);
 	void SendQueuedPackets();
+	void ShutdownAfterSending();
+	void SetThreaded(NetworkIoWakeup* wakeup);
+	void UpdateIo();
+	bool IsIoDisconnected();
+	bool HasOutboundPackets();
 	bool SetTCPNoDelay(bool on);
 	bool SetNonBlocking(bool on);
 	static bool SetNonBlocking(SOCKET socket, bool on);
@@ -255,8 +306,43 @@ public:
 
 private:
 	char* last_disconnect_reason;
-	bool SendPacket(NetworkPacket& packet);
-	std::list<std::unique_ptr<NetworkPacket>> outboundpackets;
+	struct OutboundPacket
+	{
+		// Broadcast packets are shared between the queues of all clients
+		std::shared_ptr<NetworkPacket> packet;
+		// Number of bytes of the size prefix and data sent so far
+		unsigned int transferred;
+	};
+
+	struct QueuedPacket
+	{
+		std::shared_ptr<NetworkPacket> packet;
+		bool front;
+	};
+
+	int ReadNextPacket();
+	int ReceivePacket(NetworkPacket& packet);
+	int ReadBufferedPacket(NetworkPacket& packet);
+	void AddOutboundPacket(std::shared_ptr<NetworkPacket> packet, bool front);
+	void SendOutboundPackets();
+	void ShutdownIfSent();
+
+	// When threaded, all socket I/O is done by the network thread. Received packets are handed to the
+	// game thread and packets to send are handed back through these queues, signalling io_wakeup.
+	bool threaded = false;
+	NetworkIoWakeup* io_wakeup = nullptr;
+	SpscQueue<std::shared_ptr<NetworkPacket>> inbound_handoff;
+	SpscQueue<QueuedPacket> outbound_handoff;
+	std::atomic<bool> io_disconnected;
+
+	// Set once the connection is being closed, its socket is shut down when everything queued before that is sent
+	bool closing = false;
+	std::atomic<bool> shutdown_pending;
+
+	std::deque<OutboundPacket> outboundpackets;
+	std::vector<uint8> inbound_buffer;
+	size_t inbound_start = 0;
+	size_t inbound_end = 0;
 	uint32 last_packet_time;
 };
 
@@ -307,8 +393,11 @@ public:
 	std::vector<std::unique_ptr<NetworkGroup>>::iterator GetGroupIteratorByID(uint8 id);
 	NetworkGroup* GetGroupByID(uint8 id);
 	static const char* FormatChat(NetworkPlayer* fromplayer, const char* text);
-	void SendPacketToClients(NetworkPacket& packet, bool front = false);
+	void SendPacketToClients(std::unique_ptr<NetworkPacket> packet, bool front = false);
+	bool BenchmarkBroadcast(int numClients, int numPackets, int packetSize, double* queueMs, double* deliveryMs);
 	bool CheckSRAND(uint32 tick, uint32 srand0);
+	bool CheckStateHash(uint32 tick);
+	void UpdateStateHash();
 	void KickPlayer(int playerId);
 	void SetPassword(const char* password);
 	void ShutdownClient();
@@ -329,6 +418,8 @@ public:
 	void Server_Send_CHAT(const char* text);
 	void Client_Send_GAMECMD(uint32 eax, uint32 ebx, uint32 ecx, uint32 edx, uint32 esi, uint32 edi, uint32 ebp, uint8 callback);
 	void Server_Send_GAMECMD(uint32 eax, uint32 ebx, uint32 ecx, uint32 edx, uint32 esi, uint32 edi, uint32 ebp, uint8 playerid, uint8 callback);
+	static void WriteGameCommandBatch(NetworkPacket& packet);
+	static bool ReadGameCommandBatch(NetworkPacket& packet, std::vector<rct_game_command_batch_entry>& batch);
 	void Server_Send_TICK();
 	void Server_Send_PLAYERLIST();
 	void Client_Send_PING();
@@ -350,6 +441,9 @@ private:
 	void ProcessGameCommandQueue();
 	void AddClient(SOCKET socket);
 	void RemoveClient(std::unique_ptr<NetworkConnection>& connection);
+	void StartIoThread();
+	void StopIoThread();
+	static int IoThreadFunc(void* pointer);
 	NetworkPlayer* AddPlayer();
 	void PrintError();
 	const char* GetMasterServerUrl();
@@ -362,6 +456,7 @@ private:
 		uint32 eax, ebx, ecx, edx, esi, edi, ebp;
 		uint8 playerid;
 		uint8 callback;
+		std::vector<rct_game_command_batch_entry> batch;
 		bool operator<(const GameCommand& comp) const {
 			return tick < comp.tick;
 		}
@@ -379,6 +474,11 @@ private:
 	uint32 server_tick = 0;
 	uint32 server_srand0 = 0;
 	uint32 server_srand0_tick = 0;
+	rct_state_hash server_state_hash;
+	bool server_state_hash_pending = false;
+	rct_state_hash state_hash;
+	bool state_hash_pending = false;
+	uint32 last_state_hash_tick = 0;
 	uint8 player_id = 0;
 	std::list<std::unique_ptr<NetworkConnection>> client_connection_list;
 	std::multiset<GameCommand> game_command_queue;
@@ -392,6 +492,10 @@ private:
 	int advertise_status = 0;
 	uint32 last_heartbeat_time = 0;
 	uint8 default_group = 0;
+	SDL_Thread* io_thread = nullptr;
+	SDL_mutex* connection_list_mutex = nullptr;
+	std::atomic<bool> io_thread_running;
+	NetworkIoWakeup io_wakeup;
 
 	void UpdateServer();
 	void UpdateClient();
@@ -431,10 +535,12 @@ void network_close();
 void network_shutdown_client();
 int network_begin_client(const char *host, int port);
 int network_begin_server(int port);
+bool network_benchmark_broadcast(int numClients, int numPackets, int packetSize, double *queueMs, double *deliveryMs);
 
 int network_get_mode();
 int network_get_status();
 void network_update();
+void network_update_state_hash();
 int network_get_authstatus();
 uint32 network_get_server_tick();
 uint8 network_get_current_player_id();
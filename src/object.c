@@ -54,7 +54,6 @@ int object_load_entry(const utf8 *path, rct_object_entry *outEntry)
 
 int object_load_file(int groupIndex, const rct_object_entry *entry, int* chunkSize, const rct_object_entry *installedObject)
 {
-	uint8 objectType;
 	rct_object_entry openedEntry;
 	char path[MAX_PATH];
 	SDL_RWops* rw;
@@ -94,11 +93,21 @@ int object_load_file(int groupIndex, const rct_object_entry *entry, int* chunkSi
 	SDL_RWclose(rw);
 
 	int calculatedChecksum = object_calculate_checksum(&openedEntry, chunk, *chunkSize);
+	return object_load_decoded_chunk(groupIndex, &openedEntry, chunk, *chunkSize, calculatedChecksum);
+}
+
+/**
+ * Loads an object from its already decoded chunk, taking ownership of the chunk. The checksum is passed in so it can be
+ * calculated away from the main thread.
+ */
+int object_load_decoded_chunk(int groupIndex, const rct_object_entry *openedEntry, uint8 *chunk, int chunkSize, int calculatedChecksum)
+{
+	uint8 objectType;
 
-	// Calculate and check checksum
-	if (calculatedChecksum != openedEntry.checksum && !gConfigGeneral.allow_loading_with_incorrect_checksum) {
+	// Check checksum
+	if (calculatedChecksum != openedEntry->checksum && !gConfigGeneral.allow_loading_with_incorrect_checksum) {
 		char buffer[100];
-		sprintf(buffer, "Object Load failed due to checksum failure: calculated checksum %d, object says %d.", calculatedChecksum, (int)openedEntry.checksum);
+		sprintf(buffer, "Object Load failed due to checksum failure: calculated checksum %d, object says %d.", calculatedChecksum, (int)openedEntry->checksum);
 		log_error(buffer);
 		RCT2_GLOBAL(0x00F42BD9, uint8) = 2;
 		free(chunk);
@@ -106,7 +115,7 @@ int object_load_file(int groupIndex, const rct_object_entry *entry, int* chunkSi
 			
 	}
 
-	objectType = openedEntry.flags & 0x0F;
+	objectType = openedEntry->flags & 0x0F;
 
 	if (!object_test(objectType, chunk)) {
 		log_error("Object Load failed due to paint failure.");
@@ -137,8 +146,8 @@ int object_load_file(int groupIndex, const rct_object_entry *entry, int* chunkSi
 
 	rct_object_entry_extended* extended_entry = &object_entry_groups[objectType].entries[groupIndex];
 
-	memcpy(extended_entry, &openedEntry, sizeof(rct_object_entry));
-	extended_entry->chunk_size = *chunkSize;
+	memcpy(extended_entry, openedEntry, sizeof(rct_object_entry));
+	extended_entry->chunk_size = chunkSize;
 
 	gLastLoadedObjectChunkData = chunk;
 
@@ -438,7 +447,29 @@ int object_calculate_checksum(const rct_object_entry *entry, const uint8 *data,
 		checksum ^= entryBytePtr[i];
 		checksum = rol32(checksum, 11);
 	}
-	for (int i = 0; i < dataLength; i++) {
+
+	// XOR and rotate are both linear and 32 rotations by 11 bits return to the start, so each byte only affects the
+	// result through its position modulo 32. All whole 32 byte blocks can therefore be XORed together a word at a
+	// time and the folded block checksummed once, giving the same result as checksumming every byte.
+	int foldedLength = dataLength & ~31;
+	if (foldedLength != 0) {
+		uint32 folded[8] = { 0 };
+		for (int i = 0; i < foldedLength; i += 32) {
+			uint32 block[8];
+			memcpy(block, data + i, sizeof(block));
+			for (int j = 0; j < 8; j++) {
+				folded[j] ^= block[j];
+			}
+		}
+
+		const uint8 *foldedBytes = (uint8*)folded;
+		for (int i = 0; i < 32; i++) {
+			checksum ^= foldedBytes[i];
+			checksum = rol32(checksum, 11);
+		}
+	}
+
+	for (int i = foldedLength; i < dataLength; i++) {
 		checksum ^= data[i];
 		checksum = rol32(checksum, 11);
 	}
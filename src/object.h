@@ -114,6 +114,7 @@ void object_unload_all();
 
 int check_object_entry(rct_object_entry *entry);
 int object_load_file(int groupIndex, const rct_object_entry *entry, int* chunkSize, const rct_object_entry *installedObject);
+int object_load_decoded_chunk(int groupIndex, const rct_object_entry *openedEntry, uint8 *chunk, int chunkSize, int calculatedChecksum);
 int object_load_chunk(int groupIndex, rct_object_entry *entry, int* chunk_size);
 void object_unload_chunk(rct_object_entry *entry);
 int object_get_scenario_text(rct_object_entry *entry);
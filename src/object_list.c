@@ -25,6 +25,7 @@
 #include "platform/platform.h"
 #include "ride/track.h"
 #include "util/sawyercoding.h"
+#include "util/util.h"
 #include "game.h"
 #include "rct1.h"
 #include "world/entrance.h"
@@ -32,7 +33,8 @@
 #include "world/scenery.h"
 #include "world/water.h"
 
-#define FILTER_VERSION 1
+// Version 2 added a file record for each installed object
+#define FILTER_VERSION 2
 
 typedef struct {
 	uint32 total_files;
@@ -42,6 +44,47 @@ typedef struct {
 	uint32 object_list_no_items;
 } rct_plugin_header;
 
+/**
+ * The size and modified time of the file an installed object was read from, so the object only needs to be read again
+ * when its file changes.
+ */
+typedef struct {
+	uint64 size;
+	uint64 last_modified;
+} rct_object_file_record;
+
+/**
+ * The installed object list from a previous run, used to skip reading files that have not changed.
+ */
+typedef struct {
+	rct_object_entry *entries;
+	rct_object_filters *filters;
+	rct_object_file_record *records;
+	uint32 count;
+	rct_object_entry **entry_list;
+	uint32 *hash_table;
+	uint32 hash_table_size;
+} object_list_index;
+
+/**
+ * An object file that needs to be read. Files are read, decoded and checksummed on worker threads, the chunk is then
+ * installed on the main thread as installing it touches game state.
+ */
+typedef struct {
+	utf8 name[MAX_PATH];
+	utf8 path[MAX_PATH];
+	rct_object_file_record record;
+	rct_object_entry entry;
+	uint8 *chunk;
+	int chunk_size;
+	int checksum;
+	bool read;
+} object_scan_file;
+
+// Number of files read ahead of being installed, limits how many decoded chunks are held at once
+#define OBJECT_SCAN_BATCH_SIZE 256
+#define OBJECT_SCAN_MAX_THREADS 16
+
 // 98DA00
 int object_entry_group_counts[] = {
 	128,	// rides
@@ -89,14 +132,15 @@ rct_object_entry_group object_entry_groups[] = {
 
 void **gObjectList = RCT2_ADDRESS(RCT2_ADDRESS_RIDE_ENTRIES, void*);
 
-static int object_list_cache_load(int totalFiles, uint64 totalFileSize, int fileDateModifiedChecksum);
+static int object_list_cache_load(int totalFiles, uint64 totalFileSize, int fileDateModifiedChecksum, object_list_index *outPreviousIndex);
 static int object_list_cache_save(int fileCount, uint64 totalFileSize, int fileDateModifiedChecksum, int currentItemOffset);
 
 void object_list_create_hash_table();
-static uint32 install_object_entry(rct_object_entry* entry, rct_object_entry* installed_entry, const char* path, rct_object_filters* filter);
+static uint32 install_object_entry(object_scan_file *file, rct_object_entry* installed_entry, rct_object_filters* filter);
 static void load_object_filter(rct_object_entry* entry, uint8* chunk, rct_object_filters* filter);
 
 static rct_object_filters *_installedObjectFilters = NULL;
+static rct_object_file_record *_installedObjectFileRecords = NULL;
 
 uint32 gInstalledObjectsCount;
 rct_object_entry *gInstalledObjects;
@@ -111,65 +155,83 @@ static void get_plugin_path(utf8 *outPath)
 	strcat(outPath, "plugin.dat");
 }
 
+typedef struct {
+	rct_object_entry *entry;
+	const char *name;
+	int index;
+} object_sort_item;
+
+static int object_list_sort_compare(const void *a, const void *b)
+{
+	const object_sort_item *itemA = (const object_sort_item*)a;
+	const object_sort_item *itemB = (const object_sort_item*)b;
+
+	int result = strcmp(itemA->name, itemB->name);
+	if (result != 0)
+		return result;
+
+	// Keep objects with the same name in their installed order
+	return itemA->index - itemB->index;
+}
+
 static void object_list_sort()
 {
-	rct_object_entry **objectBuffer, *newBuffer, *entry, *destEntry, *lowestEntry = NULL;
-	rct_object_filters *newFilters = NULL, *destFilter = NULL;
-	int numObjects, i, j, bufferSize, entrySize, lowestIndex = 0;
-	char *objectName, *lowestString;
-	uint8 *copied;
+	rct_object_entry *newBuffer, *entry, *destEntry;
+	rct_object_filters *newFilters = NULL;
+	rct_object_file_record *newRecords = NULL;
+	object_sort_item *items;
+	int numObjects, i, bufferSize, entrySize;
 
-	objectBuffer = &gInstalledObjects;
 	numObjects = gInstalledObjectsCount;
-	copied = calloc(numObjects, sizeof(uint8));
+	if (numObjects == 0)
+		return;
 
-	// Get buffer size
-	entry = *objectBuffer;
-	for (i = 0; i < numObjects; i++)
+	items = malloc(numObjects * sizeof(object_sort_item));
+
+	// Get buffer size and names
+	entry = gInstalledObjects;
+	for (i = 0; i < numObjects; i++) {
+		items[i].entry = entry;
+		items[i].name = object_get_name(entry);
+		items[i].index = i;
 		entry = object_get_next(entry);
-	bufferSize = (int)entry - (int)*objectBuffer;
+	}
+	bufferSize = (int)entry - (int)gInstalledObjects;
+
+	qsort(items, numObjects, sizeof(object_sort_item), object_list_sort_compare);
 
 	// Create new buffer
 	newBuffer = (rct_object_entry*)malloc(bufferSize);
 	destEntry = newBuffer;
-	if (_installedObjectFilters) {
+	if (_installedObjectFilters)
 		newFilters = malloc(numObjects * sizeof(rct_object_filters));
-		destFilter = newFilters;
-	}
+	if (_installedObjectFileRecords)
+		newRecords = malloc(numObjects * sizeof(rct_object_file_record));
 
 	// Copy over sorted objects
 	for (i = 0; i < numObjects; i++) {
-		// Find next lowest string
-		lowestString = NULL;
-		entry = *objectBuffer;
-		for (j = 0; j < numObjects; j++) {
-			if (!copied[j]) {
-				objectName = object_get_name(entry);
-				if (lowestString == NULL || strcmp(objectName, lowestString) < 0) {
-					lowestEntry = entry;
-					lowestString = objectName;
-					lowestIndex = j;
-				}
-			}
-			entry = object_get_next(entry);
-		}
-		entrySize = object_get_length(lowestEntry);
-		memcpy(destEntry, lowestEntry, entrySize);
+		entrySize = object_get_length(items[i].entry);
+		memcpy(destEntry, items[i].entry, entrySize);
 		destEntry = (rct_object_entry*)((int)destEntry + entrySize);
-		if (_installedObjectFilters)
-			destFilter[i] = _installedObjectFilters[lowestIndex];
-		copied[lowestIndex] = 1;
+		if (newFilters)
+			newFilters[i] = _installedObjectFilters[items[i].index];
+		if (newRecords)
+			newRecords[i] = _installedObjectFileRecords[items[i].index];
 	}
 
 	// Replace old buffer
-	free(*objectBuffer);
-	*objectBuffer = newBuffer;
-	if (_installedObjectFilters) {
+	free(gInstalledObjects);
+	gInstalledObjects = newBuffer;
+	if (newFilters) {
 		free(_installedObjectFilters);
 		_installedObjectFilters = newFilters;
 	}
+	if (newRecords) {
+		free(_installedObjectFileRecords);
+		_installedObjectFileRecords = newRecords;
+	}
 
-	free(copied);
+	free(items);
 }
 
 static uint32 object_list_count_custom_objects()
@@ -248,6 +310,165 @@ static int object_list_query_directory(int *outTotalFiles, uint64 *outTotalFileS
 	return 1;
 }
 
+static uint32 object_list_hash_file_name(const utf8 *name)
+{
+	uint32 hash = 5381;
+	while (*name != '\0')
+		hash = ((hash << 5) + hash) + (uint8)*name++;
+	return hash;
+}
+
+static void object_list_index_create_hash_table(object_list_index *index)
+{
+	index->entry_list = malloc(index->count * sizeof(rct_object_entry*));
+	index->hash_table_size = 64;
+	while (index->hash_table_size < index->count * 2)
+		index->hash_table_size *= 2;
+
+	// Slots hold the object index plus one so zero can mark an empty slot
+	index->hash_table = calloc(index->hash_table_size, sizeof(uint32));
+
+	rct_object_entry *entry = index->entries;
+	for (uint32 i = 0; i < index->count; i++) {
+		index->entry_list[i] = entry;
+
+		uint32 slot = object_list_hash_file_name((utf8*)entry + 16) & (index->hash_table_size - 1);
+		while (index->hash_table[slot] != 0)
+			slot = (slot + 1) & (index->hash_table_size - 1);
+		index->hash_table[slot] = i + 1;
+
+		entry = object_get_next(entry);
+	}
+}
+
+static int object_list_index_find(const object_list_index *index, const utf8 *name)
+{
+	if (index->hash_table == NULL)
+		return -1;
+
+	uint32 slot = object_list_hash_file_name(name) & (index->hash_table_size - 1);
+	while (index->hash_table[slot] != 0) {
+		int i = index->hash_table[slot] - 1;
+		if (strcmp((utf8*)index->entry_list[i] + 16, name) == 0)
+			return i;
+		slot = (slot + 1) & (index->hash_table_size - 1);
+	}
+	return -1;
+}
+
+static void object_list_index_dispose(object_list_index *index)
+{
+	SafeFree(index->entries);
+	SafeFree(index->filters);
+	SafeFree(index->records);
+	SafeFree(index->entry_list);
+	SafeFree(index->hash_table);
+	index->count = 0;
+}
+
+/**
+ * Makes sure there is room to add an entry of the given size to the installed object list.
+ */
+static bool object_list_reserve(size_t *capacity, size_t currentEntryOffset, size_t entrySize)
+{
+	if ((*capacity - currentEntryOffset) > entrySize)
+		return true;
+
+	while ((*capacity - currentEntryOffset) <= entrySize)
+		*capacity += 4096;
+
+	// Every entry is longer than 16 bytes, so this always leaves room for the filter and file record of each entry
+	gInstalledObjects = (rct_object_entry*)realloc(gInstalledObjects, *capacity);
+	_installedObjectFilters = realloc(_installedObjectFilters, sizeof(rct_object_filters) * (*capacity / 16));
+	_installedObjectFileRecords = realloc(_installedObjectFileRecords, sizeof(rct_object_file_record) * (*capacity / 16));
+	if (gInstalledObjects == NULL || _installedObjectFilters == NULL || _installedObjectFileRecords == NULL) {
+		log_error("Failed to allocate memory for object list");
+		rct2_exit_reason(835, 3162);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Reads the object entry and decodes the chunk of an object file. Does not touch any game state as it runs on worker
+ * threads.
+ */
+static void object_list_read_file(object_scan_file *file)
+{
+	sawyercoding_chunk_header chunkHeader;
+
+	SDL_RWops *rw = SDL_RWFromFile(file->path, "rb");
+	if (rw == NULL)
+		return;
+
+	if (
+		SDL_RWread(rw, &file->entry, sizeof(rct_object_entry), 1) != 1 ||
+		SDL_RWread(rw, &chunkHeader, sizeof(sawyercoding_chunk_header), 1) != 1
+	) {
+		SDL_RWclose(rw);
+		return;
+	}
+
+	uint8 *encodedChunk = malloc(chunkHeader.length);
+	if (encodedChunk == NULL || SDL_RWread(rw, encodedChunk, chunkHeader.length, 1) != 1) {
+		free(encodedChunk);
+		SDL_RWclose(rw);
+		return;
+	}
+	SDL_RWclose(rw);
+
+	file->chunk = malloc(0x600000);
+	file->chunk_size = (int)sawyercoding_read_chunk_buffer(file->chunk, encodedChunk, chunkHeader);
+	file->chunk = realloc(file->chunk, file->chunk_size);
+	free(encodedChunk);
+
+	file->checksum = object_calculate_checksum(&file->entry, file->chunk, file->chunk_size);
+	file->read = true;
+}
+
+typedef struct {
+	object_scan_file *files;
+	int count;
+	SDL_atomic_t next;
+} object_scan_batch;
+
+static int object_list_read_files_thread(void *ptr)
+{
+	object_scan_batch *batch = (object_scan_batch*)ptr;
+
+	// Files are taken one at a time as their sizes vary too much to split them up evenly in advance
+	int i;
+	while ((i = SDL_AtomicAdd(&batch->next, 1)) < batch->count)
+		object_list_read_file(&batch->files[i]);
+	return 0;
+}
+
+/**
+ * Reads all files of a batch, spreading them over as many threads as there are processors.
+ */
+static void object_list_read_files(object_scan_file *files, int count)
+{
+	SDL_Thread *threads[OBJECT_SCAN_MAX_THREADS];
+	object_scan_batch batch;
+	int i, numThreads;
+
+	batch.files = files;
+	batch.count = count;
+	SDL_AtomicSet(&batch.next, 0);
+
+	numThreads = min(SDL_GetCPUCount(), OBJECT_SCAN_MAX_THREADS);
+	numThreads = min(numThreads, count);
+
+	// This thread reads files as well
+	for (i = 1; i < numThreads; i++)
+		threads[i] = SDL_CreateThread(object_list_read_files_thread, "object scan", &batch);
+	object_list_read_files_thread(&batch);
+	for (i = 1; i < numThreads; i++) {
+		if (threads[i] != NULL)
+			SDL_WaitThread(threads[i], NULL);
+	}
+}
+
 /**
  *
  *  rct2: 0x006A8B40
@@ -257,6 +478,7 @@ void object_list_load()
 	int enumFileHandle, totalFiles, fileDateModifiedChecksum;
 	uint64 totalFileSize;
 	file_info enumFileInfo;
+	object_list_index previousIndex = { 0 };
 
 	int ok = object_list_query_directory(&totalFiles, &totalFileSize, &fileDateModifiedChecksum);
 	if (ok != 1) {
@@ -268,69 +490,112 @@ void object_list_load()
 	totalFiles = (totalFiles & ~0xFF) | 1;
 	totalFiles = rol32(totalFiles, 24);
 
-	if (object_list_cache_load(totalFiles, totalFileSize, fileDateModifiedChecksum)) {
+	if (object_list_cache_load(totalFiles, totalFileSize, fileDateModifiedChecksum, &previousIndex)) {
 		return;
 	}
+	object_list_index_create_hash_table(&previousIndex);
 
 	// Dispose installed object list
 	reset_loaded_objects();
 	SafeFree(gInstalledObjects);
+	SafeFree(_installedObjectFilters);
+	SafeFree(_installedObjectFileRecords);
 
 	gInstalledObjectsCount = 0;
-	gInstalledObjects = (rct_object_entry*)malloc(4096);
-	if (gInstalledObjects == NULL) {
-		log_error("Failed to allocate memory for object list");
-		rct2_exit_reason(835, 3162);
-		return;
-	}
-
+	size_t installedObjectsCapacity = 0;
 	uint32 fileCount = 0;
-	uint32 objectCount = 0;
 	size_t currentEntryOffset = 0;
 	gNumInstalledRCT2Objects = 0;
 
 	log_verbose("building cache of available objects...");
 
-	if (_installedObjectFilters) {
-		free(_installedObjectFilters);
-		_installedObjectFilters = NULL;
-	}
+	int numFilesToRead = 0;
+	int filesToReadCapacity = 0;
+	object_scan_file *filesToRead = NULL;
 
+	// Keep the entries of unchanged files and collect the rest to be read
 	enumFileHandle = platform_enumerate_files_begin(RCT2_ADDRESS(RCT2_ADDRESS_OBJECT_DATA_PATH, char));
 	if (enumFileHandle != INVALID_HANDLE) {
-		size_t installedObjectsCapacity = 4096;
 		while (platform_enumerate_files_next(enumFileHandle, &enumFileInfo)) {
 			fileCount++;
 
-			if ((installedObjectsCapacity - currentEntryOffset) <= 2842){
-				installedObjectsCapacity += 4096;
-				gInstalledObjects = (rct_object_entry*)realloc(gInstalledObjects, installedObjectsCapacity);
-				if (gInstalledObjects == NULL) {
-					log_error("Failed to allocate memory for object list");
-					rct2_exit_reason(835, 3162);
-					return;
+			int previousIndexItem = object_list_index_find(&previousIndex, enumFileInfo.path);
+			if (previousIndexItem != -1) {
+				rct_object_file_record *record = &previousIndex.records[previousIndexItem];
+				if (record->size == enumFileInfo.size && record->last_modified == enumFileInfo.last_modified) {
+					rct_object_entry *previousEntry = previousIndex.entry_list[previousIndexItem];
+					// Same limit as install_object_entry
+					if ((previousEntry->flags & 0xF0) == 0x80) {
+						gNumInstalledRCT2Objects++;
+						if (gNumInstalledRCT2Objects > 772) {
+							log_error("Incorrect number of vanilla RCT2 objects.");
+							gNumInstalledRCT2Objects--;
+							continue;
+						}
+					}
+
+					int entrySize = object_get_length(previousEntry);
+					if (!object_list_reserve(&installedObjectsCapacity, currentEntryOffset, entrySize)) {
+						object_list_index_dispose(&previousIndex);
+						free(filesToRead);
+						platform_enumerate_files_end(enumFileHandle);
+						return;
+					}
+
+					memcpy((uint8*)gInstalledObjects + currentEntryOffset, previousEntry, entrySize);
+					_installedObjectFilters[gInstalledObjectsCount] = previousIndex.filters[previousIndexItem];
+					_installedObjectFileRecords[gInstalledObjectsCount] = *record;
+					gInstalledObjectsCount++;
+					currentEntryOffset += entrySize;
+					continue;
 				}
 			}
 
-			char path[MAX_PATH];
-			substitute_path(path, RCT2_ADDRESS(RCT2_ADDRESS_OBJECT_DATA_PATH, char), enumFileInfo.path);
+			if (numFilesToRead >= filesToReadCapacity) {
+				filesToReadCapacity = max(64, filesToReadCapacity * 2);
+				filesToRead = realloc(filesToRead, filesToReadCapacity * sizeof(object_scan_file));
+			}
+			object_scan_file *file = &filesToRead[numFilesToRead++];
+			memset(file, 0, sizeof(object_scan_file));
+			safe_strcpy(file->name, enumFileInfo.path, sizeof(file->name));
+			substitute_path(file->path, RCT2_ADDRESS(RCT2_ADDRESS_OBJECT_DATA_PATH, char), enumFileInfo.path);
+			file->record.size = enumFileInfo.size;
+			file->record.last_modified = enumFileInfo.last_modified;
+		}
+		platform_enumerate_files_end(enumFileHandle);
+	}
+	object_list_index_dispose(&previousIndex);
 
-			rct_object_entry entry;
-			if (object_load_entry(path, &entry)) {
-				_installedObjectFilters = realloc(_installedObjectFilters, sizeof(rct_object_filters) * (objectCount + 1));
+	log_verbose("%u objects unchanged, reading %d object files", gInstalledObjectsCount, numFilesToRead);
 
-				rct_object_entry *installedEntry = (rct_object_entry*)((size_t)gInstalledObjects + currentEntryOffset);
-				rct_object_filters filter;
-				size_t newEntrySize = install_object_entry(&entry, installedEntry, enumFileInfo.path, &filter);
-				if (newEntrySize != 0) {
-					_installedObjectFilters[objectCount] = filter;
-					objectCount++;
-					currentEntryOffset += newEntrySize;
-				}
+	for (int batchStart = 0; batchStart < numFilesToRead; batchStart += OBJECT_SCAN_BATCH_SIZE) {
+		int batchCount = min(OBJECT_SCAN_BATCH_SIZE, numFilesToRead - batchStart);
+		object_list_read_files(&filesToRead[batchStart], batchCount);
+
+		for (int i = batchStart; i < batchStart + batchCount; i++) {
+			object_scan_file *file = &filesToRead[i];
+			if (!file->read)
+				continue;
+
+			// Entry size is at most the entry, file name, name and referenced objects
+			if (!object_list_reserve(&installedObjectsCapacity, currentEntryOffset, 2842)) {
+				for (; i < numFilesToRead; i++)
+					free(filesToRead[i].chunk);
+				free(filesToRead);
+				return;
+			}
+
+			rct_object_entry *installedEntry = (rct_object_entry*)((size_t)gInstalledObjects + currentEntryOffset);
+			rct_object_filters filter;
+			size_t newEntrySize = install_object_entry(file, installedEntry, &filter);
+			if (newEntrySize != 0) {
+				_installedObjectFilters[gInstalledObjectsCount - 1] = filter;
+				_installedObjectFileRecords[gInstalledObjectsCount - 1] = file->record;
+				currentEntryOffset += newEntrySize;
 			}
 		}
-		platform_enumerate_files_end(enumFileHandle);
 	}
+	free(filesToRead);
 
 	reset_loaded_objects();
 
@@ -345,12 +610,19 @@ void object_list_load()
 	object_list_examine();
 }
 
-static int object_list_cache_load(int totalFiles, uint64 totalFileSize, int fileDateModifiedChecksum)
+/**
+ * Loads the installed object list from plugin.dat. If any object file has changed since it was saved, the list is
+ * instead returned in outPreviousIndex so the unchanged files do not need to be read again.
+ */
+static int object_list_cache_load(int totalFiles, uint64 totalFileSize, int fileDateModifiedChecksum, object_list_index *outPreviousIndex)
 {
 	char path[MAX_PATH];
 	SDL_RWops *file;
 	rct_plugin_header pluginHeader;
 	uint32 filterVersion = 0;
+	rct_object_entry *entries = NULL;
+	rct_object_filters *filters = NULL;
+	rct_object_file_record *records = NULL;
 
 	log_verbose("loading object list cache (plugin.dat)");
 
@@ -361,61 +633,73 @@ static int object_list_cache_load(int totalFiles, uint64 totalFileSize, int file
 		return 0;
 	}
 
-	if (SDL_RWread(file, &pluginHeader, sizeof(rct_plugin_header), 1) == 1) {
-		// Check if object repository has changed in anyway
-		if (
-			pluginHeader.total_files == totalFiles &&
-			pluginHeader.total_file_size == totalFileSize &&
-			pluginHeader.date_modified_checksum == fileDateModifiedChecksum
-		) {
-			// Dispose installed object list
-			SafeFree(gInstalledObjects);
-
-			// Read installed object list
-			gInstalledObjects = (rct_object_entry*)malloc(pluginHeader.object_list_size);
-			if (SDL_RWread(file, gInstalledObjects, pluginHeader.object_list_size, 1) == 1) {
-				gInstalledObjectsCount = pluginHeader.object_list_no_items;
-
-				if (pluginHeader.object_list_no_items != (pluginHeader.total_files & 0xFFFFFF))
-					log_error("Potential mismatch in file numbers. Possible corrupt file. Consider deleting plugin.dat.");
-
-				if (SDL_RWread(file, &filterVersion, sizeof(filterVersion), 1) == 1) {
-					if (filterVersion == FILTER_VERSION) {
-						if (_installedObjectFilters != NULL) {
-							free(_installedObjectFilters);
-						}
-						_installedObjectFilters = malloc(sizeof(rct_object_filters) * pluginHeader.object_list_no_items);
-						if (SDL_RWread(file, _installedObjectFilters, sizeof(rct_object_filters) * pluginHeader.object_list_no_items, 1) == 1) {
-							SDL_RWclose(file);
-							reset_loaded_objects();
-							object_list_examine();
-							return 1;
-						}
-					}
-				}
-				log_info("Filter version updated... updating object list cache");
-			}
-		}
-		else if (pluginHeader.total_files != totalFiles) {
-			int fileCount = totalFiles - pluginHeader.total_files;
-			if (fileCount < 0) {
-				log_info("%d object removed... updating object list cache", abs(fileCount));
-			} else {
-				log_info("%d object added... updating object list cache", fileCount);
-			}
-		} else if (pluginHeader.total_file_size != totalFileSize) {
-			log_info("Objects files size changed... updating object list cache");
-		} else if (pluginHeader.date_modified_checksum != fileDateModifiedChecksum) {
-			log_info("Objects files have been updated... updating object list cache");
-		}
-
+	if (SDL_RWread(file, &pluginHeader, sizeof(rct_plugin_header), 1) != 1) {
 		SDL_RWclose(file);
+		log_error("loading object list cache failed");
 		return 0;
 	}
 
+	entries = (rct_object_entry*)malloc(pluginHeader.object_list_size);
+	filters = malloc(sizeof(rct_object_filters) * pluginHeader.object_list_no_items);
+	records = malloc(sizeof(rct_object_file_record) * pluginHeader.object_list_no_items);
+	if (
+		entries == NULL || filters == NULL || records == NULL ||
+		SDL_RWread(file, entries, pluginHeader.object_list_size, 1) != 1 ||
+		SDL_RWread(file, &filterVersion, sizeof(filterVersion), 1) != 1 ||
+		filterVersion != FILTER_VERSION ||
+		SDL_RWread(file, filters, sizeof(rct_object_filters) * pluginHeader.object_list_no_items, 1) != 1 ||
+		SDL_RWread(file, records, sizeof(rct_object_file_record) * pluginHeader.object_list_no_items, 1) != 1
+	) {
+		SDL_RWclose(file);
+		free(entries);
+		free(filters);
+		free(records);
+		log_info("Filter version updated... updating object list cache");
+		return 0;
+	}
 	SDL_RWclose(file);
 
-	log_error("loading object list cache failed");
+	// Check if object repository has changed in anyway
+	if (
+		pluginHeader.total_files == totalFiles &&
+		pluginHeader.total_file_size == totalFileSize &&
+		pluginHeader.date_modified_checksum == fileDateModifiedChecksum
+	) {
+		if (pluginHeader.object_list_no_items != (pluginHeader.total_files & 0xFFFFFF))
+			log_error("Potential mismatch in file numbers. Possible corrupt file. Consider deleting plugin.dat.");
+
+		// Dispose installed object list
+		SafeFree(gInstalledObjects);
+		SafeFree(_installedObjectFilters);
+		SafeFree(_installedObjectFileRecords);
+
+		gInstalledObjects = entries;
+		gInstalledObjectsCount = pluginHeader.object_list_no_items;
+		_installedObjectFilters = filters;
+		_installedObjectFileRecords = records;
+
+		reset_loaded_objects();
+		object_list_examine();
+		return 1;
+	}
+
+	if (pluginHeader.total_files != totalFiles) {
+		int fileCount = totalFiles - pluginHeader.total_files;
+		if (fileCount < 0) {
+			log_info("%d object removed... updating object list cache", abs(fileCount));
+		} else {
+			log_info("%d object added... updating object list cache", fileCount);
+		}
+	} else if (pluginHeader.total_file_size != totalFileSize) {
+		log_info("Objects files size changed... updating object list cache");
+	} else if (pluginHeader.date_modified_checksum != fileDateModifiedChecksum) {
+		log_info("Objects files have been updated... updating object list cache");
+	}
+
+	outPreviousIndex->entries = entries;
+	outPreviousIndex->filters = filters;
+	outPreviousIndex->records = records;
+	outPreviousIndex->count = pluginHeader.object_list_no_items;
 	return 0;
 }
 
@@ -445,6 +729,7 @@ static int object_list_cache_save(int fileCount, uint64 totalFileSize, int fileD
 	SDL_RWwrite(file, gInstalledObjects, pluginHeader.object_list_size, 1);
 	SDL_RWwrite(file, &filterVersion, sizeof(filterVersion), 1);
 	SDL_RWwrite(file, _installedObjectFilters, sizeof(rct_object_filters) * gInstalledObjectsCount, 1);
+	SDL_RWwrite(file, _installedObjectFileRecords, sizeof(rct_object_file_record) * gInstalledObjectsCount, 1);
 	SDL_RWclose(file);
 	return 1;
 }
@@ -720,7 +1005,9 @@ rct_string_id object_get_name_string_id(rct_object_entry *entry, const void *chu
  * Installs an  object_entry at the desired installed_entry address
  * Returns the size of the new entry. Will return 0 on failure.
  */
-static uint32 install_object_entry(rct_object_entry* entry, rct_object_entry* installed_entry, const char* path, rct_object_filters* filter){
+static uint32 install_object_entry(object_scan_file *file, rct_object_entry* installed_entry, rct_object_filters* filter){
+	rct_object_entry *entry = &file->entry;
+	const char *path = file->name;
 	uint8* installed_entry_pointer = (uint8*) installed_entry;
 
 	/** Copy all known information into the install entry **/
@@ -750,9 +1037,11 @@ static uint32 install_object_entry(rct_object_entry* entry, rct_object_entry* in
 	// Probably used by object paint.
 	RCT2_GLOBAL(0x009ADAF4, uint32) = 0xF42BDB;
 
-	/** Use object_load_file to fill in missing chunk information **/
-	int chunk_size;
-	if (!object_load_file(-1, entry, &chunk_size, installed_entry)){
+	/** Use the chunk read by the scan to fill in missing chunk information **/
+	int chunk_size = file->chunk_size;
+	uint8 *fileChunk = file->chunk;
+	file->chunk = NULL;
+	if (!object_load_decoded_chunk(-1, entry, fileChunk, chunk_size, file->checksum)){
 		log_error("Object Load File failed. Potentially corrupt file: %.8s", entry->name);
 		RCT2_GLOBAL(0x009ADAF4, sint32) = -1;
 		RCT2_GLOBAL(0x009ADAFD, uint8) = 0;
@@ -34,7 +34,9 @@
 #include "network/network.h"
 #include "openrct2.h"
 #include "platform/crash.h"
+#include "peep/peep.h"
 #include "platform/platform.h"
+#include "replay.h"
 #include "ride/ride.h"
 #include "title.h"
 #include "util/sawyercoding.h"
@@ -331,7 +333,9 @@ void openrct2_launch()
 
 void openrct2_dispose()
 {
+	replay_stop_recording();
 	network_close();
+	peep_stop_assessment_threads();
 	http_dispose();
 	language_close_all();
 	rct2_dispose();
@@ -53,7 +53,14 @@ enum {
 	PATH_SEARCH_WIDE,
 };
 
+// One bit per ride index, used when guests decide which rides to consider
+#define RIDE_CONSIDERATION_WORDS ((MAX_RIDES + 31) / 32)
+
+// Rides exciting enough for every guest to consider, snapshotted once per peep_update_all
+static uint32 _peepBigRideCandidates[RIDE_CONSIDERATION_WORDS];
+
 static void sub_68F41A(rct_peep *peep, int index);
+static uint8 peep_assess_surroundings(sint16 center_x, sint16 center_y, sint16 center_z);
 static void peep_update(rct_peep *peep);
 static int peep_has_empty_container(rct_peep* peep);
 static int peep_has_drink(rct_peep* peep);
@@ -89,6 +96,8 @@ static void peep_pick_ride_to_go_on(rct_peep *peep);
 static void peep_head_for_nearest_ride_type(rct_peep *peep, int rideType);
 static void peep_head_for_nearest_ride_with_flags(rct_peep *peep, int rideTypeFlags);
 static void peep_give_real_name(rct_peep *peep);
+static void peep_update_big_ride_candidates();
+static int peep_filter_considered_rides(rct_peep *peep, const uint32 *rideConsideration, uint8 *potentialRides);
 static int guest_surface_path_finding(rct_peep* peep);
 static void peep_read_map(rct_peep *peep);
 static bool peep_heading_for_ride_or_park_exit(rct_peep *peep);
@@ -158,6 +167,269 @@ int peep_get_staff_count()
 	return count;
 }
 
+#define PEEP_MAX_ASSESSMENT_THREADS 16
+
+// Waking a worker costs about as much as a few assessments, so smaller batches are run on the game thread
+#define PEEP_MIN_ASSESSMENTS_PER_THREAD 8
+
+// A guest assesses its surroundings every 512 ticks, see sub_68F41A
+#define PEEP_MAX_ASSESSMENTS (MAX_SPRITES / 512 + 1)
+
+typedef struct {
+	uint16 sprite_index;
+	sint16 x;
+	sint16 y;
+	sint16 z;
+	uint8 thought_type;
+} peep_surroundings_assessment;
+
+typedef struct {
+	peep_surroundings_assessment *assessments;
+	int count;
+} peep_assessment_range;
+
+static peep_surroundings_assessment _peepAssessments[PEEP_MAX_ASSESSMENTS];
+static int _peepAssessmentCount;
+
+// Worker threads kept between ticks, range 0 is always run on the game thread
+static SDL_mutex *_peepWorkerMutex;
+static SDL_cond *_peepWorkerStartCond;
+static SDL_cond *_peepWorkerDoneCond;
+static SDL_Thread *_peepWorkers[PEEP_MAX_ASSESSMENT_THREADS];
+static peep_assessment_range _peepWorkerRanges[PEEP_MAX_ASSESSMENT_THREADS];
+static int _peepWorkerCount;
+static int _peepWorkerRequestedCount;
+static int _peepWorkersActive;
+static int _peepWorkersPending;
+static uint32 _peepWorkerGeneration;
+static bool _peepWorkersStopping;
+
+static void peep_assess_range(peep_assessment_range *range)
+{
+	for (int i = 0; i < range->count; i++) {
+		peep_surroundings_assessment *assessment = &range->assessments[i];
+		assessment->thought_type = peep_assess_surroundings(assessment->x, assessment->y, assessment->z);
+	}
+}
+
+static int peep_assessment_worker(void *ptr)
+{
+	int index = (int)(intptr_t)ptr;
+	uint32 generation = 0;
+
+	SDL_LockMutex(_peepWorkerMutex);
+	for (;;) {
+		while (_peepWorkerGeneration == generation && !_peepWorkersStopping)
+			SDL_CondWait(_peepWorkerStartCond, _peepWorkerMutex);
+		if (_peepWorkersStopping)
+			break;
+
+		generation = _peepWorkerGeneration;
+		if (index >= _peepWorkersActive)
+			continue;
+
+		SDL_UnlockMutex(_peepWorkerMutex);
+		peep_assess_range(&_peepWorkerRanges[index]);
+		SDL_LockMutex(_peepWorkerMutex);
+
+		_peepWorkersPending--;
+		if (_peepWorkersPending == 0)
+			SDL_CondSignal(_peepWorkerDoneCond);
+	}
+	SDL_UnlockMutex(_peepWorkerMutex);
+	return 0;
+}
+
+void peep_stop_assessment_threads()
+{
+	if (_peepWorkerMutex == NULL)
+		return;
+
+	SDL_LockMutex(_peepWorkerMutex);
+	_peepWorkersStopping = true;
+	SDL_CondBroadcast(_peepWorkerStartCond);
+	SDL_UnlockMutex(_peepWorkerMutex);
+	for (int i = 1; i < _peepWorkerCount; i++) {
+		if (_peepWorkers[i] != NULL)
+			SDL_WaitThread(_peepWorkers[i], NULL);
+		_peepWorkers[i] = NULL;
+	}
+
+	SDL_DestroyCond(_peepWorkerDoneCond);
+	SDL_DestroyCond(_peepWorkerStartCond);
+	SDL_DestroyMutex(_peepWorkerMutex);
+	_peepWorkerDoneCond = NULL;
+	_peepWorkerStartCond = NULL;
+	_peepWorkerMutex = NULL;
+	_peepWorkerCount = 0;
+	_peepWorkerRequestedCount = 0;
+	_peepWorkersStopping = false;
+}
+
+/**
+ * Starts the worker threads once, or again when gGameUpdateThreads changes. Returns the number of ranges that can be
+ * run at once, including the one on the game thread.
+ */
+static int peep_start_assessment_threads(int numThreads)
+{
+	if (_peepWorkerRequestedCount == numThreads)
+		return max(_peepWorkerCount, 1);
+
+	peep_stop_assessment_threads();
+	_peepWorkerRequestedCount = numThreads;
+	if (numThreads <= 1)
+		return 1;
+
+	_peepWorkerMutex = SDL_CreateMutex();
+	_peepWorkerStartCond = SDL_CreateCond();
+	_peepWorkerDoneCond = SDL_CreateCond();
+	_peepWorkerGeneration = 0;
+	_peepWorkerCount = 1;
+	if (_peepWorkerMutex == NULL || _peepWorkerStartCond == NULL || _peepWorkerDoneCond == NULL) {
+		log_warning("Unable to create peep threads, running assessments on main thread.");
+		return 1;
+	}
+
+	for (int i = 1; i < numThreads; i++) {
+		_peepWorkers[i] = SDL_CreateThread(peep_assessment_worker, "peep", (void*)(intptr_t)i);
+		if (_peepWorkers[i] == NULL) {
+			log_warning("Unable to create peep thread, running assessments on fewer threads.");
+			break;
+		}
+		_peepWorkerCount++;
+	}
+	return _peepWorkerCount;
+}
+
+/**
+ * Assesses the surroundings for each entry, splitting them over gGameUpdateThreads threads when there are enough of
+ * them to be worth waking the workers for.
+ */
+static void peep_run_assessments(peep_surroundings_assessment *assessments, int count)
+{
+	int i, numThreads;
+
+	numThreads = gGameUpdateThreads > 0 ? gGameUpdateThreads : SDL_GetCPUCount();
+	numThreads = clamp(1, numThreads, PEEP_MAX_ASSESSMENT_THREADS);
+	numThreads = min(peep_start_assessment_threads(numThreads), count / PEEP_MIN_ASSESSMENTS_PER_THREAD);
+	if (numThreads <= 1) {
+		peep_assessment_range range = { assessments, count };
+		peep_assess_range(&range);
+		return;
+	}
+
+	for (i = 0; i < numThreads; i++) {
+		int start = (count * i) / numThreads;
+		int end = (count * (i + 1)) / numThreads;
+		_peepWorkerRanges[i].assessments = &assessments[start];
+		_peepWorkerRanges[i].count = end - start;
+	}
+
+	SDL_LockMutex(_peepWorkerMutex);
+	_peepWorkersActive = numThreads;
+	_peepWorkersPending = numThreads - 1;
+	_peepWorkerGeneration++;
+	SDL_CondBroadcast(_peepWorkerStartCond);
+	SDL_UnlockMutex(_peepWorkerMutex);
+
+	peep_assess_range(&_peepWorkerRanges[0]);
+
+	SDL_LockMutex(_peepWorkerMutex);
+	while (_peepWorkersPending > 0)
+		SDL_CondWait(_peepWorkerDoneCond, _peepWorkerMutex);
+	SDL_UnlockMutex(_peepWorkerMutex);
+}
+
+/**
+ * With entity random streams on, guests that are due to assess their surroundings this tick do so against the park as
+ * it was at the start of the tick, so the result no longer depends on which peeps were updated first. The assessments
+ * only read the map, rides and litter, so they are run up front and can be split over threads.
+ */
+static void peep_prepare_surroundings_assessments()
+{
+	uint16 spriteIndex;
+	rct_peep *peep;
+	int i;
+
+	_peepAssessmentCount = 0;
+	if (!scenario_rand_streams_enabled())
+		return;
+
+	// Same index and conditions as peep_update_all and sub_68F41A
+	i = 0;
+	FOR_ALL_PEEPS(spriteIndex, peep) {
+		if ((i & 0x1FF) == (RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32) & 0x1FF) &&
+			peep->type == PEEP_TYPE_GUEST &&
+			(peep->state == PEEP_STATE_WALKING || peep->state == PEEP_STATE_SITTING) &&
+			peep->var_F2 >= 17 &&
+			peep->x != (sint16)0x8000 &&
+			_peepAssessmentCount < PEEP_MAX_ASSESSMENTS
+		) {
+			peep_surroundings_assessment *assessment = &_peepAssessments[_peepAssessmentCount++];
+			assessment->sprite_index = peep->sprite_index;
+			assessment->x = peep->x & 0xFFE0;
+			assessment->y = peep->y & 0xFFE0;
+			assessment->z = peep->z;
+		}
+		i++;
+	}
+
+	peep_run_assessments(_peepAssessments, _peepAssessmentCount);
+}
+
+/**
+ * Assesses the surroundings of every guest on the map in one batch and writes the thoughts in guest list order.
+ * In a game only a guest or two assess their surroundings each tick, so this is how the replay determinism check
+ * gets enough assessments to run them on several threads at once. Does not change the game state.
+ */
+int peep_assess_all_surroundings(uint8 *thoughts, int capacity)
+{
+	uint16 spriteIndex;
+	rct_peep *peep;
+	int i, count = 0;
+
+	peep_surroundings_assessment *assessments = malloc(capacity * sizeof(peep_surroundings_assessment));
+	if (assessments == NULL)
+		return 0;
+
+	FOR_ALL_GUESTS(spriteIndex, peep) {
+		if (peep->x == (sint16)0x8000)
+			continue;
+		if (count == capacity)
+			break;
+
+		peep_surroundings_assessment *assessment = &assessments[count++];
+		assessment->sprite_index = peep->sprite_index;
+		assessment->x = peep->x & 0xFFE0;
+		assessment->y = peep->y & 0xFFE0;
+		assessment->z = peep->z;
+	}
+
+	peep_run_assessments(assessments, count);
+	for (i = 0; i < count; i++)
+		thoughts[i] = assessments[i].thought_type;
+
+	free(assessments);
+	return count;
+}
+
+/**
+ * Returns the assessment made by peep_prepare_surroundings_assessments for the peep, or assesses its surroundings now
+ * if there is none for where it is standing.
+ */
+static uint8 peep_get_surroundings_thought(rct_peep *peep)
+{
+	sint16 x = peep->x & 0xFFE0;
+	sint16 y = peep->y & 0xFFE0;
+
+	for (int i = 0; i < _peepAssessmentCount; i++) {
+		peep_surroundings_assessment *assessment = &_peepAssessments[i];
+		if (assessment->sprite_index == peep->sprite_index && assessment->x == x && assessment->y == y && assessment->z == peep->z)
+			return assessment->thought_type;
+	}
+	return peep_assess_surroundings(x, y, peep->z);
+}
+
 /**
  *
  *  rct2: 0x0068F0A9
@@ -171,12 +443,16 @@ void peep_update_all()
 	if (RCT2_GLOBAL(RCT2_ADDRESS_SCREEN_FLAGS, uint8) & 0x0E)
 		return;
 
+	peep_update_big_ride_candidates();
+	peep_prepare_surroundings_assessments();
+
 	spriteIndex = RCT2_GLOBAL(RCT2_ADDRESS_SPRITES_START_PEEP, uint16);
 	i = 0;
 	while (spriteIndex != SPRITE_INDEX_NULL) {
 		peep = &(g_sprite_list[spriteIndex].peep);
 		spriteIndex = peep->next;
 
+		scenario_rand_begin_stream(RAND_STREAM_SPRITE, peep->sprite_index);
 		if ((i & 0x7F) != (RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32) & 0x7F)) {
 			peep_update(peep);
 		} else {
@@ -184,6 +460,7 @@ void peep_update_all()
 			if (peep->linked_list_type_offset == SPRITE_LINKEDLIST_OFFSET_PEEP)
 				peep_update(peep);
 		}
+		scenario_rand_end_stream();
 
 		i++;
 	}
@@ -445,7 +722,7 @@ static void sub_68F41A(rct_peep *peep, int index)
 				peep->var_F2 = 0;
 				if (peep->x != (sint16)0x8000){
 
-					uint8 thought_type = peep_assess_surroundings(peep->x & 0xFFE0, peep->y & 0xFFE0, peep->z);
+					uint8 thought_type = peep_get_surroundings_thought(peep);
 
 					if (thought_type != PEEP_THOUGHT_TYPE_NONE) {
 						peep_insert_new_thought(peep, thought_type, 0xFF);
@@ -9930,6 +10207,46 @@ static bool peep_should_go_to_shop(rct_peep *peep, int rideIndex, bool peepAtSho
 	return true;
 }
 
+/**
+ * Ride excitement and drop height do not change while guests are updated, so the set of rides
+ * that are big enough to be seen from anywhere in the park is the same for every guest in a
+ * single peep_update_all pass. Build it once rather than scanning all rides per guest.
+ */
+static void peep_update_big_ride_candidates()
+{
+	int i;
+	rct_ride *ride;
+
+	memset(_peepBigRideCandidates, 0, sizeof(_peepBigRideCandidates));
+	FOR_ALL_RIDES(i, ride) {
+		if (ride->excitement == (ride_rating)0xFFFF) continue;
+		if (ride->highest_drop_height <= 66 && ride->excitement < RIDE_RATING(8,00)) continue;
+
+		_peepBigRideCandidates[i >> 5] |= (1u << (i & 0x1F));
+	}
+}
+
+/**
+ * Filters the considered rides down to the ones the peep would go on, in ride index order.
+ * Returns the number of rides written to potentialRides.
+ */
+static int peep_filter_considered_rides(rct_peep *peep, const uint32 *rideConsideration, uint8 *potentialRides)
+{
+	int numPotentialRides = 0;
+	for (int i = 0; i < MAX_RIDES; i++) {
+		if (!(rideConsideration[i >> 5] & (1u << (i & 0x1F))))
+			continue;
+
+		rct_ride *ride = get_ride(i);
+		if (!(ride->lifecycle_flags & RIDE_LIFECYCLE_QUEUE_FULL)) {
+			if (peep_should_go_on_ride(peep, i, 0, PEEP_RIDE_DECISION_THINKING)) {
+				potentialRides[numPotentialRides++] = i;
+			}
+		}
+	}
+	return numPotentialRides;
+}
+
 /**
  *
  *  rct2: 0x00695DD2
@@ -9944,14 +10261,7 @@ static void peep_pick_ride_to_go_on(rct_peep *peep)
 	if (peep_has_food(peep)) return;
 	if (peep->x == (sint16)0x8000) return;
 
-	RCT2_GLOBAL(0x00F1AD98, uint32) = 0;
-	RCT2_GLOBAL(0x00F1AD9C, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADA0, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADA4, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADA8, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADAC, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADB0, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADB4, uint32) = 0;
+	uint32 rideConsideration[RIDE_CONSIDERATION_WORDS] = { 0 };
 
 	// FIX  Originally checked for a toy, likely a mistake and should be a map,
 	//      but then again this seems to only allow the peep to go on
@@ -9961,7 +10271,7 @@ static void peep_pick_ride_to_go_on(rct_peep *peep)
 		int i;
 		FOR_ALL_RIDES(i, ride) {
 			if (!peep_has_ridden(peep, i)) {
-				RCT2_ADDRESS(0x00F1AD98, uint32)[i >> 5] |= (1u << (i & 0x1F));
+				rideConsideration[i >> 5] |= (1u << (i & 0x1F));
 			}
 		}
 	} else {
@@ -9976,40 +10286,32 @@ static void peep_pick_ride_to_go_on(rct_peep *peep)
 						if (map_element_get_type(mapElement) != MAP_ELEMENT_TYPE_TRACK) continue;
 
 						int rideIndex = mapElement->properties.track.ride_index;
-						RCT2_ADDRESS(0x00F1AD98, uint32)[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
+						rideConsideration[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
 					} while (!map_element_is_last_for_tile(mapElement++));
 				}
 			}
 		}
 
 		// Always take the big rides into consideration (realistic as you can usually see them from anywhere in the park)
-		int i;
-		FOR_ALL_RIDES(i, ride) {
-			if (ride->lifecycle_flags == RIDE_LIFECYCLE_TESTED) continue;
-			if (ride->excitement == (ride_rating)0xFFFF) continue;
-			if (ride->highest_drop_height <= 66 && ride->excitement < RIDE_RATING(8,00)) continue;
-
-			RCT2_ADDRESS(0x00F1AD98, uint32)[i >> 5] |= (1u << (i & 0x1F));
-		}
-	}
+		for (int w = 0; w < RIDE_CONSIDERATION_WORDS; w++) {
+			uint32 bigRides = _peepBigRideCandidates[w];
+			while (bigRides != 0) {
+				int bit = bitscanforward(bigRides);
+				bigRides &= ~(1u << bit);
 
-	// Filter the considered rides
-	uint8 *potentialRides = (uint8*)0x00F1ADBC;
-	uint8 *nextPotentialRide = potentialRides;
-	int numPotentialRides = 0;
-	for (int i = 0; i < MAX_RIDES; i++) {
-		if (!(RCT2_ADDRESS(0x00F1AD98, uint32)[i >> 5] & (1u << (i & 0x1F))))
-			continue;
+				// Lifecycle flags can change while guests are updated (queue full, inspections), so check them live
+				int i = (w << 5) | bit;
+				if (get_ride(i)->lifecycle_flags == RIDE_LIFECYCLE_TESTED) continue;
 
-		rct_ride *ride = get_ride(i);
-		if (!(ride->lifecycle_flags & RIDE_LIFECYCLE_QUEUE_FULL)) {
-			if (peep_should_go_on_ride(peep, i, 0, PEEP_RIDE_DECISION_THINKING)) {
-				*nextPotentialRide++ = i;
-				numPotentialRides++;
+				rideConsideration[w] |= (1u << bit);
 			}
 		}
 	}
 
+	// Filter the considered rides
+	uint8 potentialRides[MAX_RIDES];
+	int numPotentialRides = peep_filter_considered_rides(peep, rideConsideration, potentialRides);
+
 	// Pick the most exciting ride
 	int mostExcitingRideIndex = -1;
 	ride_rating mostExcitingRideRating = 0;
@@ -10062,14 +10364,7 @@ static void peep_head_for_nearest_ride_type(rct_peep *peep, int rideType)
 		}
 	}
 
-	RCT2_GLOBAL(0x00F1AD98, uint32) = 0;
-	RCT2_GLOBAL(0x00F1AD9C, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADA0, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADA4, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADA8, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADAC, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADB0, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADB4, uint32) = 0;
+	uint32 rideConsideration[RIDE_CONSIDERATION_WORDS] = { 0 };
 
 	// FIX Originally checked for a toy,.likely a mistake and should be a map
 	if ((peep->item_standard_flags & PEEP_ITEM_MAP) && rideType != RIDE_TYPE_FIRST_AID) {
@@ -10077,7 +10372,7 @@ static void peep_head_for_nearest_ride_type(rct_peep *peep, int rideType)
 		int i;
 		FOR_ALL_RIDES(i, ride) {
 			if (ride->type == rideType) {
-				RCT2_ADDRESS(0x00F1AD98, uint32)[i >> 5] |= (1u << (i & 0x1F));
+				rideConsideration[i >> 5] |= (1u << (i & 0x1F));
 			}
 		}
 	} else {
@@ -10094,7 +10389,7 @@ static void peep_head_for_nearest_ride_type(rct_peep *peep, int rideType)
 						int rideIndex = mapElement->properties.track.ride_index;
 						ride = get_ride(rideIndex);
 						if (ride->type == rideType) {
-							RCT2_ADDRESS(0x00F1AD98, uint32)[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
+							rideConsideration[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
 						}
 					} while (!map_element_is_last_for_tile(mapElement++));
 				}
@@ -10103,21 +10398,8 @@ static void peep_head_for_nearest_ride_type(rct_peep *peep, int rideType)
 	}
 
 	// Filter the considered rides
-	uint8 *potentialRides = (uint8*)0x00F1ADBC;
-	uint8 *nextPotentialRide = potentialRides;
-	int numPotentialRides = 0;
-	for (int i = 0; i < MAX_RIDES; i++) {
-		if (!(RCT2_ADDRESS(0x00F1AD98, uint32)[i >> 5] & (1u << (i & 0x1F))))
-			continue;
-
-		rct_ride *ride = get_ride(i);
-		if (!(ride->lifecycle_flags & RIDE_LIFECYCLE_QUEUE_FULL)) {
-			if (peep_should_go_on_ride(peep, i, 0, PEEP_RIDE_DECISION_THINKING)) {
-				*nextPotentialRide++ = i;
-				numPotentialRides++;
-			}
-		}
-	}
+	uint8 potentialRides[MAX_RIDES];
+	int numPotentialRides = peep_filter_considered_rides(peep, rideConsideration, potentialRides);
 
 	// Pick the closest ride
 	int closestRideIndex = -1;
@@ -10174,14 +10456,7 @@ static void peep_head_for_nearest_ride_with_flags(rct_peep *peep, int rideTypeFl
 		return;
 	}
 
-	RCT2_GLOBAL(0x00F1AD98, uint32) = 0;
-	RCT2_GLOBAL(0x00F1AD9C, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADA0, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADA4, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADA8, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADAC, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADB0, uint32) = 0;
-	RCT2_GLOBAL(0x00F1ADB4, uint32) = 0;
+	uint32 rideConsideration[RIDE_CONSIDERATION_WORDS] = { 0 };
 
 	// FIX Originally checked for a toy,.likely a mistake and should be a map
 	if (peep->item_standard_flags & PEEP_ITEM_MAP) {
@@ -10189,7 +10464,7 @@ static void peep_head_for_nearest_ride_with_flags(rct_peep *peep, int rideTypeFl
 		int i;
 		FOR_ALL_RIDES(i, ride) {
 			if (ride_type_has_flag(ride->type, rideTypeFlags)) {
-				RCT2_ADDRESS(0x00F1AD98, uint32)[i >> 5] |= (1u << (i & 0x1F));
+				rideConsideration[i >> 5] |= (1u << (i & 0x1F));
 			}
 		}
 	} else {
@@ -10206,7 +10481,7 @@ static void peep_head_for_nearest_ride_with_flags(rct_peep *peep, int rideTypeFl
 						int rideIndex = mapElement->properties.track.ride_index;
 						ride = get_ride(rideIndex);
 						if (ride_type_has_flag(ride->type, rideTypeFlags)) {
-							RCT2_ADDRESS(0x00F1AD98, uint32)[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
+							rideConsideration[rideIndex >> 5] |= (1u << (rideIndex & 0x1F));
 						}
 					} while (!map_element_is_last_for_tile(mapElement++));
 				}
@@ -10215,21 +10490,8 @@ static void peep_head_for_nearest_ride_with_flags(rct_peep *peep, int rideTypeFl
 	}
 
 	// Filter the considered rides
-	uint8 *potentialRides = (uint8*)0x00F1ADBC;
-	uint8 *nextPotentialRide = potentialRides;
-	int numPotentialRides = 0;
-	for (int i = 0; i < MAX_RIDES; i++) {
-		if (!(RCT2_ADDRESS(0x00F1AD98, uint32)[i >> 5] & (1u << (i & 0x1F))))
-			continue;
-
-		rct_ride *ride = get_ride(i);
-		if (!(ride->lifecycle_flags & RIDE_LIFECYCLE_QUEUE_FULL)) {
-			if (peep_should_go_on_ride(peep, i, 0, PEEP_RIDE_DECISION_THINKING)) {
-				*nextPotentialRide++ = i;
-				numPotentialRides++;
-			}
-		}
-	}
+	uint8 potentialRides[MAX_RIDES];
+	int numPotentialRides = peep_filter_considered_rides(peep, rideConsideration, potentialRides);
 
 	// Pick the closest ride
 	int closestRideIndex = -1;
@@ -602,6 +602,8 @@ enum {
 int peep_get_staff_count();
 int peep_can_be_picked_up(rct_peep* peep);
 void peep_update_all();
+int peep_assess_all_surroundings(uint8 *thoughts, int capacity);
+void peep_stop_assessment_threads();
 void peep_problem_warnings_update();
 void peep_update_crowd_noise();
 void peep_update_days_in_queue();
@@ -565,26 +565,65 @@ bool staff_is_patrol_area_set(int staffIndex, int x, int y)
  * 
  * Returns 0xFF when no nearby litter or unpathable litter
  */
-static uint8 staff_handyman_direction_to_nearest_litter(rct_peep* peep){
-	uint16 nearestLitterDist = (uint16)-1;
+static uint16 staff_handyman_litter_distance(rct_peep* peep, rct_litter* litter){
+	return
+		abs(litter->x - peep->x) +
+		abs(litter->y - peep->y) +
+		abs(litter->z - peep->z) * 4;
+}
+
+/**
+ * Finds the litter the old search over the whole litter list would pick, as long as it is within
+ * 0x60 of the peep. Only the sprite quadrants (tiles) that could hold such litter are visited.
+ */
+static rct_litter* staff_handyman_find_nearest_litter(rct_peep* peep){
+	uint16 nearestLitterDist = 0x60 + 1;
 	rct_litter* nearestLitter = NULL;
-	rct_litter* litter = NULL;
-	
-	for(uint16 litterIndex = RCT2_GLOBAL(RCT2_ADDRESS_SPRITES_START_LITTER, uint16); litterIndex != 0xFFFF; litterIndex = litter->next){
-		litter = &g_sprite_list[litterIndex].litter;
-		
-		uint16 distance = 
-			abs(litter->x - peep->x) + 
-			abs(litter->y - peep->y) + 
-			abs(litter->z - peep->z) * 4;
-	
-		if (distance < nearestLitterDist){
-			nearestLitterDist = distance;
-			nearestLitter = litter;
+	bool tied = false;
+
+	int left = max(0, peep->x - 0x60) >> 5;
+	int top = max(0, peep->y - 0x60) >> 5;
+	int right = min(255, (peep->x + 0x60) >> 5);
+	int bottom = min(255, (peep->y + 0x60) >> 5);
+	for (int tileX = left; tileX <= right; tileX++){
+		for (int tileY = top; tileY <= bottom; tileY++){
+			uint16 spriteIndex = sprite_get_first_in_quadrant(tileX * 32, tileY * 32);
+			while (spriteIndex != SPRITE_INDEX_NULL){
+				rct_sprite* sprite = &g_sprite_list[spriteIndex];
+				spriteIndex = sprite->unknown.next_in_quadrant;
+				if (sprite->unknown.linked_list_type_offset != SPRITE_LINKEDLIST_OFFSET_LITTER)
+					continue;
+
+				uint16 distance = staff_handyman_litter_distance(peep, &sprite->litter);
+				if (distance < nearestLitterDist){
+					nearestLitterDist = distance;
+					nearestLitter = &sprite->litter;
+					tied = false;
+				} else if (distance == nearestLitterDist && nearestLitter != NULL){
+					tied = true;
+				}
+			}
 		}
 	}
-	
-	if (nearestLitterDist > 0x60){
+
+	// Equally near litter is picked by its order in the litter list, same as the original search.
+	// Litter piled up on one spot ties often, and the list then has to be walked up to the first
+	// tied litter. Sprite indices are reused, so they can not stand in for the list order.
+	if (tied){
+		rct_litter* litter;
+		for (uint16 litterIndex = RCT2_GLOBAL(RCT2_ADDRESS_SPRITES_START_LITTER, uint16); litterIndex != SPRITE_INDEX_NULL; litterIndex = litter->next){
+			litter = &g_sprite_list[litterIndex].litter;
+			if (staff_handyman_litter_distance(peep, litter) == nearestLitterDist){
+				return litter;
+			}
+		}
+	}
+	return nearestLitter;
+}
+
+static uint8 staff_handyman_direction_to_nearest_litter(rct_peep* peep){
+	rct_litter* nearestLitter = staff_handyman_find_nearest_litter(peep);
+	if (nearestLitter == NULL){
 		return 0xFF;
 	}
 	
@@ -474,6 +474,49 @@ bool platform_file_delete(const utf8 *path)
 	return success == TRUE;
 }
 
+/**
+ * Maps a whole file into memory. The mapping is copy on write, so writes to it are never carried through to the file.
+ * Returns NULL if the file can not be mapped, in which case the caller should read it normally.
+ */
+void *platform_file_map(const utf8 *path, size_t *outSize)
+{
+	wchar_t *wPath = utf8_to_widechar(path);
+	HANDLE hFile = CreateFileW(wPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	free(wPath);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return NULL;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart <= 0 || (uint64)fileSize.QuadPart > SIZE_MAX) {
+		CloseHandle(hFile);
+		return NULL;
+	}
+
+	HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	CloseHandle(hFile);
+	if (hMapping == NULL) {
+		log_verbose("Unable to map %s, error = %lu", path, GetLastError());
+		return NULL;
+	}
+
+	// The view keeps the mapping alive until it is unmapped
+	void *data = MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+	CloseHandle(hMapping);
+	if (data == NULL) {
+		log_verbose("Unable to map %s, error = %lu", path, GetLastError());
+		return NULL;
+	}
+
+	*outSize = (size_t)fileSize.QuadPart;
+	return data;
+}
+
+void platform_file_unmap(void *data, size_t size)
+{
+	UnmapViewOfFile(data);
+}
+
 void platform_resolve_openrct_data_path()
 {
 	wchar_t wOutPath[MAX_PATH];
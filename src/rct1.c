@@ -724,6 +724,7 @@ static void rct1_fix_z()
 	for (int i = 0; i < RCT2_GLOBAL(0x0138B580, uint16); i++) {
 		gAnimatedObjects[i].baseZ /= 2;
 	}
+	map_animation_mark_loaded();
 
 	for (int i = 0; i < MAX_SPRITES; i++) {
 		sprite = &(g_sprite_list[i].unknown);
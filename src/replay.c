@@ -0,0 +1,474 @@
+#include "addresses.h"
+#include "game.h"
+#include "openrct2.h"
+#include "peep/peep.h"
+#include "platform/platform.h"
+#include "replay.h"
+#include "scenario.h"
+#include "state_hash.h"
+#include "world/park.h"
+#include "world/sprite.h"
+
+#define REPLAY_MAGIC 0x4C505252 // RRPL
+#define REPLAY_VERSION 2
+
+/**
+ * A replay file starts with a header of three uint32s: magic, version and the length of the
+ * snapshot that follows. The snapshot is the same format that is sent to clients joining a
+ * network game. It is followed by a stream of records, each prefixed by a uint8 record type.
+ * Batch commands are followed by a uint16 count and their sub-commands.
+ */
+enum {
+	REPLAY_RECORD_COMMAND,
+	REPLAY_RECORD_CHECKPOINT,
+	REPLAY_RECORD_END
+};
+
+enum {
+	REPLAY_MODE_NONE,
+	REPLAY_MODE_RECORDING,
+	REPLAY_MODE_PLAYING
+};
+
+typedef struct {
+	uint32 tick;
+	sint32 eax;
+	sint32 ebx;
+	sint32 ecx;
+	sint32 edx;
+	sint32 esi;
+	sint32 edi;
+	sint32 ebp;
+	sint32 player_id;
+} rct_replay_command;
+
+// State collected at each checkpoint by the determinism check
+typedef struct {
+	rct_state_hash state;
+	uint32 assessment_hash;
+	uint32 assessment_count;
+} replay_determinism_checkpoint;
+
+static uint8 _replayMode = REPLAY_MODE_NONE;
+static SDL_RWops *_replayFile = NULL;
+
+// Playback state
+static uint8 _replayNextRecordType;
+static rct_replay_command _replayNextCommand;
+static rct_game_command_batch _replayNextBatch;
+static rct_state_hash _replayNextCheckpoint;
+static bool _replayReachedEnd;
+static uint32 _replayCommandCount;
+static uint32 _replayCheckpointCount;
+static uint32 _replayMismatchCount;
+
+// When set, the state hash at each checkpoint is collected instead of being checked against the recording
+static bool _replayCollectHashes;
+static replay_determinism_checkpoint *_replayHashes;
+static uint32 _replayHashCount;
+static uint32 _replayHashCapacity;
+
+static void replay_write_state_hash(uint8 recordType)
+{
+	rct_state_hash hash;
+	state_hash_compute(&hash);
+	SDL_RWwrite(_replayFile, &recordType, sizeof(recordType), 1);
+	SDL_RWwrite(_replayFile, &hash, sizeof(hash), 1);
+}
+
+bool replay_start_recording(const utf8 *path)
+{
+	if (_replayMode != REPLAY_MODE_NONE) {
+		log_error("A replay is already being recorded or played back.");
+		return false;
+	}
+	if (RCT2_GLOBAL(RCT2_ADDRESS_SCREEN_FLAGS, uint8) != SCREEN_FLAGS_PLAYING) {
+		log_error("Replays can only be recorded while playing a park.");
+		return false;
+	}
+
+	SDL_RWops *rw = SDL_RWFromFile(path, "wb");
+	if (rw == NULL) {
+		log_error("Unable to write replay to '%s'", path);
+		return false;
+	}
+
+	// Write the snapshot first and fill in its length once it is known
+	uint32 header[] = { REPLAY_MAGIC, REPLAY_VERSION, 0 };
+	SDL_RWwrite(rw, header, sizeof(header), 1);
+	sint64 snapshotStart = SDL_RWtell(rw);
+	scenario_save_network(rw);
+	sint64 snapshotEnd = SDL_RWtell(rw);
+	header[2] = (uint32)(snapshotEnd - snapshotStart);
+	SDL_RWseek(rw, 0, RW_SEEK_SET);
+	SDL_RWwrite(rw, header, sizeof(header), 1);
+	SDL_RWseek(rw, snapshotEnd, RW_SEEK_SET);
+
+	_replayFile = rw;
+	_replayMode = REPLAY_MODE_RECORDING;
+	log_verbose("Recording replay to '%s' from tick %u", path, RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32));
+	return true;
+}
+
+void replay_stop_recording()
+{
+	if (_replayMode != REPLAY_MODE_RECORDING) {
+		return;
+	}
+
+	// The final state lets the replayer verify the whole session even if it was short
+	replay_write_state_hash(REPLAY_RECORD_END);
+	SDL_RWclose(_replayFile);
+	_replayFile = NULL;
+	_replayMode = REPLAY_MODE_NONE;
+}
+
+bool replay_is_recording()
+{
+	return _replayMode == REPLAY_MODE_RECORDING;
+}
+
+/**
+ * Called by game_do_command_p for every top level command just before it is applied. The
+ * registers are the ones that would be sent over the network so the command is replayed exactly
+ * as a client would run it.
+ */
+void replay_record_command(int eax, int ebx, int ecx, int edx, int esi, int edi, int ebp, int playerId)
+{
+	if (_replayMode != REPLAY_MODE_RECORDING) {
+		return;
+	}
+
+	uint8 recordType = REPLAY_RECORD_COMMAND;
+	rct_replay_command command;
+	command.tick = RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32);
+	command.eax = eax;
+	command.ebx = ebx | GAME_COMMAND_FLAG_NETWORKED;
+	command.ecx = ecx;
+	command.edx = edx;
+	command.esi = esi;
+	command.edi = edi;
+	command.ebp = ebp;
+	command.player_id = playerId;
+	SDL_RWwrite(_replayFile, &recordType, sizeof(recordType), 1);
+	SDL_RWwrite(_replayFile, &command, sizeof(command), 1);
+	if (esi == GAME_COMMAND_BATCH) {
+		SDL_RWwrite(_replayFile, &gGameCommandBatch.count, sizeof(uint16), 1);
+		SDL_RWwrite(_replayFile, gGameCommandBatch.entries, sizeof(rct_game_command_batch_entry), gGameCommandBatch.count);
+	}
+}
+
+static void replay_read_next_record()
+{
+	uint8 recordType;
+	if (SDL_RWread(_replayFile, &recordType, sizeof(recordType), 1) != 1) {
+		log_warning("Replay ended without a final state, it may be truncated.");
+		replay_stop_playback();
+		return;
+	}
+
+	bool valid;
+	switch (recordType) {
+	case REPLAY_RECORD_COMMAND:
+		valid = SDL_RWread(_replayFile, &_replayNextCommand, sizeof(rct_replay_command), 1) == 1;
+		if (valid && _replayNextCommand.esi == GAME_COMMAND_BATCH) {
+			valid =
+				SDL_RWread(_replayFile, &_replayNextBatch.count, sizeof(uint16), 1) == 1 &&
+				_replayNextBatch.count <= GAME_COMMAND_BATCH_MAX_SIZE &&
+				SDL_RWread(_replayFile, _replayNextBatch.entries, sizeof(rct_game_command_batch_entry), _replayNextBatch.count) == _replayNextBatch.count;
+		}
+		break;
+	case REPLAY_RECORD_CHECKPOINT:
+	case REPLAY_RECORD_END:
+		valid = SDL_RWread(_replayFile, &_replayNextCheckpoint, sizeof(rct_state_hash), 1) == 1;
+		break;
+	default:
+		valid = false;
+		break;
+	}
+
+	if (!valid) {
+		log_error("Replay contains an invalid record.");
+		replay_stop_playback();
+		return;
+	}
+	_replayNextRecordType = recordType;
+}
+
+bool replay_start_playback(const utf8 *path)
+{
+	if (_replayMode != REPLAY_MODE_NONE) {
+		log_error("A replay is already being recorded or played back.");
+		return false;
+	}
+
+	SDL_RWops *rw = SDL_RWFromFile(path, "rb");
+	if (rw == NULL) {
+		log_error("Unable to open replay '%s'", path);
+		return false;
+	}
+
+	uint32 header[3];
+	if (SDL_RWread(rw, header, sizeof(header), 1) != 1 || header[0] != REPLAY_MAGIC || header[1] != REPLAY_VERSION) {
+		log_error("'%s' is not a valid replay", path);
+		SDL_RWclose(rw);
+		return false;
+	}
+
+	sint64 snapshotStart = SDL_RWtell(rw);
+	if (!game_load_network(rw)) {
+		log_error("Unable to load the park stored in '%s'", path);
+		SDL_RWclose(rw);
+		return false;
+	}
+	game_load_init();
+	SDL_RWseek(rw, snapshotStart + header[2], RW_SEEK_SET);
+
+	_replayFile = rw;
+	_replayMode = REPLAY_MODE_PLAYING;
+	_replayReachedEnd = false;
+	_replayCommandCount = 0;
+	_replayCheckpointCount = 0;
+	_replayMismatchCount = 0;
+	replay_read_next_record();
+	return true;
+}
+
+void replay_stop_playback()
+{
+	if (_replayMode != REPLAY_MODE_PLAYING) {
+		return;
+	}
+
+	SDL_RWclose(_replayFile);
+	_replayFile = NULL;
+	_replayMode = REPLAY_MODE_NONE;
+}
+
+bool replay_is_playing()
+{
+	return _replayMode == REPLAY_MODE_PLAYING;
+}
+
+static void replay_execute_command(const rct_replay_command *command)
+{
+	int eax = command->eax;
+	int ebx = command->ebx;
+	int ecx = command->ecx;
+	int edx = command->edx;
+	int esi = command->esi;
+	int edi = command->edi;
+	int ebp = command->ebp;
+
+	if (command->esi == GAME_COMMAND_BATCH) {
+		gGameCommandBatch = _replayNextBatch;
+	}
+
+	game_command_callback = 0;
+	game_command_playerid = command->player_id;
+	game_do_command_p(esi, &eax, &ebx, &ecx, &edx, &esi, &edi, &ebp);
+	_replayCommandCount++;
+}
+
+static void replay_verify_checkpoint(const rct_state_hash *expected)
+{
+	rct_state_hash actual;
+	state_hash_compute(&actual);
+	_replayCheckpointCount++;
+
+	if (_replayCollectHashes) {
+		if (_replayHashCount == _replayHashCapacity) {
+			_replayHashCapacity = max(_replayHashCapacity * 2, 64);
+			_replayHashes = realloc(_replayHashes, _replayHashCapacity * sizeof(replay_determinism_checkpoint));
+		}
+		replay_determinism_checkpoint *checkpoint = &_replayHashes[_replayHashCount++];
+		checkpoint->state = actual;
+
+		// A tick only has a guest or two due to assess their surroundings, so every guest is assessed here to run
+		// enough assessments at once to spread them over the threads
+		uint8 thoughts[MAX_SPRITES];
+		int count = peep_assess_all_surroundings(thoughts, countof(thoughts));
+		uint32 hash = 0x811C9DC5;
+		for (int i = 0; i < count; i++) {
+			hash = (hash ^ thoughts[i]) * 0x01000193;
+		}
+		checkpoint->assessment_hash = hash;
+		checkpoint->assessment_count = count;
+		return;
+	}
+
+	int category, bucket;
+	if (state_hash_find_divergence(expected, &actual, &category, &bucket)) {
+		int first, last;
+		state_hash_get_bucket_range(category, bucket, &first, &last);
+		log_warning("Replay diverged at tick %u in %s %d to %d", actual.tick, state_hash_category_name(category), first, last);
+		_replayMismatchCount++;
+	}
+}
+
+/**
+ * Runs every recorded command for the given tick and verifies the checkpoint for it. This mirrors
+ * Network::ProcessGameCommandQueue so commands run at the same point in the tick as on clients.
+ */
+static void replay_play_tick(uint32 tick)
+{
+	while (_replayMode == REPLAY_MODE_PLAYING) {
+		if (_replayNextRecordType == REPLAY_RECORD_COMMAND) {
+			if (_replayNextCommand.tick > tick) {
+				break;
+			}
+			replay_execute_command(&_replayNextCommand);
+		} else {
+			if (_replayNextCheckpoint.tick > tick) {
+				break;
+			}
+			replay_verify_checkpoint(&_replayNextCheckpoint);
+			if (_replayNextRecordType == REPLAY_RECORD_END) {
+				_replayReachedEnd = true;
+				replay_stop_playback();
+				break;
+			}
+		}
+		replay_read_next_record();
+	}
+}
+
+/**
+ * Called from game_logic_update before the tick counter is incremented, which is the same point
+ * clients run queued network commands.
+ */
+void replay_update()
+{
+	uint32 tick = RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32);
+	switch (_replayMode) {
+	case REPLAY_MODE_RECORDING:
+		if (tick % REPLAY_CHECKPOINT_INTERVAL == 0) {
+			replay_write_state_hash(REPLAY_RECORD_CHECKPOINT);
+		}
+		break;
+	case REPLAY_MODE_PLAYING:
+		replay_play_tick(tick);
+		break;
+	}
+}
+
+/**
+ * Ticks the game until the replay that is being played back ends.
+ */
+static void replay_play_to_end()
+{
+	while (replay_is_playing()) {
+		if (RCT2_GLOBAL(RCT2_ADDRESS_GAME_PAUSED, uint8) != 0) {
+			// The game does not tick while paused so only the commands for the current tick can run,
+			// one of which should unpause the game again
+			uint32 commandCount = _replayCommandCount;
+			replay_update();
+			if (_replayCommandCount == commandCount && RCT2_GLOBAL(RCT2_ADDRESS_GAME_PAUSED, uint8) != 0) {
+				log_warning("Replay stalled while the game is paused.");
+				replay_stop_playback();
+			}
+			continue;
+		}
+		game_logic_update();
+	}
+}
+
+int cmdline_for_replay(const utf8 *path)
+{
+	gOpenRCT2Headless = true;
+	if (!openrct2_initialise()) {
+		return -1;
+	}
+	if (!replay_start_playback(path)) {
+		openrct2_dispose();
+		return -1;
+	}
+
+	uint32 startTick = RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32);
+	uint32 startTime = SDL_GetTicks();
+	replay_play_to_end();
+	uint32 elapsed = SDL_GetTicks() - startTime;
+	uint32 ticks = RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32) - startTick;
+
+	printf("Replayed %u ticks and %u commands in %u ms", ticks, _replayCommandCount, elapsed);
+	if (elapsed != 0) {
+		printf(" (%u ticks per second)", (uint32)((uint64)ticks * 1000 / elapsed));
+	}
+	printf("\n");
+	printf("%u of %u checkpoints matched\n", _replayCheckpointCount - _replayMismatchCount, _replayCheckpointCount);
+
+	openrct2_dispose();
+	return (_replayReachedEnd && _replayMismatchCount == 0) ? 1 : -1;
+}
+
+/**
+ * Plays the replay with the park's entity random streams on, once with the parallel parts of the tick on one thread
+ * and once on the given number of threads, and compares the state hashes of the two runs at every checkpoint. The
+ * runs are only compared with each other, so the streams can be switched on for parks recorded without them. At
+ * each checkpoint every guest also assesses its surroundings in one batch, and the results are compared too.
+ */
+int cmdline_for_replay_determinism(const utf8 *path, int threads)
+{
+	gOpenRCT2Headless = true;
+	if (!openrct2_initialise()) {
+		return -1;
+	}
+
+	int threadCounts[2] = { 1, threads };
+	replay_determinism_checkpoint *hashes[2] = { NULL, NULL };
+	uint32 hashCounts[2] = { 0, 0 };
+	bool loaded = true;
+
+	_replayCollectHashes = true;
+	for (int run = 0; run < 2; run++) {
+		gGameUpdateThreads = threadCounts[run];
+		if (!replay_start_playback(path)) {
+			loaded = false;
+			break;
+		}
+		RCT2_GLOBAL(RCT2_ADDRESS_PARK_FLAGS, uint32) |= PARK_FLAGS_ENTITY_RANDOM_STREAMS;
+		replay_play_to_end();
+
+		hashes[run] = _replayHashes;
+		hashCounts[run] = _replayHashCount;
+		_replayHashes = NULL;
+		_replayHashCount = 0;
+		_replayHashCapacity = 0;
+	}
+	_replayCollectHashes = false;
+	gGameUpdateThreads = 0;
+
+	uint32 matched = 0;
+	uint32 count = min(hashCounts[0], hashCounts[1]);
+	uint32 assessments = 0;
+	if (loaded) {
+		for (; matched < count; matched++) {
+			replay_determinism_checkpoint *a = &hashes[0][matched];
+			replay_determinism_checkpoint *b = &hashes[1][matched];
+			int category, bucket;
+			if (state_hash_find_divergence(&a->state, &b->state, &category, &bucket)) {
+				int first, last;
+				state_hash_get_bucket_range(category, bucket, &first, &last);
+				printf("1 and %d threads diverged at tick %u in %s %d to %d\n", threads, b->state.tick, state_hash_category_name(category), first, last);
+				break;
+			}
+			if (a->assessment_count != b->assessment_count || a->assessment_hash != b->assessment_hash) {
+				printf("1 and %d threads assessed guest surroundings differently at tick %u\n", threads, b->state.tick);
+				break;
+			}
+			assessments += a->assessment_count;
+		}
+		if (hashCounts[0] != hashCounts[1]) {
+			printf("1 thread reached %u checkpoints but %d threads reached %u\n", hashCounts[0], threads, hashCounts[1]);
+		}
+		printf("%u of %u checkpoints matched between 1 and %d threads, %u guest assessments compared\n", matched, hashCounts[0], threads, assessments);
+		if (assessments == 0) {
+			printf("No guests were assessed, the replay needs a park with guests to check the threaded assessments\n");
+		}
+	}
+
+	free(hashes[0]);
+	free(hashes[1]);
+	openrct2_dispose();
+	return (loaded && matched == hashCounts[0] && hashCounts[0] == hashCounts[1] && assessments != 0) ? 1 : -1;
+}
@@ -0,0 +1,23 @@
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+#include "common.h"
+
+// Number of ticks between state hash checkpoints written to a recording
+#define REPLAY_CHECKPOINT_INTERVAL 400
+
+bool replay_start_recording(const utf8 *path);
+void replay_stop_recording();
+bool replay_is_recording();
+void replay_record_command(int eax, int ebx, int ecx, int edx, int esi, int edi, int ebp, int playerId);
+
+bool replay_start_playback(const utf8 *path);
+void replay_stop_playback();
+bool replay_is_playing();
+
+void replay_update();
+
+int cmdline_for_replay(const utf8 *path);
+int cmdline_for_replay_determinism(const utf8 *path, int threads);
+
+#endif
@@ -49,6 +49,7 @@
 #include "cable_lift.h"
 #include "ride.h"
 #include "ride_data.h"
+#include "ride_ratings.h"
 #include "track.h"
 #include "track_data.h"
 #include "station.h"
@@ -846,6 +847,7 @@ void ride_init_all()
 
 	RCT2_GLOBAL(0x0138B590, sint8) = 0;
 	RCT2_GLOBAL(0x0138B591, sint8) = 0;
+	ride_ratings_invalidate_proximity_cache();
 
 	for (i = 0; i < MAX_RIDE_MEASUREMENTS; i++) {
 		ride_measurement = get_ride_measurement(i);
@@ -1887,8 +1889,11 @@ void ride_update_all()
 	window_update_viewport_ride_music();
 
 	// Update rides
-	FOR_ALL_RIDES(i, ride)
+	FOR_ALL_RIDES(i, ride) {
+		scenario_rand_begin_stream(RAND_STREAM_RIDE, i);
 		ride_update(i);
+		scenario_rand_end_stream();
+	}
 
 	ride_music_update_final();
 }
@@ -2543,6 +2548,7 @@ rct_peep *find_closest_mechanic(int x, int y, int forInspection)
 	unsigned int closestDistance, distance;
 	uint16 spriteIndex;
 	rct_peep *peep, *closestMechanic = NULL;
+	int checkPatrol = -1;
 
 	closestDistance = UINT_MAX;
 	FOR_ALL_STAFF(spriteIndex, peep) {
@@ -2564,19 +2570,22 @@ rct_peep *find_closest_mechanic(int x, int y, int forInspection)
 				continue;
 		}
 
-		if (map_is_location_in_park(x, y))
-			if (!staff_is_location_in_patrol(peep, x & 0xFFE0, y & 0xFFE0))
-				continue;
-
 		if (peep->x == (sint16)0x8000)
 			continue;
 
-		// manhattan distance
+		// manhattan distance, checked before the patrol area as most mechanics are further away
 		distance = abs(peep->x - x) + abs(peep->y - y);
-		if (distance < closestDistance) {
-			closestDistance = distance;
-			closestMechanic = peep;
-		}
+		if (distance >= closestDistance)
+			continue;
+
+		// Only looked up once needed as it sets the error text when outside the park
+		if (checkPatrol == -1)
+			checkPatrol = map_is_location_in_park(x, y);
+		if (checkPatrol && !staff_is_location_in_patrol(peep, x & 0xFFE0, y & 0xFFE0))
+			continue;
+
+		closestDistance = distance;
+		closestMechanic = peep;
 	}
 
 	return closestMechanic;
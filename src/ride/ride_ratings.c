@@ -81,6 +81,30 @@ typedef void (*ride_ratings_calculation)(rct_ride *ride);
 
 static uint16 *_proximityScores = (uint16*)0x0138B596;
 
+// The most track pieces walked in one tick, rides longer than this carry on walking next tick
+#define RIDE_RATINGS_MAX_STEPS_PER_TICK		1024
+
+// The proximity walk state from 0x0138B584 to 0x0138B5D0
+#define RIDE_RATINGS_WALK_STATE				((uint8*)0x0138B584)
+#define RIDE_RATINGS_WALK_STATE_SIZE		0x4C
+#define RIDE_RATINGS_WALK_BASE_HEIGHT_OFFSET	(0x0138B593 - 0x0138B584)
+
+/**
+ * The outcome of a ride's last completed proximity walk. The walk only depends on the map and the
+ * ride's stations, so it can be reused until the map is edited.
+ */
+typedef struct {
+	uint32 map_edit_stamp;
+	uint8 valid;
+	uint8 base_height_set;
+	uint8 walk_state[RIDE_RATINGS_WALK_STATE_SIZE];
+} rct_ride_ratings_proximity_cache;
+
+static rct_ride_ratings_proximity_cache _proximityCache[MAX_RIDES];
+static uint32 _proximityCacheMapEditStamp;
+static uint32 _rideRatingsWalkMapEditStamp;
+static bool _rideRatingsWalkBaseHeightSet;
+
 static const ride_ratings_calculation ride_ratings_calculate_func_table[91];
 
 static void ride_ratings_update_state_0();
@@ -93,16 +117,43 @@ static void ride_ratings_begin_proximity_loop();
 static void ride_ratings_calculate(rct_ride *ride);
 static void ride_ratings_calculate_value(rct_ride *ride);
 static void ride_ratings_score_close_proximity(rct_map_element *mapElement);
+static void ride_ratings_update_state();
 
 /**
- *
+ * Picks the next ride and rates it in full within the tick, rather than advancing one track piece
+ * per tick. The walk over the ride's track is skipped when the map has not been edited since it was
+ * last done for that ride.
  *  rct2: 0x006B5A2A
  */
 void ride_ratings_update_all()
 {
+	int steps;
+
 	if (RCT2_GLOBAL(RCT2_ADDRESS_SCREEN_FLAGS, uint8) & SCREEN_FLAGS_SCENARIO_EDITOR)
 		return;
 
+	if (_rideRatingsState == RIDE_RATINGS_STATE_FIND_NEXT_RIDE)
+		ride_ratings_update_state_0();
+
+	for (steps = 0; steps < RIDE_RATINGS_MAX_STEPS_PER_TICK; steps++) {
+		if (_rideRatingsState == RIDE_RATINGS_STATE_FIND_NEXT_RIDE)
+			break;
+
+		ride_ratings_update_state();
+	}
+}
+
+/**
+ * Marks every ride's cached proximity walk as out of date. Must be called whenever a map element is
+ * added, removed or changed, otherwise ratings would differ from a client without the cache.
+ */
+void ride_ratings_invalidate_proximity_cache()
+{
+	_proximityCacheMapEditStamp++;
+}
+
+static void ride_ratings_update_state()
+{
 	switch (_rideRatingsState) {
 	case RIDE_RATINGS_STATE_FIND_NEXT_RIDE:
 		ride_ratings_update_state_0();
@@ -148,6 +199,21 @@ static void ride_ratings_update_state_0()
  */
 static void ride_ratings_update_state_1()
 {
+	rct_ride_ratings_proximity_cache *cache;
+
+	cache = &_proximityCache[_rideRatingsCurrentRide];
+	if (cache->valid && cache->map_edit_stamp == _proximityCacheMapEditStamp) {
+		// Restore exactly what walking the ride again would leave behind
+		uint8 baseHeight = _rideRatingsProximityBaseHeight;
+		memcpy(RIDE_RATINGS_WALK_STATE, cache->walk_state, RIDE_RATINGS_WALK_STATE_SIZE);
+		if (!cache->base_height_set)
+			_rideRatingsProximityBaseHeight = baseHeight;
+		return;
+	}
+
+	_rideRatingsWalkMapEditStamp = _proximityCacheMapEditStamp;
+	_rideRatingsWalkBaseHeightSet = false;
+
 	_rideRatingsProximityTotal = 0;
 	for (int i = 0; i < PROXIMITY_COUNT; i++) {
 		_proximityScores[i] = 0;
@@ -239,6 +305,17 @@ static void ride_ratings_update_state_3()
 		return;
 	}
 
+	// Maze rides have no walk, which leaves the positions from the previous ride in place
+	if (ride->type != RIDE_TYPE_MAZE) {
+		rct_ride_ratings_proximity_cache *cache = &_proximityCache[_rideRatingsCurrentRide];
+		if (!cache->valid || cache->map_edit_stamp != _proximityCacheMapEditStamp) {
+			cache->valid = 1;
+			cache->map_edit_stamp = _rideRatingsWalkMapEditStamp;
+			cache->base_height_set = _rideRatingsWalkBaseHeightSet;
+			memcpy(cache->walk_state, RIDE_RATINGS_WALK_STATE, RIDE_RATINGS_WALK_STATE_SIZE);
+		}
+	}
+
 	ride_ratings_calculate(ride);
 	ride_ratings_calculate_value(ride);
 
@@ -488,6 +565,7 @@ static void ride_ratings_score_close_proximity(rct_map_element *inputMapElement)
 		switch (map_element_get_type(mapElement)) {
 		case MAP_ELEMENT_TYPE_SURFACE:
 			_rideRatingsProximityBaseHeight = mapElement->base_height;
+			_rideRatingsWalkBaseHeightSet = true;
 			if (mapElement->base_height * 8 == _rideRatingsProximityZ) {
 				proximity_score_increment(PROXIMITY_SURFACE_TOUCH);
 			}
@@ -25,5 +25,6 @@
 #include "ride.h"
 
 void ride_ratings_update_all();
+void ride_ratings_invalidate_proximity_cache();
 
 #endif
@@ -31,6 +31,7 @@
 #include "../rct1.h"
 #include "../util/sawyercoding.h"
 #include "../util/util.h"
+#include "../version.h"
 #include "../world/map_animation.h"
 #include "../world/park.h"
 #include "../world/scenery.h"
@@ -2097,16 +2098,218 @@ void sub_6D235B(uint8 ride_id){
 	ride->type = RIDE_TYPE_NULL;
 }
 
+#define TRACK_PREVIEW_CACHE_MAGIC 0x56455250 // PREV
+#define TRACK_PREVIEW_CACHE_VERSION 1
+#define TRACK_PREVIEW_CACHE_MAX_SIZE (32 * 1024 * 1024)
+
+// Identifies the build that rendered a preview, as any change to track painting changes the previews
+static const char TrackPreviewCacheBuild[] = OPENRCT2_VERSION " " OPENRCT2_COMMIT_SHA1 " " OPENRCT2_TIMESTAMP;
+
+typedef struct {
+	utf8 name[32];
+	uint64 size;
+	uint64 last_modified;
+} track_preview_cache_file;
+
+static uint64 track_preview_hash(uint64 hash, const void *data, size_t length)
+{
+	const uint8 *bytes = (const uint8*)data;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
 /**
- *
- *  rct2: 0x006D1EF0
+ * Gets a key for the preview of the loaded track design. It covers the design data itself (after any mirroring) and
+ * everything outside of it that changes what sub_6D2189 places or costs: which of the design's objects are loaded,
+ * whether scenery is placed and whether the park uses money. It also covers the build, so previews are rendered again
+ * by a build that may paint track differently.
  */
-void draw_track_preview(uint8** preview){
-	// Make a copy of the map
-	if (!backup_map())return;
+static uint64 track_preview_get_cache_key()
+{
+	rct_track_td6* track_design = RCT2_ADDRESS(0x009D8178, rct_track_td6);
+	uint8* track_elements = RCT2_ADDRESS(0x9D821B, uint8);
+	uint8 entry_type, entry_index;
 
-	blank_map();
+	uint64 hash = track_preview_hash(0xCBF29CE484222325ULL, TrackPreviewCacheBuild, sizeof(TrackPreviewCacheBuild));
+	hash = track_preview_hash(hash, track_design, sizeof(rct_track_td6));
+
+	uint8* scenery_elements = track_elements;
+	if (track_design->type == RIDE_TYPE_MAZE){
+		while (*(uint32*)scenery_elements != 0) scenery_elements += sizeof(rct_maze_element);
+		scenery_elements += sizeof(rct_maze_element);
+	}
+	else{
+		while (*scenery_elements != 255) scenery_elements += sizeof(rct_track_element);
+		scenery_elements++;
+		while (*scenery_elements != 255) scenery_elements += sizeof(rct_track_entrance);
+		scenery_elements++;
+	}
+	hash = track_preview_hash(hash, track_elements, scenery_elements - track_elements);
+
+	uint8 objectLoaded = find_object_in_entry_group(&track_design->vehicle_object, &entry_type, &entry_index);
+	hash = track_preview_hash(hash, &objectLoaded, 1);
+
+	while (*scenery_elements != 255){
+		rct_track_scenery* scenery_entry = (rct_track_scenery*)scenery_elements;
+		hash = track_preview_hash(hash, scenery_entry, sizeof(rct_track_scenery));
+
+		objectLoaded = find_object_in_entry_group(&scenery_entry->scenery_object, &entry_type, &entry_index);
+		hash = track_preview_hash(hash, &objectLoaded, 1);
+		scenery_elements += sizeof(rct_track_scenery);
+	}
+
+	uint8 settings[2];
+	settings[0] = RCT2_GLOBAL(RCT2_ADDRESS_TRACK_DESIGN_SCENERY_TOGGLE, uint8);
+	settings[1] = (RCT2_GLOBAL(RCT2_ADDRESS_PARK_FLAGS, uint32) & PARK_FLAGS_NO_MONEY) != 0;
+	return track_preview_hash(hash, settings, sizeof(settings));
+}
+
+static void track_preview_cache_get_path(utf8 *outPath, uint64 key)
+{
+	char fileName[32];
+
+	platform_get_user_directory(outPath, "track previews");
+	sprintf(fileName, "%08X%08X.dat", (uint32)(key >> 32), (uint32)key);
+	strcat(outPath, fileName);
+}
+
+/**
+ * Loads all four rotations of a preview, plus the cost and flags placing the design gave, from the preview cache.
+ */
+static bool track_preview_cache_load(uint64 key, uint8 *preview, money32 *cost, uint8 *flags)
+{
+	utf8 path[MAX_PATH];
+	SDL_RWops *file;
+	uint32 magic, version;
+	uint64 fileKey;
+
+	track_preview_cache_get_path(path, key);
+	if (!platform_file_exists(path))
+		return false;
+
+	file = SDL_RWFromFile(path, "rb");
+	if (file == NULL)
+		return false;
+
+	bool success =
+		SDL_RWread(file, &magic, sizeof(magic), 1) == 1 && magic == TRACK_PREVIEW_CACHE_MAGIC &&
+		SDL_RWread(file, &version, sizeof(version), 1) == 1 && version == TRACK_PREVIEW_CACHE_VERSION &&
+		SDL_RWread(file, &fileKey, sizeof(fileKey), 1) == 1 && fileKey == key &&
+		SDL_RWread(file, cost, sizeof(money32), 1) == 1 &&
+		SDL_RWread(file, flags, sizeof(uint8), 1) == 1 &&
+		sawyercoding_read_chunk(file, preview) == TRACK_PREVIEW_IMAGE_SIZE * 4;
+	SDL_RWclose(file);
+
+	if (!success)
+		log_warning("Ignoring invalid track preview cache file %s", path);
+	return success;
+}
 
+static int track_preview_cache_compare_age(const void *a, const void *b)
+{
+	const track_preview_cache_file *fileA = (const track_preview_cache_file*)a;
+	const track_preview_cache_file *fileB = (const track_preview_cache_file*)b;
+	if (fileA->last_modified != fileB->last_modified)
+		return fileA->last_modified < fileB->last_modified ? -1 : 1;
+	return strcmp(fileA->name, fileB->name);
+}
+
+/**
+ * Deletes the oldest previews until the cache is no larger than TRACK_PREVIEW_CACHE_MAX_SIZE. Previews rendered by
+ * other builds are never loaded again, so this is also what removes them.
+ */
+static void track_preview_cache_prune()
+{
+	utf8 pattern[MAX_PATH];
+	file_info fileInfo;
+	track_preview_cache_file *files = NULL;
+	int numFiles = 0, capacity = 0;
+	uint64 totalSize = 0;
+
+	platform_get_user_directory(pattern, "track previews");
+	strcat(pattern, "*.dat");
+	int handle = platform_enumerate_files_begin(pattern);
+	while (platform_enumerate_files_next(handle, &fileInfo)) {
+		if (numFiles == capacity) {
+			capacity = max(capacity * 2, 64);
+			track_preview_cache_file *newFiles = realloc(files, capacity * sizeof(track_preview_cache_file));
+			if (newFiles == NULL)
+				break;
+			files = newFiles;
+		}
+		safe_strcpy(files[numFiles].name, fileInfo.path, sizeof(files[numFiles].name));
+		files[numFiles].size = fileInfo.size;
+		files[numFiles].last_modified = fileInfo.last_modified;
+		totalSize += fileInfo.size;
+		numFiles++;
+	}
+	platform_enumerate_files_end(handle);
+
+	if (totalSize > TRACK_PREVIEW_CACHE_MAX_SIZE) {
+		qsort(files, numFiles, sizeof(track_preview_cache_file), track_preview_cache_compare_age);
+		for (int i = 0; i < numFiles && totalSize > TRACK_PREVIEW_CACHE_MAX_SIZE; i++) {
+			utf8 path[MAX_PATH];
+			platform_get_user_directory(path, "track previews");
+			strcat(path, files[i].name);
+			if (platform_file_delete(path))
+				totalSize -= files[i].size;
+		}
+	}
+	free(files);
+}
+
+static void track_preview_cache_save(uint64 key, uint8 *preview, money32 cost, uint8 flags)
+{
+	utf8 path[MAX_PATH];
+	SDL_RWops *file;
+	uint32 magic = TRACK_PREVIEW_CACHE_MAGIC;
+	uint32 version = TRACK_PREVIEW_CACHE_VERSION;
+
+	platform_get_user_directory(path, "track previews");
+	if (!platform_ensure_directory_exists(path)) {
+		log_error("Unable to create track preview cache directory %s", path);
+		return;
+	}
+
+	// Previews are mostly transparent so run length encoding shrinks them a lot
+	sawyercoding_chunk_header chunkHeader;
+	chunkHeader.encoding = CHUNK_ENCODING_RLE;
+	chunkHeader.length = TRACK_PREVIEW_IMAGE_SIZE * 4;
+	uint8 *chunk = malloc(TRACK_PREVIEW_IMAGE_SIZE * 8);
+	if (chunk == NULL)
+		return;
+	size_t chunkLength = sawyercoding_write_chunk_buffer(chunk, preview, chunkHeader);
+
+	track_preview_cache_get_path(path, key);
+	file = SDL_RWFromFile(path, "wb");
+	if (file == NULL) {
+		log_error("Failed to save %s", path);
+		free(chunk);
+		return;
+	}
+
+	SDL_RWwrite(file, &magic, sizeof(magic), 1);
+	SDL_RWwrite(file, &version, sizeof(version), 1);
+	SDL_RWwrite(file, &key, sizeof(key), 1);
+	SDL_RWwrite(file, &cost, sizeof(cost), 1);
+	SDL_RWwrite(file, &flags, sizeof(flags), 1);
+	SDL_RWwrite(file, chunk, chunkLength, 1);
+	SDL_RWclose(file);
+	free(chunk);
+
+	track_preview_cache_prune();
+}
+
+/**
+ * Renders the four rotations of the loaded track design by placing it on the blanked live map, which is backed up
+ * and restored around the placement. Previews are kept in a cache on disk so this only happens the first time a
+ * design is shown by a build.
+ *  rct2: 0x006D1EF0
+ */
+void draw_track_preview(uint8** preview){
 	if (RCT2_GLOBAL(RCT2_ADDRESS_SCREEN_FLAGS, uint8) & SCREEN_FLAGS_TRACK_MANAGER){
 		load_track_scenery_objects();
 	}
@@ -2114,6 +2317,20 @@ void draw_track_preview(uint8** preview){
 	int cost;
 	uint8 ride_id;
 
+	uint64 cacheKey = track_preview_get_cache_key();
+	money32 cachedCost;
+	uint8 cachedFlags;
+	if (track_preview_cache_load(cacheKey, (uint8*)preview, &cachedCost, &cachedFlags)) {
+		RCT2_GLOBAL(RCT2_ADDRESS_TRACK_DESIGN_COST, money32) = cachedCost;
+		RCT2_GLOBAL(0x00F44151, uint8) = cachedFlags;
+		return;
+	}
+
+	// Make a copy of the map
+	if (!backup_map())return;
+
+	blank_map();
+
 	if (!sub_6D2189(&cost, &ride_id)){
 		memset(preview, 0, TRACK_PREVIEW_IMAGE_SIZE * 4);
 		reload_map_backup();
@@ -2225,6 +2442,8 @@ void draw_track_preview(uint8** preview){
 
 	sub_6D235B(ride_id);
 	reload_map_backup();
+
+	track_preview_cache_save(cacheKey, (uint8*)preview, cost, RCT2_GLOBAL(0x00F44151, uint8));
 }
 
 /**
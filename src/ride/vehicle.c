@@ -635,7 +635,9 @@ void vehicle_update_all()
 		vehicle = &(g_sprite_list[sprite_index].vehicle);
 		sprite_index = vehicle->next;
 
+		scenario_rand_begin_stream(RAND_STREAM_SPRITE, vehicle->sprite_index);
 		vehicle_update(vehicle);
+		scenario_rand_end_stream();
 	}
 }
 
@@ -6501,8 +6503,9 @@ static bool vehicle_update_motion_collision_detection(
 	uint16 collideId = 0xFFFF;
 	rct_vehicle* collideVehicle = NULL;
 	for(; ebp <= RCT2_ADDRESS(0x009A37E4, uint32); ebp++){
-		collideId = RCT2_ADDRESS(0x00F1EF60, uint16)[eax];
-		for(; collideId != 0xFFFF; collideId = collideVehicle->next_in_quadrant){
+		// Only the vehicles in each quadrant are visited, in the same order as the full quadrant list
+		collideId = sprite_get_first_vehicle_in_quadrant(eax);
+		for(; collideId != 0xFFFF; collideId = sprite_get_next_vehicle_in_quadrant(collideId)){
 			collideVehicle = GET_VEHICLE(collideId);
 			if (collideVehicle == vehicle) continue;
 
@@ -36,12 +36,14 @@
 #include "openrct2.h"
 #include "peep/staff.h"
 #include "platform/platform.h"
+#include "replay.h"
 #include "ride/ride.h"
 #include "scenario.h"
 #include "title.h"
 #include "util/sawyercoding.h"
 #include "util/util.h"
 #include "world/map.h"
+#include "world/map_animation.h"
 #include "world/park.h"
 #include "world/scenery.h"
 #include "world/sprite.h"
@@ -181,6 +183,7 @@ int scenario_load(const char *path)
 
 			reset_loaded_objects();
 			map_update_tile_pointers();
+			map_animation_mark_loaded();
 			reset_0x69EBE4();
 			openrct2_reset_object_tween_locations();
 			game_convert_strings_to_utf8();
@@ -234,6 +237,8 @@ void scenario_begin()
 	rct_s6_info *s6Info = (rct_s6_info*)0x0141F570;
 	rct_window *mainWindow;
 
+	replay_stop_recording();
+
 	RCT2_GLOBAL(RCT2_ADDRESS_SCREEN_FLAGS, uint8) = SCREEN_FLAGS_PLAYING;
 	viewport_init_all();
 	game_create_windows();
@@ -314,14 +319,10 @@ void scenario_begin()
 				park_set_name(buffer);
 
 				// Set localised scenario name
-				format_string(buffer, stex->scenario_name, 0);
-				safe_strcpy((char*)RCT2_ADDRESS_SCENARIO_NAME, buffer, 31);
-				((char*)RCT2_ADDRESS_SCENARIO_NAME)[31] = '\0';
+				format_string_bounded((char*)RCT2_ADDRESS_SCENARIO_NAME, 32, stex->scenario_name, 0);
 
 				// Set localised scenario details
-				format_string(buffer, stex->details, 0);
-				safe_strcpy((char*)RCT2_ADDRESS_SCENARIO_DETAILS, buffer, 255);
-				((char*)RCT2_ADDRESS_SCENARIO_DETAILS)[255] = '\0';
+				format_string_bounded((char*)RCT2_ADDRESS_SCENARIO_DETAILS, 256, stex->details, 0);
 			}
 		}
 	}
@@ -682,6 +683,65 @@ static int scenario_create_ducks()
 	return 1;
 }
 
+// Per-entity random streams, see scenario_rand_begin_stream
+static uint32 _randStreamTickSeed;
+static uint32 _randStreamKey;
+static uint32 _randStreamCounter;
+static bool _randStreamActive;
+
+/**
+ * Finalisation mix from MurmurHash3, turns a counter into a well distributed 32-bit value.
+ */
+static uint32 scenario_rand_mix(uint32 x)
+{
+	x ^= x >> 16;
+	x *= 0x85EBCA6B;
+	x ^= x >> 13;
+	x *= 0xC2B2AE35;
+	x ^= x >> 16;
+	return x;
+}
+
+bool scenario_rand_streams_enabled()
+{
+	return (RCT2_GLOBAL(RCT2_ADDRESS_PARK_FLAGS, uint32) & PARK_FLAGS_ENTITY_RANDOM_STREAMS) != 0;
+}
+
+/**
+ * Derives the seed for this tick's per-entity streams. Must be called at the start of the game
+ * tick, before any entity is updated, so every peer derives the same seed.
+ */
+void scenario_rand_begin_tick()
+{
+	_randStreamActive = false;
+	_randStreamTickSeed = scenario_rand_mix(
+		RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_SRAND_0, uint32) ^
+		ror32(RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_SRAND_1, uint32), 16) ^
+		RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_TICKS, uint32)
+	);
+}
+
+/**
+ * Redirects scenario_rand to a counter based stream keyed by the tick seed, entity type and
+ * index until scenario_rand_end_stream is called. Random numbers drawn by an entity then no
+ * longer depend on how many numbers other entities drew before it, so the result of an update
+ * is independent of update order. Has no effect unless the park has entity random streams on.
+ */
+void scenario_rand_begin_stream(uint8 type, uint16 index)
+{
+	if (!scenario_rand_streams_enabled())
+		return;
+
+	_randStreamKey = scenario_rand_mix(_randStreamTickSeed ^ (((uint32)type << 16) | index));
+	_randStreamCounter = 0;
+	_randStreamActive = true;
+}
+
+void scenario_rand_end_stream()
+{
+	_randStreamActive = false;
+}
+
 /**
  *
  *  rct2: 0x006E37D2
@@ -697,6 +757,10 @@ unsigned int scenario_rand()
 	}
 #endif
 
+	if (_randStreamActive) {
+		return scenario_rand_mix(_randStreamKey + (_randStreamCounter++ * 0x9E3779B9));
+	}
+
 	int eax = RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_SRAND_0, uint32);
 	RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_SRAND_0, uint32) += ror32(RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_SRAND_1, uint32) ^ 0x1234567F, 7);
 	return RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_SRAND_1, uint32) = ror32(eax, 3);
@@ -753,14 +817,12 @@ void scenario_prepare_rides_for_save()
 int scenario_prepare_for_save()
 {
 	rct_s6_info *s6Info = (rct_s6_info*)0x0141F570;
-	char buffer[256];
 
 	s6Info->entry.flags = 255;
 
 	rct_stex_entry* stex = g_stexEntries[0];
 	if ((int)stex != 0xFFFFFFFF) {
-		format_string(buffer, stex->scenario_name, NULL);
-		safe_strcpy(s6Info->name, buffer, sizeof(s6Info->name));
+		format_string_bounded(s6Info->name, sizeof(s6Info->name), stex->scenario_name, NULL);
 
 		memcpy(&s6Info->entry, &object_entry_groups[OBJECT_TYPE_SCENARIO_TEXT].entries[0], sizeof(rct_object_entry));
 	}
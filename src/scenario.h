@@ -393,6 +393,11 @@ enum {
 	S6_TYPE_SCENARIO
 };
 
+enum {
+	RAND_STREAM_SPRITE,
+	RAND_STREAM_RIDE
+};
+
 #define S6_RCT2_VERSION 120001
 #define S6_MAGIC_NUMBER 0x00031144
 
@@ -476,6 +481,7 @@ extern uint32 gLastAutoSaveTick;
 bool scenario_scores_save();
 void scenario_load_list();
 void scenario_list_dispose();
+void scenario_index_delete();
 scenario_index_entry *scenario_list_find_by_filename(const utf8 *filename);
 scenario_index_entry *scenario_list_find_by_path(const utf8 *path);
 scenario_highscore_entry *scenario_highscore_insert();
@@ -487,6 +493,10 @@ void scenario_begin();
 void scenario_update();
 unsigned int scenario_rand();
 unsigned int scenario_rand_max(unsigned int max);
+bool scenario_rand_streams_enabled();
+void scenario_rand_begin_tick();
+void scenario_rand_begin_stream(uint8 type, uint16 index);
+void scenario_rand_end_stream();
 int scenario_prepare_for_save();
 int scenario_save(SDL_RWops* rw, int flags);
 int scenario_save_network(SDL_RWops* rw);
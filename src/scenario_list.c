@@ -23,6 +23,7 @@
 #include "localisation/localisation.h"
 #include "platform/platform.h"
 #include "scenario.h"
+#include "util/sawyercoding.h"
 #include "util/util.h"
 
 // Scenario list
@@ -34,8 +35,46 @@ int gScenarioHighscoreListCount = 0;
 int gScenarioHighscoreListCapacity = 0;
 scenario_highscore_entry *gScenarioHighscoreList = NULL;
 
-static void scenario_list_include(const utf8 *directory);
-static void scenario_list_add(const utf8 *path, uint64 timestamp);
+#define SCENARIO_INDEX_VERSION 1
+#define SCENARIO_SCAN_MAX_THREADS 16
+
+/**
+ * A scenario file found while scanning and its information chunk, either from the scenario index or read from the
+ * file itself when the file is new or has changed.
+ */
+typedef struct {
+	utf8 *path;
+	uint64 size;
+	uint64 last_modified;
+	bool valid;
+	bool indexed;
+	bool read;
+	rct_s6_info info;
+} scenario_scan_file;
+
+typedef struct {
+	scenario_scan_file *files;
+	int count;
+	int capacity;
+} scenario_scan_list;
+
+typedef struct {
+	scenario_scan_list *list;
+	SDL_atomic_t next;
+} scenario_scan_state;
+
+// Hash table of scenario list indices (plus one) by file name, as scenarios and highscores are matched up by file name
+static uint32 *_scenarioFilenameTable = NULL;
+static uint32 _scenarioFilenameTableSize = 0;
+
+static void scenario_list_include(const utf8 *directory, scenario_scan_list *scanList);
+static void scenario_list_add(const utf8 *path, uint64 timestamp, const rct_s6_info *s6Info);
+static void scenario_list_read_files(scenario_scan_list *scanList, const scenario_scan_list *previousIndex);
+static void scenario_filename_table_rebuild();
+static void scenario_filename_table_insert(int index);
+static bool scenario_index_load(scenario_scan_list *outIndex);
+static void scenario_index_save(const scenario_scan_list *index);
+static void scenario_scan_list_dispose(scenario_scan_list *scanList);
 static void scenario_list_sort();
 static int scenario_list_sort_by_category(const void *a, const void *b);
 static int scenario_list_sort_by_index(const void *a, const void *b);
@@ -55,20 +94,46 @@ static void io_write_string(SDL_RWops *file, utf8 *source);
 void scenario_load_list()
 {
 	utf8 directory[MAX_PATH];
+	scenario_scan_list scanList = { 0 };
+	scenario_scan_list previousIndex = { 0 };
 
 	// Clear scenario list
 	gScenarioListCount = 0;
+	scenario_filename_table_rebuild();
 
 	// Get scenario directory from RCT2
 	safe_strcpy(directory, gConfigGeneral.game_path, sizeof(directory));
 	safe_strcat_path(directory, "Scenarios", sizeof(directory));
-	scenario_list_include(directory);
+	scenario_list_include(directory, &scanList);
 
 	// Get scenario directory from user directory
 	platform_get_user_directory(directory, "scenario");
-	scenario_list_include(directory);
+	scenario_list_include(directory, &scanList);
+
+	// Only new or changed scenarios need to be read, the rest come from the index
+	scenario_index_load(&previousIndex);
+	scenario_list_read_files(&scanList, &previousIndex);
+
+	int numFilesRead = 0;
+	for (int i = 0; i < scanList.count; i++) {
+		scenario_scan_file *file = &scanList.files[i];
+		if (file->read) {
+			numFilesRead++;
+		}
+		if (file->valid) {
+			scenario_list_add(file->path, file->last_modified, &file->info);
+		}
+	}
+	log_verbose("%d scenario files, %d read", scanList.count, numFilesRead);
+
+	if (numFilesRead != 0 || scanList.count != previousIndex.count) {
+		scenario_index_save(&scanList);
+	}
+	scenario_scan_list_dispose(&previousIndex);
+	scenario_scan_list_dispose(&scanList);
 
 	scenario_list_sort();
+	scenario_filename_table_rebuild();
 	scenario_scores_load();
 
 	utf8 scoresPath[MAX_PATH];
@@ -77,7 +142,7 @@ void scenario_load_list()
 	scenario_scores_legacy_load(get_file_path(PATH_ID_SCORES));
 }
 
-static void scenario_list_include(const utf8 *directory)
+static void scenario_list_include(const utf8 *directory, scenario_scan_list *scanList)
 {
 	int handle;
 	file_info fileInfo;
@@ -92,7 +157,18 @@ static void scenario_list_include(const utf8 *directory)
 		utf8 path[MAX_PATH];
 		safe_strcpy(path, directory, sizeof(pattern));
 		safe_strcat_path(path, fileInfo.path, sizeof(pattern));
-		scenario_list_add(path, fileInfo.last_modified);
+
+		if (scanList->count >= scanList->capacity) {
+			scanList->capacity = max(64, scanList->capacity * 2);
+			scanList->files = realloc(scanList->files, scanList->capacity * sizeof(scenario_scan_file));
+		}
+		scenario_scan_file *file = &scanList->files[scanList->count++];
+		file->path = _strdup(path);
+		file->size = fileInfo.size;
+		file->last_modified = fileInfo.last_modified;
+		file->valid = false;
+		file->indexed = false;
+		file->read = false;
 	}
 	platform_enumerate_files_end(handle);
 
@@ -103,20 +179,139 @@ static void scenario_list_include(const utf8 *directory)
 		utf8 path[MAX_PATH];
 		safe_strcpy(path, directory, sizeof(pattern));
 		safe_strcat_path(path, subDirectory, sizeof(pattern));
-		scenario_list_include(path);
+		scenario_list_include(path, scanList);
 	}
 	platform_enumerate_directories_end(handle);
 }
 
-static void scenario_list_add(const utf8 *path, uint64 timestamp)
+static void scenario_scan_list_dispose(scenario_scan_list *scanList)
+{
+	for (int i = 0; i < scanList->count; i++) {
+		SafeFree(scanList->files[i].path);
+	}
+	SafeFree(scanList->files);
+	scanList->count = 0;
+	scanList->capacity = 0;
+}
+
+static int scenario_scan_file_compare(const void *a, const void *b)
+{
+	const scenario_scan_file *fileA = (const scenario_scan_file*)a;
+	const scenario_scan_file *fileB = (const scenario_scan_file*)b;
+	return strcmp(fileA->path, fileB->path);
+}
+
+/**
+ * Reads a chunk without touching any game state, so it can be called from scan threads.
+ */
+static bool scenario_read_chunk(SDL_RWops *rw, uint8 *buffer, size_t *outLength)
+{
+	sawyercoding_chunk_header chunkHeader;
+	if (SDL_RWread(rw, &chunkHeader, sizeof(sawyercoding_chunk_header), 1) != 1) {
+		return false;
+	}
+
+	uint8 *encodedChunk = malloc(chunkHeader.length);
+	if (encodedChunk == NULL || SDL_RWread(rw, encodedChunk, chunkHeader.length, 1) != 1) {
+		free(encodedChunk);
+		return false;
+	}
+	*outLength = sawyercoding_read_chunk_buffer(buffer, encodedChunk, chunkHeader);
+	free(encodedChunk);
+	return true;
+}
+
+/**
+ * Same as scenario_load_basic but safe to call from scan threads. The buffer is used to decode the chunks into.
+ */
+static void scenario_list_read_file(scenario_scan_file *file, uint8 *buffer)
+{
+	file->read = true;
+
+	SDL_RWops *rw = SDL_RWFromFile(file->path, "rb");
+	if (rw == NULL) {
+		return;
+	}
+
+	size_t length;
+	if (scenario_read_chunk(rw, buffer, &length) && length >= sizeof(rct_s6_header)) {
+		rct_s6_header *header = (rct_s6_header*)buffer;
+		if (header->type == S6_TYPE_SCENARIO) {
+			if (scenario_read_chunk(rw, buffer, &length) && length >= sizeof(rct_s6_info)) {
+				memcpy(&file->info, buffer, sizeof(rct_s6_info));
+				file->valid = true;
+			}
+		}
+	}
+	SDL_RWclose(rw);
+}
+
+static int scenario_list_read_files_thread(void *ptr)
 {
-	// Load the basic scenario information
-	rct_s6_header s6Header;
-	rct_s6_info s6Info;
-	if (!scenario_load_basic(path, &s6Header, &s6Info)) {
+	scenario_scan_state *state = (scenario_scan_state*)ptr;
+	scenario_scan_list *scanList = state->list;
+
+	uint8 *buffer = malloc(0x600000);
+	int i;
+	while ((i = SDL_AtomicAdd(&state->next, 1)) < scanList->count) {
+		scenario_scan_file *file = &scanList->files[i];
+		if (!file->indexed) {
+			scenario_list_read_file(file, buffer);
+		}
+	}
+	free(buffer);
+	return 0;
+}
+
+/**
+ * Fills in the information of each scanned file from the previous index if the file has not changed, otherwise reads
+ * it. Files are read on as many threads as there are processors.
+ */
+static void scenario_list_read_files(scenario_scan_list *scanList, const scenario_scan_list *previousIndex)
+{
+	SDL_Thread *threads[SCENARIO_SCAN_MAX_THREADS];
+	int i, numThreads, numFilesToRead;
+
+	numFilesToRead = 0;
+	for (i = 0; i < scanList->count; i++) {
+		scenario_scan_file *file = &scanList->files[i];
+		scenario_scan_file *indexedFile = NULL;
+		if (previousIndex->count != 0) {
+			indexedFile = bsearch(file, previousIndex->files, previousIndex->count, sizeof(scenario_scan_file), scenario_scan_file_compare);
+		}
+		if (indexedFile != NULL && indexedFile->size == file->size && indexedFile->last_modified == file->last_modified) {
+			file->valid = indexedFile->valid;
+			file->info = indexedFile->info;
+			file->indexed = true;
+		} else {
+			numFilesToRead++;
+		}
+	}
+	if (numFilesToRead == 0) {
 		return;
 	}
 
+	scenario_scan_state state;
+	state.list = scanList;
+	SDL_AtomicSet(&state.next, 0);
+
+	numThreads = min(SDL_GetCPUCount(), SCENARIO_SCAN_MAX_THREADS);
+	numThreads = min(numThreads, numFilesToRead);
+
+	// This thread reads files as well
+	for (i = 1; i < numThreads; i++) {
+		threads[i] = SDL_CreateThread(scenario_list_read_files_thread, "scenario scan", &state);
+	}
+	scenario_list_read_files_thread(&state);
+	for (i = 1; i < numThreads; i++) {
+		if (threads[i] != NULL) {
+			SDL_WaitThread(threads[i], NULL);
+		}
+	}
+}
+
+static void scenario_list_add(const utf8 *path, uint64 timestamp, const rct_s6_info *s6Info)
+{
 	scenario_index_entry *newEntry = NULL;
 
 	const utf8 *filename = path_get_filename(path);
@@ -154,14 +349,14 @@ static void scenario_list_add(const utf8 *path, uint64 timestamp)
 	// Set new entry
 	safe_strcpy(newEntry->path, path, sizeof(newEntry->path));
 	newEntry->timestamp = timestamp;
-	newEntry->category = s6Info.category;
-	newEntry->objective_type = s6Info.objective_type;
-	newEntry->objective_arg_1 = s6Info.objective_arg_1;
-	newEntry->objective_arg_2 = s6Info.objective_arg_2;
-	newEntry->objective_arg_3 = s6Info.objective_arg_3;
+	newEntry->category = s6Info->category;
+	newEntry->objective_type = s6Info->objective_type;
+	newEntry->objective_arg_1 = s6Info->objective_arg_1;
+	newEntry->objective_arg_2 = s6Info->objective_arg_2;
+	newEntry->objective_arg_3 = s6Info->objective_arg_3;
 	newEntry->highscore = NULL;
-	safe_strcpy(newEntry->name, s6Info.name, sizeof(newEntry->name));
-	safe_strcpy(newEntry->details, s6Info.details, sizeof(newEntry->details));
+	safe_strcpy(newEntry->name, s6Info->name, sizeof(newEntry->name));
+	safe_strcpy(newEntry->details, s6Info->details, sizeof(newEntry->details));
 
 	// Normalise the name to make the scenario as recognisable as possible.
 	scenario_normalise_name(newEntry->name);
@@ -183,7 +378,11 @@ static void scenario_list_add(const utf8 *path, uint64 timestamp)
 		}
 	}
 
-	scenario_translate(newEntry, &s6Info.entry);
+	scenario_translate(newEntry, &s6Info->entry);
+
+	if (newEntry != existingEntry) {
+		scenario_filename_table_insert(gScenarioListCount - 1);
+	}
 }
 
 static void scenario_translate(scenario_index_entry *scenarioEntry, const rct_object_entry *stexObjectEntry)
@@ -214,6 +413,152 @@ void scenario_list_dispose()
 	gScenarioListCapacity = 0;
 	gScenarioListCount = 0;
 	SafeFree(gScenarioList);
+	SafeFree(_scenarioFilenameTable);
+	_scenarioFilenameTableSize = 0;
+}
+
+static uint32 scenario_filename_hash(const utf8 *filename)
+{
+	uint32 hash = 5381;
+	for (; *filename != '\0'; filename++) {
+		hash = ((hash << 5) + hash) + (uint8)tolower((unsigned char)*filename);
+	}
+	return hash;
+}
+
+static void scenario_filename_table_add(int index)
+{
+	const utf8 *filename = path_get_filename(gScenarioList[index].path);
+	uint32 slot = scenario_filename_hash(filename) & (_scenarioFilenameTableSize - 1);
+	while (_scenarioFilenameTable[slot] != 0) {
+		slot = (slot + 1) & (_scenarioFilenameTableSize - 1);
+	}
+	_scenarioFilenameTable[slot] = index + 1;
+}
+
+/**
+ * Rebuilds the file name table from the scenario list, needed whenever the list is reordered.
+ */
+static void scenario_filename_table_rebuild()
+{
+	uint32 size = 64;
+	while (size < (uint32)gScenarioListCount * 2) {
+		size *= 2;
+	}
+
+	SafeFree(_scenarioFilenameTable);
+	_scenarioFilenameTableSize = size;
+	_scenarioFilenameTable = calloc(size, sizeof(uint32));
+	for (int i = 0; i < gScenarioListCount; i++) {
+		scenario_filename_table_add(i);
+	}
+}
+
+static void scenario_filename_table_insert(int index)
+{
+	// Keep the table at most half full
+	if ((uint32)gScenarioListCount * 2 > _scenarioFilenameTableSize) {
+		scenario_filename_table_rebuild();
+	} else {
+		scenario_filename_table_add(index);
+	}
+}
+
+/**
+ * Gets the path for the scenario index.
+ */
+static void scenario_index_get_path(utf8 *outPath)
+{
+	platform_get_user_directory(outPath, NULL);
+	strcat(outPath, "scenarios.idx");
+}
+
+/**
+ * Loads the scenario information cached from a previous scan, sorted by path.
+ */
+static bool scenario_index_load(scenario_scan_list *outIndex)
+{
+	utf8 indexPath[MAX_PATH];
+	scenario_index_get_path(indexPath);
+
+	SDL_RWops *file = SDL_RWFromFile(indexPath, "rb");
+	if (file == NULL) {
+		return false;
+	}
+
+	uint32 fileVersion, count;
+	if (
+		SDL_RWread(file, &fileVersion, sizeof(fileVersion), 1) != 1 ||
+		fileVersion != SCENARIO_INDEX_VERSION ||
+		SDL_RWread(file, &count, sizeof(count), 1) != 1
+	) {
+		log_verbose("Scenario index is out of date, rebuilding.");
+		SDL_RWclose(file);
+		return false;
+	}
+
+	outIndex->capacity = count;
+	outIndex->files = malloc(count * sizeof(scenario_scan_file));
+	for (uint32 i = 0; i < count; i++) {
+		scenario_scan_file *indexedFile = &outIndex->files[outIndex->count];
+		indexedFile->path = io_read_string(file);
+		indexedFile->indexed = true;
+		indexedFile->read = false;
+		if (
+			indexedFile->path == NULL ||
+			SDL_RWread(file, &indexedFile->size, sizeof(indexedFile->size), 1) != 1 ||
+			SDL_RWread(file, &indexedFile->last_modified, sizeof(indexedFile->last_modified), 1) != 1 ||
+			SDL_RWread(file, &indexedFile->valid, sizeof(indexedFile->valid), 1) != 1 ||
+			(indexedFile->valid && SDL_RWread(file, &indexedFile->info, sizeof(rct_s6_info), 1) != 1)
+		) {
+			log_error("Scenario index is corrupt, rebuilding.");
+			SafeFree(indexedFile->path);
+			break;
+		}
+		outIndex->count++;
+	}
+	SDL_RWclose(file);
+
+	qsort(outIndex->files, outIndex->count, sizeof(scenario_scan_file), scenario_scan_file_compare);
+	return true;
+}
+
+static void scenario_index_save(const scenario_scan_list *index)
+{
+	utf8 indexPath[MAX_PATH];
+	scenario_index_get_path(indexPath);
+
+	SDL_RWops *file = SDL_RWFromFile(indexPath, "wb");
+	if (file == NULL) {
+		log_error("Unable to save scenario index.");
+		return;
+	}
+
+	const uint32 fileVersion = SCENARIO_INDEX_VERSION;
+	const uint32 count = index->count;
+	SDL_RWwrite(file, &fileVersion, sizeof(fileVersion), 1);
+	SDL_RWwrite(file, &count, sizeof(count), 1);
+	for (int i = 0; i < index->count; i++) {
+		const scenario_scan_file *scannedFile = &index->files[i];
+		io_write_string(file, scannedFile->path);
+		SDL_RWwrite(file, &scannedFile->size, sizeof(scannedFile->size), 1);
+		SDL_RWwrite(file, &scannedFile->last_modified, sizeof(scannedFile->last_modified), 1);
+		SDL_RWwrite(file, &scannedFile->valid, sizeof(scannedFile->valid), 1);
+		if (scannedFile->valid) {
+			SDL_RWwrite(file, &scannedFile->info, sizeof(rct_s6_info), 1);
+		}
+	}
+	SDL_RWclose(file);
+}
+
+/**
+ * Deletes the scenario index so the next scan reads every scenario file again.
+ */
+void scenario_index_delete()
+{
+	utf8 indexPath[MAX_PATH];
+	scenario_index_get_path(indexPath);
+	platform_file_delete(indexPath);
 }
 
 static void scenario_list_sort()
@@ -294,11 +639,18 @@ static int scenario_list_sort_by_index(const void *a, const void *b)
 
 scenario_index_entry *scenario_list_find_by_filename(const utf8 *filename)
 {
-	for (int i = 0; i < gScenarioListCount; i++) {
-		const utf8 *scenarioFilename = path_get_filename(gScenarioList[i].path);
+	if (_scenarioFilenameTable == NULL) {
+		return NULL;
+	}
+
+	uint32 slot = scenario_filename_hash(filename) & (_scenarioFilenameTableSize - 1);
+	while (_scenarioFilenameTable[slot] != 0) {
+		scenario_index_entry *scenarioEntry = &gScenarioList[_scenarioFilenameTable[slot] - 1];
+		const utf8 *scenarioFilename = path_get_filename(scenarioEntry->path);
 		if (_strcmpi(filename, scenarioFilename) == 0) {
-			return &gScenarioList[i];
+			return scenarioEntry;
 		}
+		slot = (slot + 1) & (_scenarioFilenameTableSize - 1);
 	}
 	return NULL;
 }
@@ -0,0 +1,336 @@
+#include "addresses.h"
+#include "platform/platform.h"
+#include "ride/ride.h"
+#include "state_hash.h"
+#include "util/util.h"
+#include "world/map.h"
+#include "world/park.h"
+#include "world/sprite.h"
+
+#define STATE_HASH_PRIME 0x01000193
+#define STATE_HASH_OFFSET_BASIS 0x811C9DC5
+
+#define STATE_DUMP_MAGIC 0x48535452 // RTSH
+#define STATE_DUMP_VERSION 1
+
+#define STATE_HASH_PARK_WORDS 12
+
+static const utf8 *StateHashCategoryNames[STATE_HASH_CATEGORY_COUNT] = {
+	"map",
+	"sprites",
+	"rides",
+	"park"
+};
+
+/**
+ * FNV-1a over 32-bit words in four interleaved lanes. The lanes are independent so the main loop
+ * maps directly onto a single vector register, which keeps hashing the sprite and ride arrays
+ * cheap enough to run on every checksum tick.
+ */
+typedef struct {
+	uint32 lanes[4];
+	uint32 length;
+} state_hasher;
+
+static void state_hasher_init(state_hasher *hasher)
+{
+	for (int i = 0; i < 4; i++)
+		hasher->lanes[i] = STATE_HASH_OFFSET_BASIS + i;
+	hasher->length = 0;
+}
+
+static void state_hasher_update(state_hasher *hasher, const uint32 *words, int count)
+{
+	int i = 0;
+	if ((hasher->length & 3) == 0) {
+		uint32 lane0 = hasher->lanes[0];
+		uint32 lane1 = hasher->lanes[1];
+		uint32 lane2 = hasher->lanes[2];
+		uint32 lane3 = hasher->lanes[3];
+		for (; i + 4 <= count; i += 4) {
+			lane0 = (lane0 ^ words[i + 0]) * STATE_HASH_PRIME;
+			lane1 = (lane1 ^ words[i + 1]) * STATE_HASH_PRIME;
+			lane2 = (lane2 ^ words[i + 2]) * STATE_HASH_PRIME;
+			lane3 = (lane3 ^ words[i + 3]) * STATE_HASH_PRIME;
+		}
+		hasher->lanes[0] = lane0;
+		hasher->lanes[1] = lane1;
+		hasher->lanes[2] = lane2;
+		hasher->lanes[3] = lane3;
+	}
+	for (; i < count; i++) {
+		int lane = (hasher->length + i) & 3;
+		hasher->lanes[lane] = (hasher->lanes[lane] ^ words[i]) * STATE_HASH_PRIME;
+	}
+	hasher->length += count;
+}
+
+static uint32 state_hasher_final(const state_hasher *hasher)
+{
+	uint32 hash = hasher->lanes[0] ^ rol32(hasher->lanes[1], 8) ^ rol32(hasher->lanes[2], 16) ^ rol32(hasher->lanes[3], 24);
+	hash ^= hasher->length;
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6B;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+const utf8 *state_hash_category_name(int category)
+{
+	if (category < 0 || category >= STATE_HASH_CATEGORY_COUNT)
+		return "unknown";
+	return StateHashCategoryNames[category];
+}
+
+int state_hash_get_entity_count(int category)
+{
+	switch (category) {
+	case STATE_HASH_CATEGORY_MAP: return 256 * 256;
+	case STATE_HASH_CATEGORY_SPRITES: return MAX_SPRITES;
+	case STATE_HASH_CATEGORY_RIDES: return MAX_RIDES;
+	case STATE_HASH_CATEGORY_PARK: return 1;
+	default: return 0;
+	}
+}
+
+void state_hash_get_bucket_range(int category, int bucket, int *firstEntity, int *lastEntity)
+{
+	int count = state_hash_get_entity_count(category);
+	int entitiesPerBucket = (count + STATE_HASH_BUCKET_COUNT - 1) / STATE_HASH_BUCKET_COUNT;
+	*firstEntity = min(bucket * entitiesPerBucket, count);
+	*lastEntity = min(*firstEntity + entitiesPerBucket, count) - 1;
+}
+
+/**
+ * Hashes all the elements on a tile. Ghost elements are only placed on the local machine for
+ * construction previews, so they are not part of the shared game state.
+ */
+static uint32 state_hash_tile(int index)
+{
+	state_hasher hasher;
+	state_hasher_init(&hasher);
+
+	rct_map_element *mapElement = gMapElementTilePointers[index];
+	do {
+		if (mapElement->flags & MAP_ELEMENT_FLAG_GHOST)
+			continue;
+
+		uint32 words[sizeof(rct_map_element) / sizeof(uint32)];
+		memcpy(words, mapElement, sizeof(rct_map_element));
+		state_hasher_update(&hasher, words, countof(words));
+	} while (!map_element_is_last_for_tile(mapElement++));
+
+	return state_hasher_final(&hasher);
+}
+
+/**
+ * The sprite's screen bounds depend on the local viewport rotation, and a peep's window invalidation
+ * flags and flashing flag are set by whichever guest and staff windows are open locally, so those
+ * fields are masked out.
+ */
+static uint32 state_hash_sprite(int index)
+{
+	rct_sprite *sprite = &g_sprite_list[index];
+	if (sprite->unknown.sprite_identifier == SPRITE_IDENTIFIER_NULL)
+		return 0;
+
+	uint32 words[sizeof(rct_sprite) / sizeof(uint32)];
+	memcpy(words, sprite, sizeof(rct_sprite));
+
+	uint8 *bytes = (uint8*)words;
+	memset(bytes + offsetof(rct_unk_sprite, sprite_left), 0, offsetof(rct_unk_sprite, sprite_direction) - offsetof(rct_unk_sprite, sprite_left));
+	if (sprite->unknown.sprite_identifier == SPRITE_IDENTIFIER_PEEP) {
+		memset(bytes + offsetof(rct_peep, window_invalidate_flags), 0, sizeof(sprite->peep.window_invalidate_flags));
+		*((uint16*)(bytes + offsetof(rct_unk_sprite, flags))) &= ~SPRITE_FLAGS_PEEP_FLASHING;
+	}
+
+	state_hasher hasher;
+	state_hasher_init(&hasher);
+	state_hasher_update(&hasher, words, countof(words));
+	return state_hasher_final(&hasher);
+}
+
+/**
+ * Ride music is chosen with util_rand and advanced by the local audio device, and the window
+ * invalidation flags are only UI state, so those fields are masked out.
+ */
+static uint32 state_hash_ride(int index)
+{
+	rct_ride *ride = get_ride(index);
+	if (ride->type == RIDE_TYPE_NULL)
+		return 0;
+
+	uint32 words[sizeof(rct_ride) / sizeof(uint32)];
+	memcpy(words, ride, sizeof(rct_ride));
+
+	uint8 *bytes = (uint8*)words;
+	memset(bytes + offsetof(rct_ride, music_tune_id), 0, sizeof(ride->music_tune_id));
+	memset(bytes + offsetof(rct_ride, music_position), 0, sizeof(ride->music_position));
+	memset(bytes + offsetof(rct_ride, window_invalidate_flags), 0, sizeof(ride->window_invalidate_flags));
+
+	state_hasher hasher;
+	state_hasher_init(&hasher);
+	state_hasher_update(&hasher, words, countof(words));
+	return state_hasher_final(&hasher);
+}
+
+static uint32 state_hash_park()
+{
+	uint32 words[STATE_HASH_PARK_WORDS] = {
+		RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_MONEY_ENCRYPTED, uint32),
+		RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_LOAN, uint32),
+		RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_COMPANY_VALUE, uint32),
+		RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_PARK_VALUE, uint32),
+		RCT2_GLOBAL(RCT2_ADDRESS_PARK_FLAGS, uint32),
+		RCT2_GLOBAL(RCT2_ADDRESS_PARK_ENTRANCE_FEE, uint16),
+		RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_PARK_RATING, uint16),
+		RCT2_GLOBAL(RCT2_ADDRESS_GUESTS_IN_PARK, uint16),
+		RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_MONTH_YEAR, uint16),
+		RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_MONTH_TICKS, uint16),
+		RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_SRAND_0, uint32),
+		RCT2_GLOBAL(RCT2_ADDRESS_SCENARIO_SRAND_1, uint32)
+	};
+
+	state_hasher hasher;
+	state_hasher_init(&hasher);
+	state_hasher_update(&hasher, words, countof(words));
+	return state_hasher_final(&hasher);
+}
+
+uint32 state_hash_entity(int category, int index)
+{
+	switch (category) {
+	case STATE_HASH_CATEGORY_MAP: return state_hash_tile(index);
+	case STATE_HASH_CATEGORY_SPRITES: return state_hash_sprite(index);
+	case STATE_HASH_CATEGORY_RIDES: return state_hash_ride(index);
+	case STATE_HASH_CATEGORY_PARK: return state_hash_park();
+	default: return 0;
+	}
+}
+
+/**
+ * Computes the per bucket hashes of the current game state. Buckets are folded from the entity
+ * hashes in index order, so a bucket mismatch always has a matching entity mismatch in a dump.
+ * Everything is rehashed each time as game state is written through raw pointers and globals from
+ * all over the code, which leaves no single place to mark changed entities as dirty.
+ */
+void state_hash_compute(rct_state_hash *hash)
+{
+	hash->tick = RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32);
+	for (int category = 0; category < STATE_HASH_CATEGORY_COUNT; category++) {
+		for (int bucket = 0; bucket < STATE_HASH_BUCKET_COUNT; bucket++) {
+			int first, last;
+			state_hash_get_bucket_range(category, bucket, &first, &last);
+
+			state_hasher hasher;
+			state_hasher_init(&hasher);
+			for (int i = first; i <= last; i++) {
+				uint32 entityHash = state_hash_entity(category, i);
+				state_hasher_update(&hasher, &entityHash, 1);
+			}
+			hash->buckets[category][bucket] = state_hasher_final(&hasher);
+		}
+	}
+}
+
+bool state_hash_find_divergence(const rct_state_hash *a, const rct_state_hash *b, int *outCategory, int *outBucket)
+{
+	for (int category = 0; category < STATE_HASH_CATEGORY_COUNT; category++) {
+		for (int bucket = 0; bucket < STATE_HASH_BUCKET_COUNT; bucket++) {
+			if (a->buckets[category][bucket] != b->buckets[category][bucket]) {
+				*outCategory = category;
+				*outBucket = bucket;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool state_hash_dump_create(rct_state_dump *dump)
+{
+	memset(dump, 0, sizeof(rct_state_dump));
+	dump->tick = RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32);
+	for (int category = 0; category < STATE_HASH_CATEGORY_COUNT; category++) {
+		int count = state_hash_get_entity_count(category);
+		dump->entities[category] = malloc(count * sizeof(uint32));
+		if (dump->entities[category] == NULL) {
+			state_hash_dump_dispose(dump);
+			return false;
+		}
+
+		dump->count[category] = count;
+		for (int i = 0; i < count; i++) {
+			dump->entities[category][i] = state_hash_entity(category, i);
+		}
+	}
+	return true;
+}
+
+bool state_hash_dump_save(const rct_state_dump *dump, const utf8 *path)
+{
+	SDL_RWops *rw = SDL_RWFromFile(path, "wb");
+	if (rw == NULL) {
+		log_error("Unable to write state dump to '%s'", path);
+		return false;
+	}
+
+	uint32 header[] = { STATE_DUMP_MAGIC, STATE_DUMP_VERSION, dump->tick };
+	SDL_RWwrite(rw, header, sizeof(header), 1);
+	for (int category = 0; category < STATE_HASH_CATEGORY_COUNT; category++) {
+		SDL_RWwrite(rw, &dump->count[category], sizeof(uint32), 1);
+		SDL_RWwrite(rw, dump->entities[category], sizeof(uint32), dump->count[category]);
+	}
+	SDL_RWclose(rw);
+	return true;
+}
+
+bool state_hash_dump_load(rct_state_dump *dump, const utf8 *path)
+{
+	memset(dump, 0, sizeof(rct_state_dump));
+
+	SDL_RWops *rw = SDL_RWFromFile(path, "rb");
+	if (rw == NULL) {
+		log_error("Unable to open state dump '%s'", path);
+		return false;
+	}
+
+	uint32 header[3];
+	if (SDL_RWread(rw, header, sizeof(header), 1) != 1 || header[0] != STATE_DUMP_MAGIC || header[1] != STATE_DUMP_VERSION) {
+		log_error("'%s' is not a valid state dump", path);
+		SDL_RWclose(rw);
+		return false;
+	}
+
+	dump->tick = header[2];
+	for (int category = 0; category < STATE_HASH_CATEGORY_COUNT; category++) {
+		uint32 count;
+		if (SDL_RWread(rw, &count, sizeof(uint32), 1) != 1 || count != (uint32)state_hash_get_entity_count(category)) {
+			break;
+		}
+
+		dump->entities[category] = malloc(count * sizeof(uint32));
+		if (dump->entities[category] == NULL || SDL_RWread(rw, dump->entities[category], sizeof(uint32), count) != count) {
+			break;
+		}
+		dump->count[category] = count;
+	}
+	SDL_RWclose(rw);
+
+	if (dump->count[STATE_HASH_CATEGORY_COUNT - 1] == 0) {
+		log_error("State dump '%s' is truncated", path);
+		state_hash_dump_dispose(dump);
+		return false;
+	}
+	return true;
+}
+
+void state_hash_dump_dispose(rct_state_dump *dump)
+{
+	for (int category = 0; category < STATE_HASH_CATEGORY_COUNT; category++) {
+		SafeFree(dump->entities[category]);
+		dump->count[category] = 0;
+	}
+}
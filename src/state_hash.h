@@ -0,0 +1,43 @@
+#ifndef _STATE_HASH_H_
+#define _STATE_HASH_H_
+
+#include "common.h"
+
+enum {
+	STATE_HASH_CATEGORY_MAP,
+	STATE_HASH_CATEGORY_SPRITES,
+	STATE_HASH_CATEGORY_RIDES,
+	STATE_HASH_CATEGORY_PARK,
+	STATE_HASH_CATEGORY_COUNT
+};
+
+// Each category is split into this many buckets of consecutive entities so a mismatch can be
+// narrowed down to a range of tiles, sprites or rides without sending every entity hash
+#define STATE_HASH_BUCKET_COUNT 16
+
+typedef struct {
+	uint32 tick;
+	uint32 buckets[STATE_HASH_CATEGORY_COUNT][STATE_HASH_BUCKET_COUNT];
+} rct_state_hash;
+
+// Hash of every entity in the game state, used for offline comparisons
+typedef struct {
+	uint32 tick;
+	uint32 count[STATE_HASH_CATEGORY_COUNT];
+	uint32 *entities[STATE_HASH_CATEGORY_COUNT];
+} rct_state_dump;
+
+const utf8 *state_hash_category_name(int category);
+int state_hash_get_entity_count(int category);
+void state_hash_get_bucket_range(int category, int bucket, int *firstEntity, int *lastEntity);
+
+uint32 state_hash_entity(int category, int index);
+void state_hash_compute(rct_state_hash *hash);
+bool state_hash_find_divergence(const rct_state_hash *a, const rct_state_hash *b, int *outCategory, int *outBucket);
+
+bool state_hash_dump_create(rct_state_dump *dump);
+bool state_hash_dump_save(const rct_state_dump *dump, const utf8 *path);
+bool state_hash_dump_load(rct_state_dump *dump, const utf8 *path);
+void state_hash_dump_dispose(rct_state_dump *dump);
+
+#endif
@@ -36,6 +36,7 @@
 #include "network/network.h"
 #include "openrct2.h"
 #include "peep/staff.h"
+#include "replay.h"
 #include "ride/ride.h"
 #include "scenario.h"
 #include "util/util.h"
@@ -105,6 +106,8 @@ void title_load()
 {
 	log_verbose("loading title");
 
+	replay_stop_recording();
+
 	if (RCT2_GLOBAL(RCT2_ADDRESS_GAME_PAUSED, uint8) & 1)
 		pause_toggle();
 
@@ -109,25 +109,35 @@ size_t sawyercoding_read_chunk(SDL_RWops* rw, uint8 *buffer)
 	}
 
 	// Decode chunk data
+	chunkHeader.length = sawyercoding_read_chunk_buffer(buffer, src_buffer, chunkHeader);
+	free(src_buffer);
+	// Set length
+	RCT2_GLOBAL(0x009E3828, uint32) = chunkHeader.length;
+	return chunkHeader.length;
+}
+
+/**
+ * Decodes chunk data that has already been read into memory. Unlike sawyercoding_read_chunk this does not touch any
+ * game state so it is safe to call from other threads.
+ */
+size_t sawyercoding_read_chunk_buffer(uint8 *dst_buffer, const uint8 *src_buffer, sawyercoding_chunk_header chunkHeader)
+{
 	switch (chunkHeader.encoding) {
 	case CHUNK_ENCODING_NONE:
-		memcpy(buffer, src_buffer, chunkHeader.length);
+		memcpy(dst_buffer, src_buffer, chunkHeader.length);
 		break;
 	case CHUNK_ENCODING_RLE:
-		chunkHeader.length = decode_chunk_rle(src_buffer, buffer, chunkHeader.length);
+		chunkHeader.length = decode_chunk_rle(src_buffer, dst_buffer, chunkHeader.length);
 		break;
 	case CHUNK_ENCODING_RLECOMPRESSED:
-		chunkHeader.length = decode_chunk_rle(src_buffer, buffer, chunkHeader.length);
-		chunkHeader.length = decode_chunk_repeat(buffer, chunkHeader.length);
+		chunkHeader.length = decode_chunk_rle(src_buffer, dst_buffer, chunkHeader.length);
+		chunkHeader.length = decode_chunk_repeat(dst_buffer, chunkHeader.length);
 		break;
 	case CHUNK_ENCODING_ROTATE:
-		memcpy(buffer, src_buffer, chunkHeader.length);
-		decode_chunk_rotate(buffer, chunkHeader.length);
+		memcpy(dst_buffer, src_buffer, chunkHeader.length);
+		decode_chunk_rotate(dst_buffer, chunkHeader.length);
 		break;
 	}
-	free(src_buffer);
-	// Set length
-	RCT2_GLOBAL(0x009E3828, uint32) = chunkHeader.length;
 	return chunkHeader.length;
 }
 
@@ -50,6 +50,7 @@ enum {
 int sawyercoding_validate_checksum(SDL_RWops* rw);
 uint32 sawyercoding_calculate_checksum(const uint8* buffer, size_t length);
 size_t sawyercoding_read_chunk(SDL_RWops* rw, uint8 *buffer);
+size_t sawyercoding_read_chunk_buffer(uint8 *dst_buffer, const uint8 *src_buffer, sawyercoding_chunk_header chunkHeader);
 size_t sawyercoding_write_chunk_buffer(uint8 *dst_file, uint8* buffer, sawyercoding_chunk_header chunkHeader);
 size_t sawyercoding_decode_sv4(const uint8 *src, uint8 *dst, size_t length);
 size_t sawyercoding_decode_sc4(const uint8 *src, uint8 *dst, size_t length);
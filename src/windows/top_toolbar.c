@@ -1465,6 +1465,13 @@ static void window_top_toolbar_scenery_tool_down(short x, short y, rct_window *w
 		if (isCluster) {
 			quantity = 35;
 		}
+		// A cluster is sent as one batch so it is only paid for and sent over the network once. Each
+		// placement is only queried here to find a height it fits at. The batch is not on the map yet,
+		// so placements are also checked against the space taken by the ones already in it.
+		rct_map_clearance clusterClearances[35];
+		if (isCluster) {
+			game_command_batch_begin();
+		}
 		int successfulPlacements = 0;
 		for (int q = 0; q < quantity; q++) {
 			int zCoordinate = RCT2_GLOBAL(RCT2_ADDRESS_SCENERY_Z_COORDINATE, sint16);
@@ -1498,24 +1505,35 @@ static void window_top_toolbar_scenery_tool_down(short x, short y, rct_window *w
 
 			bool success = false;
 			for (; zAttemptRange != 0; zAttemptRange--){
-				int flags = GAME_COMMAND_FLAG_APPLY | (parameter_1 & 0xFF00);
+				int flags = (parameter_1 & 0xFF00);
+				if (!isCluster) {
+					flags |= GAME_COMMAND_FLAG_APPLY;
+				}
+				int edi = RCT2_GLOBAL(RCT2_ADDRESS_SCENERY_ROTATION, uint8) | (parameter_3 & 0xFFFF0000);
+				int ebp = RCT2_GLOBAL(RCT2_ADDRESS_SCENERY_Z_COORDINATE, sint16);
 
 				RCT2_GLOBAL(0x009A8C29, uint8) |= 1;
 				gGameCommandErrorTitle = STR_CANT_POSITION_THIS_HERE;
-				int cost = game_do_command(
-					cur_grid_x,
-					flags,
-					cur_grid_y,
-					parameter_2,
-					GAME_COMMAND_PLACE_SCENERY,
-					RCT2_GLOBAL(RCT2_ADDRESS_SCENERY_ROTATION, uint8) | (parameter_3 & 0xFFFF0000),
-					RCT2_GLOBAL(RCT2_ADDRESS_SCENERY_Z_COORDINATE, sint16)
-				);
+				int cost = game_do_command(cur_grid_x, flags, cur_grid_y, parameter_2, GAME_COMMAND_PLACE_SCENERY, edi, ebp);
 				RCT2_GLOBAL(0x009A8C29, uint8) &= ~1;
 
+				if (cost != MONEY32_UNDEFINED && isCluster) {
+					for (int i = 0; i < successfulPlacements; i++) {
+						if (map_clearances_intersect(&gSceneryPlaceClearance, &clusterClearances[i])) {
+							cost = MONEY32_UNDEFINED;
+							break;
+						}
+					}
+				}
+
 				if (cost != MONEY32_UNDEFINED){
-					window_close_by_class(WC_ERROR);
-					audio_play_sound_at_location(SOUND_PLACE_ITEM, RCT2_GLOBAL(RCT2_ADDRESS_COMMAND_MAP_X, uint16), RCT2_GLOBAL(RCT2_ADDRESS_COMMAND_MAP_Y, uint16), RCT2_GLOBAL(RCT2_ADDRESS_COMMAND_MAP_Z, uint16));
+					if (isCluster) {
+						game_command_batch_add(GAME_COMMAND_PLACE_SCENERY, cur_grid_x, flags, cur_grid_y, parameter_2, edi, ebp);
+						clusterClearances[successfulPlacements] = gSceneryPlaceClearance;
+					} else {
+						window_close_by_class(WC_ERROR);
+						audio_play_sound_at_location(SOUND_PLACE_ITEM, RCT2_GLOBAL(RCT2_ADDRESS_COMMAND_MAP_X, uint16), RCT2_GLOBAL(RCT2_ADDRESS_COMMAND_MAP_Y, uint16), RCT2_GLOBAL(RCT2_ADDRESS_COMMAND_MAP_Z, uint16));
+					}
 					success = true;
 					break;
 				}
@@ -1540,6 +1558,17 @@ static void window_top_toolbar_scenery_tool_down(short x, short y, rct_window *w
 			RCT2_GLOBAL(RCT2_ADDRESS_SCENERY_Z_COORDINATE, sint16) = zCoordinate;
 		}
 
+		if (isCluster && successfulPlacements > 0) {
+			RCT2_GLOBAL(0x009A8C29, uint8) |= 1;
+			gGameCommandErrorTitle = STR_CANT_POSITION_THIS_HERE;
+			if (game_command_batch_end(GAME_COMMAND_FLAG_APPLY) == MONEY32_UNDEFINED) {
+				successfulPlacements = 0;
+			} else {
+				audio_play_sound_at_location(SOUND_PLACE_ITEM, RCT2_GLOBAL(RCT2_ADDRESS_COMMAND_MAP_X, uint16), RCT2_GLOBAL(RCT2_ADDRESS_COMMAND_MAP_Y, uint16), RCT2_GLOBAL(RCT2_ADDRESS_COMMAND_MAP_Z, uint16));
+			}
+			RCT2_GLOBAL(0x009A8C29, uint8) &= ~1;
+		}
+
 		if (successfulPlacements > 0) {
 			window_close_by_class(WC_ERROR);
 		} else {
@@ -24,6 +24,7 @@
 #include "../config.h"
 #include "../cursors.h"
 #include "../game.h"
+#include "../interface/viewport.h"
 #include "../interface/window.h"
 #include "../localisation/date.h"
 #include "../localisation/localisation.h"
@@ -31,6 +32,7 @@
 #include "../network/network.h"
 #include "../openrct2.h"
 #include "../ride/ride_data.h"
+#include "../ride/ride_ratings.h"
 #include "../ride/track.h"
 #include "../ride/track_data.h"
 #include "../scenario.h"
@@ -67,6 +69,15 @@ bool LandRightsMode;
 bool gClearSmallScenery;
 bool gClearLargeScenery;
 bool gClearFootpath;
+rct_map_clearance gSceneryPlaceClearance;
+
+// Screen area of all tiles invalidated between map_invalidate_begin_deferred and map_invalidate_end_deferred
+static int _mapInvalidateDeferredDepth = 0;
+static int _mapInvalidateDeferredMaxZoom;
+static int _mapInvalidateDeferredLeft;
+static int _mapInvalidateDeferredTop;
+static int _mapInvalidateDeferredRight;
+static int _mapInvalidateDeferredBottom;
 
 static void tiles_init();
 static void map_update_grass_length(int x, int y, rct_map_element *mapElement);
@@ -307,6 +318,7 @@ void map_init(int size)
 
 	date_reset();
 	RCT2_GLOBAL(0x0138B580, sint16) = 0;
+	map_animation_mark_loaded();
 	RCT2_GLOBAL(0x010E63B8, sint32) = 0;
 
 	for (i = 0; i < MAX_TILE_MAP_ELEMENT_POINTERS; i++) {
@@ -345,6 +357,8 @@ void map_update_tile_pointers()
 {
 	int i, x, y;
 
+	ride_ratings_invalidate_proximity_cache();
+
 	for (i = 0; i < MAX_TILE_MAP_ELEMENT_POINTERS; i++)
 		TILE_MAP_ELEMENT_POINTER(i) = TILE_UNDEFINED_MAP_ELEMENT;
 
@@ -3022,6 +3036,11 @@ void game_command_place_scenery(int* eax, int* ebx, int* ecx, int* edx, int* esi
 
 						if(gCheatsDisableClearanceChecks || map_can_construct_with_clear_at(x, y, zLow, zHigh, &map_place_scenery_clear_func, bl, flags, RCT2_ADDRESS(0x00F64F26, money32))){
 							RCT2_GLOBAL(0x00F64F14, uint8) = RCT2_GLOBAL(RCT2_ADDRESS_ELEMENT_LOCATION_COMPARED_TO_GROUND_AND_WATER, uint8) & 0x3;
+							gSceneryPlaceClearance.x = x;
+							gSceneryPlaceClearance.y = y;
+							gSceneryPlaceClearance.base_height = zLow;
+							gSceneryPlaceClearance.clearance_height = zHigh;
+							gSceneryPlaceClearance.quadrants = bl & 0xF;
 							if(flags & GAME_COMMAND_FLAG_APPLY){
 								if (RCT2_GLOBAL(0x009A8C28, uint8) == 1 && !(flags & GAME_COMMAND_FLAG_GHOST)) {
 									rct_xyz16 coord;
@@ -3768,6 +3787,10 @@ int map_get_station(rct_map_element *mapElement)
  */
 void map_element_remove(rct_map_element *mapElement)
 {
+	// Elements after the removed one shift down, so picked element pointers may now be wrong
+	viewport_pick_cache_invalidate();
+	ride_ratings_invalidate_proximity_cache();
+
 	if (!map_element_is_last_for_tile(mapElement)){
 		do{
 			*mapElement = *(mapElement + 1);
@@ -3896,6 +3919,8 @@ void map_invalidate_selection_rect()
  */
 void map_reorganise_elements()
 {
+	viewport_pick_cache_invalidate();
+	ride_ratings_invalidate_proximity_cache();
 	platform_set_cursor(CURSOR_ZZZ);
 
 	rct_map_element* new_map_elements = malloc(0x30000 * sizeof(rct_map_element));
@@ -3967,6 +3992,10 @@ rct_map_element *map_element_insert(int x, int y, int z, int flags)
 		return NULL;
 	}
 
+	// The tile's elements are moved to the end of the element list
+	viewport_pick_cache_invalidate();
+	ride_ratings_invalidate_proximity_cache();
+
 	newMapElement = RCT2_GLOBAL(RCT2_ADDRESS_NEXT_FREE_MAP_ELEMENT, rct_map_element*);
 	originalMapElement = TILE_MAP_ELEMENT_POINTER(y * 256 + x);
 
@@ -4069,6 +4098,17 @@ static void map_obstruction_set_error_text(rct_map_element *mapElement)
 	gGameCommandErrorText = errorStringId;
 }
 
+/**
+ * Whether two elements taking the given space would collide, using the same test as map_can_construct_with_clear_at.
+ */
+bool map_clearances_intersect(const rct_map_clearance *a, const rct_map_clearance *b)
+{
+	return
+		a->x / 32 == b->x / 32 && a->y / 32 == b->y / 32 &&
+		a->base_height < b->clearance_height && a->clearance_height > b->base_height &&
+		(a->quadrants & b->quadrants) != 0;
+}
+
 /**
  *
  *  rct2: 0x0068B932
@@ -4784,6 +4824,17 @@ void map_invalidate_tile_under_zoom(int x, int y, int z0, int z1, int maxZoom)
 	x2 = x + 32;
 	y2 = y + 32 - z0;
 
+	if (_mapInvalidateDeferredDepth != 0) {
+		_mapInvalidateDeferredLeft = min(_mapInvalidateDeferredLeft, x1);
+		_mapInvalidateDeferredTop = min(_mapInvalidateDeferredTop, y1);
+		_mapInvalidateDeferredRight = max(_mapInvalidateDeferredRight, x2);
+		_mapInvalidateDeferredBottom = max(_mapInvalidateDeferredBottom, y2);
+		if (maxZoom == -1 || (_mapInvalidateDeferredMaxZoom != -1 && maxZoom > _mapInvalidateDeferredMaxZoom)) {
+			_mapInvalidateDeferredMaxZoom = maxZoom;
+		}
+		return;
+	}
+
 	for (int i = 0; i < MAX_VIEWPORT_COUNT; i++) {
 		rct_viewport *viewport = &g_viewport_list[i];
 		if (viewport->width != 0 && (maxZoom == -1 || viewport->zoom <= maxZoom)) {
@@ -4792,6 +4843,38 @@ void map_invalidate_tile_under_zoom(int x, int y, int z0, int z1, int maxZoom)
 	}
 }
 
+/**
+ * Collects tile invalidations into a single screen rectangle until map_invalidate_end_deferred
+ * is called. Used when many tiles in the same area are changed at once.
+ */
+void map_invalidate_begin_deferred()
+{
+	if (_mapInvalidateDeferredDepth++ == 0) {
+		_mapInvalidateDeferredMaxZoom = 0;
+		_mapInvalidateDeferredLeft = INT32_MAX;
+		_mapInvalidateDeferredTop = INT32_MAX;
+		_mapInvalidateDeferredRight = INT32_MIN;
+		_mapInvalidateDeferredBottom = INT32_MIN;
+	}
+}
+
+void map_invalidate_end_deferred()
+{
+	if (_mapInvalidateDeferredDepth == 0 || --_mapInvalidateDeferredDepth != 0) {
+		return;
+	}
+	if (_mapInvalidateDeferredLeft > _mapInvalidateDeferredRight) {
+		return;
+	}
+
+	for (int i = 0; i < MAX_VIEWPORT_COUNT; i++) {
+		rct_viewport *viewport = &g_viewport_list[i];
+		if (viewport->width != 0 && (_mapInvalidateDeferredMaxZoom == -1 || viewport->zoom <= _mapInvalidateDeferredMaxZoom)) {
+			viewport_invalidate(viewport, _mapInvalidateDeferredLeft, _mapInvalidateDeferredTop, _mapInvalidateDeferredRight, _mapInvalidateDeferredBottom);
+		}
+	}
+}
+
 /**
  *
  *  rct2: 0x006EC847
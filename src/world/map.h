@@ -265,6 +265,13 @@ typedef struct {
 	uint8 direction;
 } rct2_peep_spawn;
 
+typedef struct {
+	sint16 x, y;
+	uint8 base_height;
+	uint8 clearance_height;
+	uint8 quadrants;
+} rct_map_clearance;
+
 extern const rct_xy16 TileDirectionDelta[];
 
 extern rct_map_element *gMapElements;
@@ -282,6 +289,8 @@ extern bool LandRightsMode;
 extern bool gClearSmallScenery;
 extern bool gClearLargeScenery;
 extern bool gClearFootpath;
+// Space taken by the last small scenery that was checked or placed
+extern rct_map_clearance gSceneryPlaceClearance;
 
 void map_init(int size);
 void map_update_tile_pointers();
@@ -319,6 +328,7 @@ rct_map_element *map_element_insert(int x, int y, int z, int flags);
 
 typedef int (CLEAR_FUNC)(rct_map_element** map_element, int x, int y, uint8 flags, money32* price);
 int map_place_non_scenery_clear_func(rct_map_element** map_element, int x, int y, uint8 flags, money32* price);
+bool map_clearances_intersect(const rct_map_clearance *a, const rct_map_clearance *b);
 int map_can_construct_with_clear_at(int x, int y, int zLow, int zHigh, CLEAR_FUNC *clearFunc, uint8 bl, uint8 flags, money32 *price);
 int map_can_construct_at(int x, int y, int zLow, int zHigh, uint8 bl);
 void rotate_map_coordinates(sint16 *x, sint16 *y, int rotation);
@@ -391,6 +401,8 @@ void map_invalidate_tile_zoom1(int x, int y, int z0, int z1);
 void map_invalidate_tile_zoom0(int x, int y, int z0, int z1);
 void map_invalidate_tile_full(int x, int y);
 void map_invalidate_element(int x, int y, rct_map_element *mapElement);
+void map_invalidate_begin_deferred();
+void map_invalidate_end_deferred();
 
 int map_get_tile_side(int mapX, int mapY);
 int map_get_tile_quadrant(int mapX, int mapY);
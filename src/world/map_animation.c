@@ -23,6 +23,7 @@
 #include "../ride/ride_data.h"
 #include "../ride/track.h"
 #include "../interface/viewport.h"
+#include "footpath.h"
 #include "map_animation.h"
 #include "map.h"
 #include "scenery.h"
@@ -36,6 +37,368 @@ static const map_animation_invalidate_event_handler _animatedObjectEventHandlers
 
 rct_map_animation *gAnimatedObjects = (rct_map_animation*)0x013886A0;
 
+// The number of animations the saved game format has room for
+#define MAP_ANIMATION_LEGACY_MAX 2000
+
+// Animations are bucketed into square blocks of tiles for viewport culling
+#define MAP_ANIMATION_BLOCK_SHIFT 3
+#define MAP_ANIMATION_BLOCKS_PER_SIDE (256 >> MAP_ANIMATION_BLOCK_SHIFT)
+#define MAP_ANIMATION_BLOCK_COUNT (MAP_ANIMATION_BLOCKS_PER_SIDE * MAP_ANIMATION_BLOCKS_PER_SIDE)
+
+// Animations checked each tick so ones whose element has gone are removed whether or not they can be seen
+#define MAP_ANIMATION_SWEEP_COUNT 64
+
+/**
+ * All animations live in _animations, which can grow past the limit of the saved game format. The first
+ * MAP_ANIMATION_LEGACY_MAX of them are mirrored to gAnimatedObjects so saving needs no extra step. Loading a park
+ * replaces gAnimatedObjects directly and calls map_animation_mark_loaded, after which map_animation_sync_legacy
+ * rebuilds the registry from it, along with any animations that did not fit in the saved game.
+ *
+ * The list is part of the game state: it is saved and sent to joining clients, and some animations change the map.
+ * So only visits that every peer makes in the same order may remove animations, never ones decided by viewports.
+ * Once a park has more animations than fit in a saved game, the list order depends on each peer's history, so the
+ * animations that change the game state are run in map order rather than list order.
+ */
+static rct_map_animation *_animations;
+static int _animationCount;
+static int _animationCapacity;
+static bool _animationLegacyLoaded = true;
+
+// Copies of the animations which change the game state this tick, sorted before they are run
+static rct_map_animation *_gameStateAnimations;
+static int _gameStateAnimationCapacity;
+
+// Open addressed with linear probing, holds indices into _animations or -1
+static sint32 *_animationTable;
+static int _animationTableMask = -1;
+
+static uint16 _animationBlockCount[MAP_ANIMATION_BLOCK_COUNT];
+static uint8 _animationBlockMaxZ[MAP_ANIMATION_BLOCK_COUNT];
+static bool _animationBlockVisible[MAP_ANIMATION_BLOCK_COUNT];
+
+static uint64 map_animation_get_key(const rct_map_animation *obj)
+{
+	return obj->x | ((uint64)obj->y << 16) | ((uint64)obj->baseZ << 32) | ((uint64)obj->type << 40);
+}
+
+static int map_animation_get_slot(uint64 key)
+{
+	return (int)((key * 0x9E3779B97F4A7C15ULL) >> 32) & _animationTableMask;
+}
+
+static int map_animation_get_block(const rct_map_animation *obj)
+{
+	int blockX = (obj->x >> 5) >> MAP_ANIMATION_BLOCK_SHIFT;
+	int blockY = (obj->y >> 5) >> MAP_ANIMATION_BLOCK_SHIFT;
+	return (blockY & (MAP_ANIMATION_BLOCKS_PER_SIDE - 1)) * MAP_ANIMATION_BLOCKS_PER_SIDE + (blockX & (MAP_ANIMATION_BLOCKS_PER_SIDE - 1));
+}
+
+static int map_animation_find(const rct_map_animation *obj)
+{
+	if (_animationTable == NULL)
+		return -1;
+
+	uint64 key = map_animation_get_key(obj);
+	int slot = map_animation_get_slot(key);
+	while (_animationTable[slot] != -1) {
+		if (map_animation_get_key(&_animations[_animationTable[slot]]) == key)
+			return slot;
+		slot = (slot + 1) & _animationTableMask;
+	}
+	return -1;
+}
+
+static void map_animation_table_insert(int index)
+{
+	int slot = map_animation_get_slot(map_animation_get_key(&_animations[index]));
+	while (_animationTable[slot] != -1)
+		slot = (slot + 1) & _animationTableMask;
+	_animationTable[slot] = index;
+}
+
+/**
+ * Empties a slot, moving later entries of the same probe run back so no lookup stops early at the hole.
+ */
+static void map_animation_table_remove(int slot)
+{
+	int hole = slot;
+	int next = (slot + 1) & _animationTableMask;
+	while (_animationTable[next] != -1) {
+		int home = map_animation_get_slot(map_animation_get_key(&_animations[_animationTable[next]]));
+		// Move the entry into the hole unless its home slot lies cyclically in (hole, next]
+		if (((next - home) & _animationTableMask) >= ((next - hole) & _animationTableMask)) {
+			_animationTable[hole] = _animationTable[next];
+			hole = next;
+		}
+		next = (next + 1) & _animationTableMask;
+	}
+	_animationTable[hole] = -1;
+}
+
+static void map_animation_table_rebuild(int size)
+{
+	free(_animationTable);
+	_animationTable = malloc(size * sizeof(sint32));
+	_animationTableMask = size - 1;
+	memset(_animationTable, 0xFF, size * sizeof(sint32));
+	for (int i = 0; i < _animationCount; i++)
+		map_animation_table_insert(i);
+}
+
+static void map_animation_write_legacy(int index)
+{
+	if (index < MAP_ANIMATION_LEGACY_MAX)
+		gAnimatedObjects[index] = _animations[index];
+	RCT2_GLOBAL(0x0138B580, uint16) = min(_animationCount, MAP_ANIMATION_LEGACY_MAX);
+}
+
+static void map_animation_add(const rct_map_animation *obj)
+{
+	if (_animationCount == _animationCapacity) {
+		_animationCapacity = max(_animationCapacity * 2, 256);
+		_animations = realloc(_animations, _animationCapacity * sizeof(rct_map_animation));
+	}
+	// Keep the table at most half full
+	if (_animationTable == NULL || (_animationCount + 1) * 2 > _animationTableMask + 1)
+		map_animation_table_rebuild(max((_animationTableMask + 1) * 2, 512));
+
+	int index = _animationCount++;
+	_animations[index] = *obj;
+	map_animation_table_insert(index);
+
+	int block = map_animation_get_block(obj);
+	_animationBlockCount[block]++;
+	_animationBlockMaxZ[block] = max(_animationBlockMaxZ[block], obj->baseZ);
+
+	map_animation_write_legacy(index);
+	if (_animationCount == MAP_ANIMATION_LEGACY_MAX + 1)
+		log_warning("More than %d animations, the rest will be recreated from the map when loaded", MAP_ANIMATION_LEGACY_MAX);
+}
+
+/**
+ * Adds an animation unless it already exists.
+ */
+static void map_animation_insert(int type, int x, int y, int z)
+{
+	rct_map_animation aobj;
+	aobj.type = type;
+	aobj.x = x;
+	aobj.y = y;
+	aobj.baseZ = z;
+
+	if (map_animation_find(&aobj) == -1)
+		map_animation_add(&aobj);
+}
+
+/**
+ * Removes the animation at the given index by moving the last animation into its place.
+ */
+static void map_animation_remove(int index)
+{
+	_animationBlockCount[map_animation_get_block(&_animations[index])]--;
+	map_animation_table_remove(map_animation_find(&_animations[index]));
+
+	int last = --_animationCount;
+	if (index != last) {
+		int slot = map_animation_find(&_animations[last]);
+		_animations[index] = _animations[last];
+		_animationTable[slot] = index;
+	}
+	map_animation_write_legacy(index);
+}
+
+/**
+ * Creates the animations an element needs. Doors and on-ride photos only have one while they are moving, which their
+ * element records.
+ */
+static void map_animation_auto_create_at_element(int x, int y, rct_map_element *mapElement)
+{
+	rct_scenery_entry *sceneryEntry;
+	int z = mapElement->base_height;
+
+	switch (map_element_get_type(mapElement)) {
+	case MAP_ELEMENT_TYPE_PATH:
+		if (footpath_element_is_queue(mapElement) && (mapElement->properties.path.type & PATH_FLAG_QUEUE_BANNER))
+			map_animation_insert(MAP_ANIMATION_TYPE_QUEUE_BANNER, x, y, z);
+		break;
+	case MAP_ELEMENT_TYPE_TRACK:
+		switch (mapElement->properties.track.type) {
+		case TRACK_ELEM_WATERFALL:
+			map_animation_insert(MAP_ANIMATION_TYPE_TRACK_WATERFALL, x, y, z);
+			break;
+		case TRACK_ELEM_RAPIDS:
+			map_animation_insert(MAP_ANIMATION_TYPE_TRACK_RAPIDS, x, y, z);
+			break;
+		case TRACK_ELEM_WHIRLPOOL:
+			map_animation_insert(MAP_ANIMATION_TYPE_TRACK_WHIRLPOOL, x, y, z);
+			break;
+		case TRACK_ELEM_SPINNING_TUNNEL:
+			map_animation_insert(MAP_ANIMATION_TYPE_TRACK_SPINNINGTUNNEL, x, y, z);
+			break;
+		case TRACK_ELEM_ON_RIDE_PHOTO:
+			if (mapElement->properties.track.sequence & 0xF0)
+				map_animation_insert(MAP_ANIMATION_TYPE_TRACK_ONRIDEPHOTO, x, y, z);
+			break;
+		}
+		break;
+	case MAP_ELEMENT_TYPE_SCENERY:
+		sceneryEntry = g_smallSceneryEntries[mapElement->properties.scenery.type];
+		if (sceneryEntry->small_scenery.flags & SMALL_SCENERY_FLAG_ANIMATED)
+			map_animation_insert(MAP_ANIMATION_TYPE_SMALL_SCENERY, x, y, z);
+		break;
+	case MAP_ELEMENT_TYPE_ENTRANCE:
+		switch (mapElement->properties.entrance.type) {
+		case ENTRANCE_TYPE_RIDE_ENTRANCE:
+			map_animation_insert(MAP_ANIMATION_TYPE_RIDE_ENTRANCE, x, y, z);
+			break;
+		case ENTRANCE_TYPE_PARK_ENTRANCE:
+			if (!(mapElement->properties.entrance.index & 0x0F))
+				map_animation_insert(MAP_ANIMATION_TYPE_PARK_ENTRANCE, x, y, z);
+			break;
+		}
+		break;
+	case MAP_ELEMENT_TYPE_FENCE:
+		sceneryEntry = g_wallSceneryEntries[mapElement->properties.scenery.type];
+		if ((sceneryEntry->wall.flags & (1 << 4)) && (mapElement->properties.fence.item[2] & 0x78))
+			map_animation_insert(MAP_ANIMATION_TYPE_WALL_UNKNOWN, x, y, z);
+		if ((sceneryEntry->wall.flags2 & (1 << 4)) || sceneryEntry->wall.var_0D != 255)
+			map_animation_insert(MAP_ANIMATION_TYPE_WALL, x, y, z);
+		break;
+	case MAP_ELEMENT_TYPE_SCENERY_MULTIPLE:
+		sceneryEntry = g_largeSceneryEntries[mapElement->properties.scenery.type & 0x3FF];
+		if (sceneryEntry->large_scenery.flags & (1 << 3))
+			map_animation_insert(MAP_ANIMATION_TYPE_LARGE_SCENERY, x, y, z);
+		break;
+	case MAP_ELEMENT_TYPE_BANNER:
+		map_animation_insert(MAP_ANIMATION_TYPE_BANNER, x, y, z);
+		break;
+	}
+}
+
+/**
+ * Creates the animations for every animated element on the map. The scan order is fixed so every peer that loads the
+ * same park ends up with the same list.
+ */
+static void map_animation_auto_create()
+{
+	map_element_iterator it;
+
+	map_element_iterator_begin(&it);
+	do {
+		map_animation_auto_create_at_element(it.x * 32, it.y * 32, it.element);
+	} while (map_element_iterator_next(&it));
+}
+
+/**
+ * Rebuilds the registry from gAnimatedObjects the next time it is used.
+ */
+void map_animation_mark_loaded()
+{
+	_animationLegacyLoaded = true;
+}
+
+/**
+ * Rebuilds the registry if a park has been loaded or the map reset since it was last used. A full table means
+ * animations may have been left out of the save, so those are recreated from the map.
+ */
+static void map_animation_sync_legacy()
+{
+	if (!_animationLegacyLoaded)
+		return;
+	_animationLegacyLoaded = false;
+
+	int legacyCount = RCT2_GLOBAL(0x0138B580, uint16);
+	_animationCount = 0;
+	memset(_animationBlockCount, 0, sizeof(_animationBlockCount));
+	memset(_animationBlockMaxZ, 0, sizeof(_animationBlockMaxZ));
+	if (_animationTable != NULL)
+		memset(_animationTable, 0xFF, (_animationTableMask + 1) * sizeof(sint32));
+
+	// Copy the loaded animations out first as adding them writes back to gAnimatedObjects
+	legacyCount = min(legacyCount, MAP_ANIMATION_LEGACY_MAX);
+	rct_map_animation *loaded = malloc(max(legacyCount, 1) * sizeof(rct_map_animation));
+	memcpy(loaded, gAnimatedObjects, legacyCount * sizeof(rct_map_animation));
+	for (int i = 0; i < legacyCount; i++) {
+		if (map_animation_find(&loaded[i]) == -1)
+			map_animation_add(&loaded[i]);
+	}
+	RCT2_GLOBAL(0x0138B580, uint16) = min(_animationCount, MAP_ANIMATION_LEGACY_MAX);
+	free(loaded);
+
+	if (legacyCount == MAP_ANIMATION_LEGACY_MAX)
+		map_animation_auto_create();
+}
+
+/**
+ * Marks the tile blocks which could appear in a viewport zoomed in enough for the animations to be invalidated.
+ */
+static void map_animation_update_visible_blocks()
+{
+	rct_viewport *viewports[MAX_VIEWPORT_COUNT];
+	int numViewports = 0;
+	int rotation = get_current_rotation();
+
+	for (int i = 0; i < MAX_VIEWPORT_COUNT; i++) {
+		rct_viewport *viewport = &g_viewport_list[i];
+		if (viewport->width != 0 && viewport->zoom <= 1)
+			viewports[numViewports++] = viewport;
+	}
+
+	for (int block = 0; block < MAP_ANIMATION_BLOCK_COUNT; block++) {
+		_animationBlockVisible[block] = false;
+		if (numViewports == 0 || _animationBlockCount[block] == 0)
+			continue;
+
+		// Screen bounds of the block from the ground to above its highest animation
+		int blockSize = 32 << MAP_ANIMATION_BLOCK_SHIFT;
+		int left = INT32_MAX, top = INT32_MAX, right = INT32_MIN, bottom = INT32_MIN;
+		for (int corner = 0; corner < 4; corner++) {
+			rct_xyz16 position;
+			position.x = ((block % MAP_ANIMATION_BLOCKS_PER_SIDE) + (corner & 1)) * blockSize;
+			position.y = ((block / MAP_ANIMATION_BLOCKS_PER_SIDE) + (corner >> 1)) * blockSize;
+			position.z = 0;
+			rct_xy16 screen = coordinate_3d_to_2d(&position, rotation);
+			left = min(left, screen.x);
+			right = max(right, screen.x);
+			top = min(top, screen.y);
+			bottom = max(bottom, screen.y);
+		}
+		left -= 32;
+		right += 32;
+		top -= _animationBlockMaxZ[block] * 8 + 96;
+		bottom += 32;
+
+		for (int i = 0; i < numViewports; i++) {
+			rct_viewport *viewport = viewports[i];
+			if (right > viewport->view_x && left < viewport->view_x + viewport->view_width &&
+				bottom > viewport->view_y && top < viewport->view_y + viewport->view_height
+			) {
+				_animationBlockVisible[block] = true;
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * Whether the animation's handler changes the game state rather than only invalidating the screen, in which case it
+ * has to run whether or not it can be seen.
+ */
+static bool map_animation_affects_game_state(const rct_map_animation *obj)
+{
+	switch (obj->type) {
+	case MAP_ANIMATION_TYPE_TRACK_ONRIDEPHOTO:
+	case MAP_ANIMATION_TYPE_REMOVE:
+	case MAP_ANIMATION_TYPE_WALL_UNKNOWN:
+		return true;
+	case MAP_ANIMATION_TYPE_SMALL_SCENERY:
+		// Clocks make peeps check the time
+		return !(RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32) & 0x3FF);
+	default:
+		return false;
+	}
+}
+
 /**
  *
  *  rct2: 0x0068AF67
@@ -47,53 +410,89 @@ rct_map_animation *gAnimatedObjects = (rct_map_animation*)0x013886A0;
  */
 void map_animation_create(int type, int x, int y, int z)
 {
-	rct_map_animation *aobj = &gAnimatedObjects[0];
-	int numAnimatedObjects = RCT2_GLOBAL(0x0138B580, uint16);
-	if (numAnimatedObjects >= 2000) {
-		log_error("Exceeded the maximum number of animations");
-		return;
-	}
-	for (int i = 0; i < numAnimatedObjects; i++, aobj++) {
-		if (aobj->x != x)
-			continue;
-		if (aobj->y != y)
-			continue;
-		if (aobj->baseZ != z)
-			continue;
-		if (aobj->type != type)
-			continue;
-		// Animation already exists
-		return;
+	map_animation_sync_legacy();
+	map_animation_insert(type, x, y, z);
+}
+
+static int map_animation_compare_position(const void *a, const void *b)
+{
+	const rct_map_animation *objA = (const rct_map_animation*)a;
+	const rct_map_animation *objB = (const rct_map_animation*)b;
+	if (objA->y != objB->y)
+		return objA->y < objB->y ? -1 : 1;
+	if (objA->x != objB->x)
+		return objA->x < objB->x ? -1 : 1;
+	if (objA->baseZ != objB->baseZ)
+		return objA->baseZ < objB->baseZ ? -1 : 1;
+	return (int)objA->type - (int)objB->type;
+}
+
+static void map_animation_defer_game_state(const rct_map_animation *obj, int index)
+{
+	if (index == _gameStateAnimationCapacity) {
+		_gameStateAnimationCapacity = max(_gameStateAnimationCapacity * 2, 64);
+		_gameStateAnimations = realloc(_gameStateAnimations, _gameStateAnimationCapacity * sizeof(rct_map_animation));
 	}
+	_gameStateAnimations[index] = *obj;
+}
 
-	// Create new animation
-	RCT2_GLOBAL(0x0138B580, uint16)++;
-	aobj->type = type;
-	aobj->x = x;
-	aobj->y = y;
-	aobj->baseZ = z;
+/**
+ * Runs the deferred animations which change the game state in map order, which is the same on every peer whatever
+ * order their lists are in. Clocks for example make the first walking peep on their tile check the time, so the one
+ * that runs first decides which peep that is.
+ */
+static void map_animation_run_game_state(int count)
+{
+	qsort(_gameStateAnimations, count, sizeof(rct_map_animation), map_animation_compare_position);
+	for (int i = 0; i < count; i++) {
+		if (map_animation_invalidate(&_gameStateAnimations[i])) {
+			int slot = map_animation_find(&_gameStateAnimations[i]);
+			if (slot != -1)
+				map_animation_remove(_animationTable[slot]);
+		}
+	}
 }
 
 /**
- *
+ * Invalidates the animations which can be seen, and runs those which change the game state. Animations whose map
+ * element has gone are removed by the game state runs and by a sweep through the list a few at a time, which depend
+ * only on the list and the tick so every peer removes the same ones.
  *  rct2: 0x0068AFAD
  */
 void map_animation_invalidate_all()
 {
-	rct_map_animation *aobj = &gAnimatedObjects[0];
-	int numAnimatedObjects = RCT2_GLOBAL(0x0138B580, uint16);
-	while (numAnimatedObjects > 0) {
-		if (map_animation_invalidate(aobj)) {
-			// Remove animated object
-			RCT2_GLOBAL(0x0138B580, uint16)--;
-			numAnimatedObjects--;
-			if (numAnimatedObjects > 0)
-				memmove(aobj, aobj + 1, numAnimatedObjects * sizeof(rct_map_animation));
+	map_animation_sync_legacy();
+	map_animation_update_visible_blocks();
+
+	int sweepStart = 0;
+	if (_animationCount != 0)
+		sweepStart = (int)(((uint64)RCT2_GLOBAL(RCT2_ADDRESS_CURRENT_TICKS, uint32) * MAP_ANIMATION_SWEEP_COUNT) % _animationCount);
+	int sweepEnd = sweepStart + MAP_ANIMATION_SWEEP_COUNT;
+
+	int numGameStateAnimations = 0;
+	int i = 0;
+	while (i < _animationCount) {
+		rct_map_animation *aobj = &_animations[i];
+		if (map_animation_affects_game_state(aobj)) {
+			map_animation_defer_game_state(aobj, numGameStateAnimations++);
+			i++;
+			continue;
+		}
+
+		bool inSweep = i >= sweepStart && i < sweepEnd;
+		if (!inSweep && !_animationBlockVisible[map_animation_get_block(aobj)]) {
+			i++;
+			continue;
+		}
+
+		if (map_animation_invalidate(aobj) && inSweep) {
+			// The last animation is moved here, so visit this index again
+			map_animation_remove(i);
 		} else {
-			numAnimatedObjects--;
-			aobj++;
+			i++;
 		}
 	}
+	map_animation_run_game_state(numGameStateAnimations);
 }
 
 /**
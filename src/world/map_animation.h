@@ -55,6 +55,7 @@ enum {
 extern rct_map_animation *gAnimatedObjects;
 
 void map_animation_create(int type, int x, int y, int z);
+void map_animation_mark_loaded();
 void map_animation_invalidate_all();
 
 #endif
@@ -19,6 +19,11 @@
  *****************************************************************************/
 
 #include <time.h>
+#include <SDL.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define MAPGEN_SSE2
+#endif
 #include "../addresses.h"
 #include "../object.h"
 #include "../util/util.h"
@@ -80,7 +85,7 @@ static void mapgen_set_water_level(int height);
 static void mapgen_blobs(int count, int lowSize, int highSize, int lowHeight, int highHeight);
 static void mapgen_blob(int cx, int cy, int size, int height);
 static void mapgen_smooth_height(int iterations);
-static void mapgen_set_height();
+static void mapgen_set_height(int floorTexture, int wallTexture);
 
 static void mapgen_simplex();
 
@@ -154,17 +159,8 @@ void mapgen_generate(mapgen_settings *settings)
 
 	map_clear_all_elements();
 
-	// Initialise the base map
+	// Initialise the base map, the surface of each tile is set from the height map in one pass further on
 	map_init(mapSize);
-	for (y = 1; y < mapSize - 1; y++) {
-		for (x = 1; x < mapSize - 1; x++) {
-			mapElement = map_get_surface_element_at(x, y);
-			map_element_set_terrain(mapElement, floorTexture);
-			map_element_set_terrain_edge(mapElement, wallTexture);
-			mapElement->base_height = settings->height;
-			mapElement->clearance_height = settings->height;
-		}
-	}
 
 	// Create the temporary height map and initialise
 	_heightSize = mapSize * 2;
@@ -189,7 +185,7 @@ void mapgen_generate(mapgen_settings *settings)
 	}
 
 	// Set the game map to the height map
-	mapgen_set_height();
+	mapgen_set_height(floorTexture, wallTexture);
 	free(_height);
 
 	// Set the tile slopes so that there are no cliffs
@@ -576,36 +572,122 @@ static void mapgen_blob(int cx, int cy, int size, int height)
 	mapgen_blob_fill(height);
 }
 
+typedef struct {
+	int start_y;
+	int end_y;
+	void *data;
+} mapgen_band;
+
+typedef void (*mapgen_band_func)(mapgen_band *band);
+
+typedef struct {
+	mapgen_band band;
+	mapgen_band_func func;
+} mapgen_band_thread_args;
+
+#define MAPGEN_MAX_BANDS 16
+
+// Bands smaller than this are not worth the cost of starting a thread
+#define MAPGEN_MIN_BAND_ROWS 32
+
+static int mapgen_band_thread(void *ptr)
+{
+	mapgen_band_thread_args *args = (mapgen_band_thread_args*)ptr;
+	args->func(&args->band);
+	return 0;
+}
+
+/**
+ * Calls func for bands of rows covering [startY, endY) of the height map, running the bands on separate threads.
+ * Each band must only write to its own rows.
+ */
+static void mapgen_run_bands(int startY, int endY, mapgen_band_func func, void *data)
+{
+	mapgen_band_thread_args args[MAPGEN_MAX_BANDS];
+	SDL_Thread *threads[MAPGEN_MAX_BANDS];
+	int i, numBands, rows;
+
+	rows = endY - startY;
+	numBands = min(SDL_GetCPUCount(), MAPGEN_MAX_BANDS);
+	numBands = min(numBands, rows / MAPGEN_MIN_BAND_ROWS);
+	numBands = max(numBands, 1);
+
+	for (i = 0; i < numBands; i++) {
+		args[i].band.start_y = startY + (rows * i) / numBands;
+		args[i].band.end_y = startY + (rows * (i + 1)) / numBands;
+		args[i].band.data = data;
+		args[i].func = func;
+	}
+
+	// The first band is run on this thread
+	for (i = 1; i < numBands; i++) {
+		threads[i] = SDL_CreateThread(mapgen_band_thread, "mapgen", &args[i]);
+		if (threads[i] == NULL) {
+			log_warning("Unable to create mapgen thread, running band on main thread.");
+			func(&args[i].band);
+		}
+	}
+	func(&args[0].band);
+	for (i = 1; i < numBands; i++) {
+		if (threads[i] != NULL)
+			SDL_WaitThread(threads[i], NULL);
+	}
+}
+
+typedef struct {
+	const uint8 *src;
+	uint8 *dst;
+} mapgen_smooth_args;
+
+static void mapgen_smooth_band(mapgen_band *band)
+{
+	mapgen_smooth_args *args = (mapgen_smooth_args*)band->data;
+	int x, y, avg;
+
+	for (y = band->start_y; y < band->end_y; y++) {
+		const uint8 *above = args->src + (y - 1) * _heightSize;
+		const uint8 *row = args->src + y * _heightSize;
+		const uint8 *below = args->src + (y + 1) * _heightSize;
+		uint8 *dst = args->dst + y * _heightSize;
+		for (x = 1; x < _heightSize - 1; x++) {
+			avg =
+				above[x - 1] + above[x] + above[x + 1] +
+				row[x - 1] + row[x] + row[x + 1] +
+				below[x - 1] + below[x] + below[x + 1];
+			dst[x] = avg / 9;
+		}
+	}
+}
+
 /**
  * Smooths the height map.
  */
 static void mapgen_smooth_height(int iterations)
 {
-	int i, x, y, xx, yy, avg;
+	int i;
 	int arraySize = _heightSize * _heightSize * sizeof(uint8);
 	uint8 *copyHeight = malloc(arraySize);
+	mapgen_smooth_args args;
 
+	// The edges are never written so once copied both buffers keep the same edges, the buffers can then be swapped
+	// between iterations rather than copied
+	memcpy(copyHeight, _height, arraySize);
 	for (i = 0; i < iterations; i++) {
-		memcpy(copyHeight, _height, arraySize);
-		for (y = 1; y < _heightSize - 1; y++) {
-			for (x = 1; x < _heightSize - 1; x++) {
-				avg = 0;
-				for (yy = -1; yy <= 1; yy++)
-					for (xx = -1; xx <= 1; xx++)
-						avg += copyHeight[(y + yy) * _heightSize + (x + xx)];
-				avg /= 9;
-				set_height(x, y, avg);
-			}
-		}
+		args.src = _height;
+		args.dst = copyHeight;
+		mapgen_run_bands(1, _heightSize - 1, mapgen_smooth_band, &args);
+
+		copyHeight = _height;
+		_height = args.dst;
 	}
 
 	free(copyHeight);
 }
 
 /**
- * Sets the height of the actual game map tiles to the height map.
+ * Sets the surface of the actual game map tiles from the height map.
  */
-static void mapgen_set_height()
+static void mapgen_set_height(int floorTexture, int wallTexture)
 {
 	int x, y, heightX, heightY, mapSize;
 	rct_map_element *mapElement;
@@ -624,6 +706,8 @@ static void mapgen_set_height()
 			uint8 baseHeight = (q00 + q01 + q10 + q11) / 4;
 
 			mapElement = map_get_surface_element_at(x, y);
+			map_element_set_terrain(mapElement, floorTexture);
+			map_element_set_terrain_edge(mapElement, wallTexture);
 			mapElement->base_height = max(2, baseHeight * 2);
 			mapElement->clearance_height = mapElement->base_height;
 
@@ -660,23 +744,11 @@ static void noise_rand()
 		perm[i] = util_rand() & 0xFF;
 }
 
-static float fractal_noise(int x, int y, float frequency, int octaves, float lacunarity, float persistence)
-{
-	float total = 0.0f;
-	float amplitude = persistence;
-	for (int i = 0; i < octaves; i++) {
-		total += generate(x * frequency, y * frequency) * amplitude;
-		frequency *= lacunarity;
-		amplitude *= persistence;
-	}
-	return total;
-}
+static const float F2 = 0.366025403f; // F2 = 0.5*(sqrt(3.0)-1.0)
+static const float G2 = 0.211324865f; // G2 = (3.0-Math.sqrt(3.0))/6.0
 
 static float generate(float x, float y)
 {
-	const float F2 = 0.366025403f; // F2 = 0.5*(sqrt(3.0)-1.0)
-	const float G2 = 0.211324865f; // G2 = (3.0-Math.sqrt(3.0))/6.0
-
 	float n0, n1, n2; // Noise contributions from the three corners
 
 	// Skew the input space to determine which simplex cell we're in
@@ -708,8 +780,8 @@ static float generate(float x, float y)
 	float y2 = y0 - 1.0f + 2.0f * G2;
 
 	// Wrap the integer indices at 256, to avoid indexing perm[] out of bounds
-	int ii = i % 256;
-	int jj = j % 256;
+	int ii = i & 0xFF;
+	int jj = j & 0xFF;
 
 	// Calculate the contribution from the three corners
 	float t0 = 0.5f - x0 * x0 - y0 * y0;
@@ -751,25 +823,164 @@ static float grad(int hash, float x, float y)
 	return ((h & 1) != 0 ? -u : u) + ((h & 2) != 0 ? -2.0f * v : 2.0f * v);
 }
 
-static void mapgen_simplex(mapgen_settings *settings)
+#ifdef MAPGEN_SSE2
+
+/**
+ * The contribution of one simplex corner for four samples, matching the corresponding part of generate.
+ */
+static __m128 generate4_corner(__m128 x, __m128 y, __m128i hash)
 {
-	int x, y;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+
+	// grad: select u and v by bit 2 of the hash and negate them by bits 0 and 1
+	__m128i h = _mm_and_si128(hash, _mm_set1_epi32(7));
+	__m128 swap = _mm_castsi128_ps(_mm_cmpgt_epi32(h, _mm_set1_epi32(3)));
+	__m128 u = _mm_or_ps(_mm_and_ps(swap, y), _mm_andnot_ps(swap, x));
+	__m128 v = _mm_or_ps(_mm_and_ps(swap, x), _mm_andnot_ps(swap, y));
+	__m128 negateU = _mm_castsi128_ps(_mm_slli_epi32(h, 31));
+	__m128 negateV = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(h, 1), 31));
+	u = _mm_xor_ps(u, _mm_and_ps(negateU, signBit));
+	v = _mm_xor_ps(_mm_mul_ps(two, v), _mm_and_ps(negateV, signBit));
+	__m128 gradient = _mm_add_ps(u, v);
+
+	__m128 t = _mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x, x)), _mm_mul_ps(y, y));
+	__m128 outside = _mm_cmplt_ps(t, zero);
+	t = _mm_mul_ps(t, t);
+	__m128 n = _mm_mul_ps(_mm_mul_ps(t, t), gradient);
+	return _mm_andnot_ps(outside, n);
+}
+
+/**
+ * Evaluates generate for four samples at once. The arithmetic is done in the same order as generate so the results
+ * are identical, only the permutation table lookups are done per sample.
+ */
+static __m128 generate4(__m128 x, __m128 y)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 g2 = _mm_set1_ps(G2);
+	const __m128 g2Twice = _mm_set1_ps(2.0f * G2);
+
+	__m128 s = _mm_mul_ps(_mm_add_ps(x, y), _mm_set1_ps(F2));
+	__m128 xs = _mm_add_ps(x, s);
+	__m128 ys = _mm_add_ps(y, s);
+
+	// fast_floor, the comparison mask is -1 where a sample is not positive
+	__m128i i = _mm_add_epi32(_mm_cvttps_epi32(xs), _mm_castps_si128(_mm_cmple_ps(xs, zero)));
+	__m128i j = _mm_add_epi32(_mm_cvttps_epi32(ys), _mm_castps_si128(_mm_cmple_ps(ys, zero)));
+
+	__m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(i, j)), g2);
+	__m128 x0 = _mm_sub_ps(x, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+	__m128 y0 = _mm_sub_ps(y, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+
+	__m128 lower = _mm_cmpgt_ps(x0, y0);
+	__m128 i1 = _mm_and_ps(lower, one);
+	__m128 j1 = _mm_andnot_ps(lower, one);
+
+	__m128 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), g2);
+	__m128 y1 = _mm_add_ps(_mm_sub_ps(y0, j1), g2);
+	__m128 x2 = _mm_add_ps(_mm_sub_ps(x0, one), g2Twice);
+	__m128 y2 = _mm_add_ps(_mm_sub_ps(y0, one), g2Twice);
+
+	sint32 iiLanes[4], jjLanes[4], i1Lanes[4];
+	sint32 hash0[4], hash1[4], hash2[4];
+	_mm_storeu_si128((__m128i*)iiLanes, _mm_and_si128(i, _mm_set1_epi32(0xFF)));
+	_mm_storeu_si128((__m128i*)jjLanes, _mm_and_si128(j, _mm_set1_epi32(0xFF)));
+	_mm_storeu_si128((__m128i*)i1Lanes, _mm_castps_si128(lower));
+	for (int lane = 0; lane < 4; lane++) {
+		int ii = iiLanes[lane];
+		int jj = jjLanes[lane];
+		int laneI1 = i1Lanes[lane] & 1;
+		hash0[lane] = perm[ii + perm[jj]];
+		hash1[lane] = perm[ii + laneI1 + perm[jj + 1 - laneI1]];
+		hash2[lane] = perm[ii + 1 + perm[jj + 1]];
+	}
 
-	float freq = settings->simplex_base_freq * (1.0f / _heightSize);
-	int octaves = settings->simplex_octaves;
+	__m128 n0 = generate4_corner(x0, y0, _mm_loadu_si128((__m128i*)hash0));
+	__m128 n1 = generate4_corner(x1, y1, _mm_loadu_si128((__m128i*)hash1));
+	__m128 n2 = generate4_corner(x2, y2, _mm_loadu_si128((__m128i*)hash2));
+	return _mm_mul_ps(_mm_set1_ps(40.0f), _mm_add_ps(_mm_add_ps(n0, n1), n2));
+}
 
-	int low = settings->simplex_low;
-	int high = settings->simplex_high;
+#endif
 
-	noise_rand();
-	for (y = 0; y < _heightSize; y++) {
-		for (x = 0; x < _heightSize; x++) {
-			float noiseValue = clamp(-1.0f, fractal_noise(x, y, freq, octaves, 2.0f, 0.65f), 1.0f);
-			float normalisedNoiseValue = (noiseValue + 1.0f) / 2.0f;
+typedef struct {
+	float frequency;
+	int octaves;
+	float lacunarity;
+	float persistence;
+	int low;
+	int high;
+} mapgen_noise_args;
+
+static uint8 noise_to_height(const mapgen_noise_args *args, float total)
+{
+	float noiseValue = clamp(-1.0f, total, 1.0f);
+	float normalisedNoiseValue = (noiseValue + 1.0f) / 2.0f;
+	return args->low + (int)(normalisedNoiseValue * args->high);
+}
+
+/**
+ * Fills rows of the height map with fractal noise, four samples at a time where SSE2 is available.
+ */
+static void mapgen_simplex_band(mapgen_band *band)
+{
+	const mapgen_noise_args *args = (const mapgen_noise_args*)band->data;
+	int x, y, i;
+
+	for (y = band->start_y; y < band->end_y; y++) {
+		uint8 *row = _height + y * _heightSize;
+		x = 0;
+#ifdef MAPGEN_SSE2
+		for (; x + 4 <= _heightSize; x += 4) {
+			__m128 sampleX = _mm_set_ps((float)(x + 3), (float)(x + 2), (float)(x + 1), (float)x);
+			__m128 sampleY = _mm_set1_ps((float)y);
+			__m128 total = _mm_setzero_ps();
+			float frequency = args->frequency;
+			float amplitude = args->persistence;
+			for (i = 0; i < args->octaves; i++) {
+				__m128 vFrequency = _mm_set1_ps(frequency);
+				__m128 noise = generate4(_mm_mul_ps(sampleX, vFrequency), _mm_mul_ps(sampleY, vFrequency));
+				total = _mm_add_ps(total, _mm_mul_ps(noise, _mm_set1_ps(amplitude)));
+				frequency *= args->lacunarity;
+				amplitude *= args->persistence;
+			}
 
-			set_height(x, y, low + (int)(normalisedNoiseValue * high));
+			float totals[4];
+			_mm_storeu_ps(totals, total);
+			for (i = 0; i < 4; i++)
+				row[x + i] = noise_to_height(args, totals[i]);
+		}
+#endif
+		for (; x < _heightSize; x++) {
+			float total = 0.0f;
+			float frequency = args->frequency;
+			float amplitude = args->persistence;
+			for (i = 0; i < args->octaves; i++) {
+				total += generate(x * frequency, y * frequency) * amplitude;
+				frequency *= args->lacunarity;
+				amplitude *= args->persistence;
+			}
+			row[x] = noise_to_height(args, total);
 		}
 	}
 }
 
+static void mapgen_simplex(mapgen_settings *settings)
+{
+	mapgen_noise_args args;
+	args.frequency = settings->simplex_base_freq * (1.0f / _heightSize);
+	args.octaves = settings->simplex_octaves;
+	args.lacunarity = 2.0f;
+	args.persistence = 0.65f;
+	args.low = settings->simplex_low;
+	args.high = settings->simplex_high;
+
+	noise_rand();
+	mapgen_run_bands(0, _heightSize, mapgen_simplex_band, &args);
+}
+
 #pragma endregion
@@ -44,7 +44,8 @@ enum {
 	PARK_FLAGS_LOCK_REAL_NAMES_OPTION = (1 << 15),
 	PARK_FLAGS_NO_MONEY_SCENARIO = (1 << 17),  // equivalent to PARK_FLAGS_NO_MONEY, but used in scenario editor
 	PARK_FLAGS_18 = (1 << 18),
-	PARK_FLAGS_SIX_FLAGS_DEPRECATED = (1 << 19) // Not used anymore
+	PARK_FLAGS_SIX_FLAGS_DEPRECATED = (1 << 19), // Not used anymore
+	PARK_FLAGS_ENTITY_RANDOM_STREAMS = (1 << 20), // OpenRCT2 only, see scenario_rand_begin_stream
 };
 
 extern uint8 *gParkRatingHistory;
@@ -32,12 +32,56 @@ rct_sprite* g_sprite_list = RCT2_ADDRESS(RCT2_ADDRESS_SPRITE_LIST, rct_sprite);
 
 rct_sprite_entry* g_sprite_entries = RCT2_ADDRESS(RCT2_ADDRESS_SPRITE_ENTRIES, rct_sprite_entry);
 
+// The vehicles of each quadrant that is on the map, in the same order as in the quadrant lists at
+// 0x00F1EF60 so that searches over only vehicles find the same vehicle first
+static uint16 _vehicleQuadrants[0x10000];
+static uint16 _vehicleNextInQuadrant[MAX_SPRITES];
+
 uint16 sprite_get_first_in_quadrant(int x, int y)
 {
 	int offset = ((x & 0x1FE0) << 3) | (y >> 5);
 	return RCT2_ADDRESS(0x00F1EF60, uint16)[offset];
 }
 
+/**
+ * Gets the first vehicle in the quadrant list with the given index, skipping any other sprites.
+ */
+uint16 sprite_get_first_vehicle_in_quadrant(uint16 quadrantIndex)
+{
+	return _vehicleQuadrants[quadrantIndex];
+}
+
+uint16 sprite_get_next_vehicle_in_quadrant(uint16 spriteIndex)
+{
+	return _vehicleNextInQuadrant[spriteIndex];
+}
+
+static void vehicle_quadrant_add(rct_sprite *sprite, int quadrantIndex)
+{
+	uint16 spriteIndex = sprite->unknown.sprite_index;
+	if (quadrantIndex == 0x10000 || sprite->unknown.sprite_identifier != SPRITE_IDENTIFIER_VEHICLE)
+		return;
+
+	_vehicleNextInQuadrant[spriteIndex] = _vehicleQuadrants[quadrantIndex];
+	_vehicleQuadrants[quadrantIndex] = spriteIndex;
+}
+
+static void vehicle_quadrant_remove(rct_sprite *sprite, int quadrantIndex)
+{
+	uint16 spriteIndex = sprite->unknown.sprite_index;
+	if (quadrantIndex == 0x10000 || sprite->unknown.sprite_identifier != SPRITE_IDENTIFIER_VEHICLE)
+		return;
+
+	uint16 *vehicleIndex = &_vehicleQuadrants[quadrantIndex];
+	while (*vehicleIndex != SPRITE_INDEX_NULL) {
+		if (*vehicleIndex == spriteIndex) {
+			*vehicleIndex = _vehicleNextInQuadrant[spriteIndex];
+			return;
+		}
+		vehicleIndex = &_vehicleNextInQuadrant[*vehicleIndex];
+	}
+}
+
 static void invalidate_sprite_max_zoom(rct_sprite *sprite, int maxZoom)
 {
 	if (sprite->unknown.sprite_left == SPRITE_LOCATION_NULL) return;
@@ -132,6 +176,7 @@ void reset_sprite_list(){
  */
 void reset_0x69EBE4(){
 	memset((uint16*)0xF1EF60, -1, 0x10001*2);
+	memset(_vehicleQuadrants, -1, sizeof(_vehicleQuadrants));
 
 	rct_sprite* spr = g_sprite_list;
 	for (; spr < (rct_sprite*)RCT2_ADDRESS_SPRITES_NEXT_INDEX; spr++){
@@ -150,6 +195,7 @@ void reset_0x69EBE4(){
 			uint16 ax = RCT2_ADDRESS(0xF1EF60,uint16)[edi];
 			RCT2_ADDRESS(0xF1EF60,uint16)[edi] = spr->unknown.sprite_index;
 			spr->unknown.next_in_quadrant = ax;
+			vehicle_quadrant_add(spr, edi);
 		}
 	}
 }
@@ -454,6 +500,9 @@ void sprite_move(sint16 x, sint16 y, sint16 z, rct_sprite* sprite){
 		int temp_sprite_idx = RCT2_ADDRESS(0xF1EF60, uint16)[new_position];
 		RCT2_ADDRESS(0xF1EF60, uint16)[new_position] = sprite->unknown.sprite_index;
 		sprite->unknown.next_in_quadrant = temp_sprite_idx;
+
+		vehicle_quadrant_remove(sprite, current_position);
+		vehicle_quadrant_add(sprite, new_position);
 	}
 
 	if (x == SPRITE_LOCATION_NULL){
@@ -498,16 +547,17 @@ void sprite_move(sint16 x, sint16 y, sint16 z, rct_sprite* sprite){
  */
 void sprite_remove(rct_sprite *sprite)
 {
-	move_sprite_to_list(sprite, SPRITE_LINKEDLIST_OFFSET_NULL);
-	user_string_free(sprite->unknown.name_string_idx);
-	sprite->unknown.sprite_identifier = SPRITE_IDENTIFIER_NULL;
-
 	uint32 quadrantIndex = sprite->unknown.x;
 	if (sprite->unknown.x == SPRITE_LOCATION_NULL) {
 		quadrantIndex = 0x10000;
 	} else {
 		quadrantIndex = (floor2(sprite->unknown.x, 32) << 3) | (sprite->unknown.y >> 5);
 	}
+	vehicle_quadrant_remove(sprite, quadrantIndex);
+
+	move_sprite_to_list(sprite, SPRITE_LINKEDLIST_OFFSET_NULL);
+	user_string_free(sprite->unknown.name_string_idx);
+	sprite->unknown.sprite_identifier = SPRITE_IDENTIFIER_NULL;
 
 	uint16 *spriteIndex = &RCT2_ADDRESS(0x00F1EF60, uint16)[quadrantIndex];
 	rct_sprite *quadrantSprite;
@@ -391,6 +391,8 @@ void litter_remove_at(int x, int y, int z);
 void sprite_misc_3_create(int x, int y, int z);
 void sprite_misc_5_create(int x, int y, int z);
 uint16 sprite_get_first_in_quadrant(int x, int y);
+uint16 sprite_get_first_vehicle_in_quadrant(uint16 quadrantIndex);
+uint16 sprite_get_next_vehicle_in_quadrant(uint16 spriteIndex);
 
 ///////////////////////////////////////////////////////////////
 // Balloon